@@ -0,0 +1,90 @@
+#include "RcppEDMCommon.h"
+
+//-------------------------------------------------------------
+// 
+//-------------------------------------------------------------
+r::List Backtest_rcpp( std::string  pathIn,
+                       std::string  dataFile,
+                       r::DataFrame dataFrame,
+                       std::string  lib,
+                       int          E,
+                       int          Tp,
+                       int          knn,
+                       int          tau,
+                       double       theta,
+                       int          exclusionRadius,
+                       std::string  columns,
+                       std::string  target,
+                       std::string  method,
+                       int          step,
+                       int          window,
+                       bool         embedded,
+                       bool         verbose,
+                       bool         exactExp,
+                       bool         singlePrecision,
+                       std::string  metric,
+                       std::string  metricScales,
+                       unsigned     nThreads ) {
+
+    BacktestValues BV;
+
+    if ( dataFile.size() ) {
+        // dataFile specified, dispatch overloaded Backtest
+        BV = Backtest( pathIn,
+                       dataFile,
+                       lib,
+                       E,
+                       Tp,
+                       knn,
+                       tau,
+                       theta,
+                       exclusionRadius,
+                       columns,
+                       target,
+                       method,
+                       step,
+                       window,
+                       embedded,
+                       verbose,
+                       exactExp,
+                       singlePrecision,
+                       metric,
+                       metricScales,
+                       nThreads );
+    }
+    else if ( dataFrame.size() ) {
+        DataFrame< double > dataFrame_ = DFToDataFrame( dataFrame );
+
+        BV = Backtest( dataFrame_,
+                       lib,
+                       E,
+                       Tp,
+                       knn,
+                       tau,
+                       theta,
+                       exclusionRadius,
+                       columns,
+                       target,
+                       method,
+                       step,
+                       window,
+                       embedded,
+                       verbose,
+                       exactExp,
+                       singlePrecision,
+                       metric,
+                       metricScales,
+                       nThreads );
+    }
+    else {
+        Rcpp::warning( "Backtest_rcpp(): Invalid input.\n" );
+    }
+
+    r::List skill = r::List::create( r::Named( "MAE"  ) = BV.skill.MAE,
+                                     r::Named( "rho"  ) = BV.skill.rho,
+                                     r::Named( "RMSE" ) = BV.skill.RMSE );
+
+    return r::List::create( r::Named( "predictions" ) =
+                                DataFrameToDF( BV.predictions ),
+                            r::Named( "skill"       ) = skill );
+}
@@ -22,7 +22,10 @@ Rcpp::List CCM_rcpp( std::string  pathIn,
                      bool         replacement,
                      unsigned     seed,
                      bool         includeData,
-                     bool         verbose ) {
+                     bool         verbose,
+                     bool         singlePrecision,
+                     std::string  metric,
+                     std::string  metricScales ) {
     
     CCMValues ccmValues;
 
@@ -45,7 +48,10 @@ Rcpp::List CCM_rcpp( std::string  pathIn,
                          replacement,
                          seed,
                          includeData,
-                         verbose );
+                         verbose,
+                         singlePrecision,
+                         metric,
+                         metricScales );
     }
     else if ( dataFrame.size() ) {
         DataFrame< double > dataFrame_ = DFToDataFrame( dataFrame );
@@ -66,7 +72,10 @@ Rcpp::List CCM_rcpp( std::string  pathIn,
                          replacement,
                          seed,
                          includeData,
-                         verbose );
+                         verbose,
+                         singlePrecision,
+                         metric,
+                         metricScales );
     }
     else {
         Rcpp::warning( "CCM_rcpp(): No dataFile or dataFrame.\n" );
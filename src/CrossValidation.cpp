@@ -0,0 +1,89 @@
+#include "RcppEDMCommon.h"
+
+//-------------------------------------------------------------
+// 
+//-------------------------------------------------------------
+r::List CrossValidation_rcpp( std::string  pathIn,
+                              std::string  dataFile,
+                              r::DataFrame dataFrame,
+                              std::string  lib,
+                              int          E,
+                              int          Tp,
+                              int          knn,
+                              int          tau,
+                              int          exclusionRadius,
+                              std::string  columns,
+                              std::string  target,
+                              int          folds,
+                              int          foldBuffer,
+                              bool         embedded,
+                              bool         const_predict,
+                              bool         verbose,
+                              bool         exactExp,
+                              bool         singlePrecision,
+                              std::string  metric,
+                              std::string  metricScales,
+                              unsigned     nThreads ) {
+
+    CrossValidationValues CV;
+
+    if ( dataFile.size() ) {
+        // dataFile specified, dispatch overloaded CrossValidation
+        CV = CrossValidation( pathIn,
+                              dataFile,
+                              lib,
+                              E,
+                              Tp,
+                              knn,
+                              tau,
+                              exclusionRadius,
+                              columns,
+                              target,
+                              folds,
+                              foldBuffer,
+                              embedded,
+                              const_predict,
+                              verbose,
+                              exactExp,
+                              singlePrecision,
+                              metric,
+                              metricScales,
+                              nThreads );
+    }
+    else if ( dataFrame.size() ) {
+        DataFrame< double > dataFrame_ = DFToDataFrame( dataFrame );
+
+        CV = CrossValidation( dataFrame_,
+                              lib,
+                              E,
+                              Tp,
+                              knn,
+                              tau,
+                              exclusionRadius,
+                              columns,
+                              target,
+                              folds,
+                              foldBuffer,
+                              embedded,
+                              const_predict,
+                              verbose,
+                              exactExp,
+                              singlePrecision,
+                              metric,
+                              metricScales,
+                              nThreads );
+    }
+    else {
+        Rcpp::warning( "CrossValidation_rcpp(): Invalid input.\n" );
+    }
+
+    r::List pooled = r::List::create( r::Named( "MAE"  ) = CV.pooled.MAE,
+                                      r::Named( "rho"  ) = CV.pooled.rho,
+                                      r::Named( "RMSE" ) = CV.pooled.RMSE );
+
+    return r::List::create( r::Named( "predictions" ) =
+                                DataFrameToDF( CV.predictions ),
+                            r::Named( "folds"       ) =
+                                DataFrameToDF( CV.folds ),
+                            r::Named( "pooled"      ) = pooled );
+}
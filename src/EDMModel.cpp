@@ -0,0 +1,199 @@
+
+#include "RcppEDMCommon.h"
+
+//-------------------------------------------------------------
+// pred as a string, or a vector of start stop row pairs
+//-------------------------------------------------------------
+static std::string PredString( SEXP pred ) {
+    if ( Rf_isString( pred ) ) {
+        return r::as< std::string >( pred );
+    }
+
+    std::vector< int > rows = r::as< std::vector< int > >( pred );
+    std::stringstream  predStream;
+    for ( auto row : rows ) {
+        predStream << row << " ";
+    }
+    return predStream.str();
+}
+
+//-------------------------------------------------------------
+// states as a numeric matrix of state rows, or a vector of one state
+//-------------------------------------------------------------
+static DataFrame< double > StatesDataFrame( SEXP states ) {
+    r::NumericMatrix matrix;
+    if ( Rf_isMatrix( states ) ) {
+        matrix = r::NumericMatrix( states );
+    }
+    else {
+        r::NumericVector state( states );
+        matrix = r::NumericMatrix( 1, state.size(), state.begin() );
+    }
+
+    DataFrame< double > statesDF( matrix.nrow(), matrix.ncol() );
+    for ( int row = 0; row < matrix.nrow(); row++ ) {
+        for ( int col = 0; col < matrix.ncol(); col++ ) {
+            statesDF( row, col ) = matrix( row, col );
+        }
+    }
+    return statesDF;
+}
+
+//-------------------------------------------------------------
+// EDMModel_rcpp methods
+//-------------------------------------------------------------
+EDMModel_rcpp::EDMModel_rcpp( DataFrame< double > & data,
+                              Parameters          & parameters,
+                              std::string           modelFile ) :
+    model( data, parameters, modelFile ) {}
+
+r::DataFrame EDMModel_rcpp::PredictSimplex( SEXP pred ) {
+    return DataFrameToDF( model.PredictSimplex( PredString( pred ) ) );
+}
+
+r::List EDMModel_rcpp::PredictSMap( SEXP pred, double theta ) {
+
+    SMapValues SM = model.PredictSMap( PredString( pred ), theta );
+
+    r::List output =
+        r::List::create( r::Named("predictions")  =
+                         DataFrameToDF( SM.predictions  ),
+                         r::Named("coefficients") =
+                         DataFrameToDF( SM.coefficients ) );
+
+    if ( SM.truncation.NRows() ) {
+        output.push_back( DataFrameToDF( SM.truncation ), "truncation" );
+    }
+
+    return output;
+}
+
+r::DataFrame EDMModel_rcpp::PredictSimplexStates( SEXP states ) {
+    return DataFrameToDF( model.PredictSimplexStates(
+                              StatesDataFrame( states ) ) );
+}
+
+r::List EDMModel_rcpp::PredictSMapStates( SEXP states, double theta ) {
+
+    SMapValues SM = model.PredictSMapStates( StatesDataFrame( states ),
+                                             theta );
+
+    r::List output =
+        r::List::create( r::Named("predictions")  =
+                         DataFrameToDF( SM.predictions  ),
+                         r::Named("coefficients") =
+                         DataFrameToDF( SM.coefficients ) );
+
+    if ( SM.truncation.NRows() ) {
+        output.push_back( DataFrameToDF( SM.truncation ), "truncation" );
+    }
+
+    return output;
+}
+
+r::List EDMModel_rcpp::Neighbors( SEXP pred ) {
+
+    NeighborValues NV = model.Neighbors( PredString( pred ) );
+
+    return r::List::create( r::Named("neighbors") =
+                            DataFrameToDF( NV.neighbors ),
+                            r::Named("distances") =
+                            DataFrameToDF( NV.distances ) );
+}
+
+void EDMModel_rcpp::Save( std::string modelFile ) {
+    model.Save( modelFile );
+}
+
+//-------------------------------------------------------------
+// New EDMModel_rcpp object with the prepared library, or the
+// library loaded from modelFile
+//-------------------------------------------------------------
+SEXP NewEDMModel_rcpp( std::string  pathIn,
+                       std::string  dataFile,
+                       r::DataFrame dataFrame,
+                       std::string  lib,
+                       int          E,
+                       int          Tp,
+                       int          knn,
+                       int          tau,
+                       int          exclusionRadius,
+                       std::string  columns,
+                       std::string  target,
+                       bool         embedded,
+                       bool         const_predict,
+                       bool         verbose,
+                       bool         exactExp,
+                       std::string  solver,
+                       double       ridge,
+                       double       weightCutoff,
+                       double       weightFraction,
+                       unsigned     nThreads,
+                       bool         singlePrecision,
+                       bool         partialDistance,
+                       std::string  metric,
+                       std::string  metricScales,
+                       int          approxTrees,
+                       int          recallSample,
+                       std::string  modelFile ) {
+
+    DataFrame< double > data;
+
+    if ( dataFile.size() ) {
+        // dataFile specified, ignore dataFrame
+        data = DataFrame< double >( pathIn, dataFile );
+    }
+    else if ( dataFrame.size() ) {
+        data = DFToDataFrame( dataFrame );
+    }
+    else {
+        Rcpp::stop( "NewEDMModel_rcpp(): Invalid input.\n" );
+    }
+
+    // Model parameters are validated for each query: Method::None
+    Parameters parameters = Parameters( Method::None,
+                                        "",              // pathIn
+                                        "",              // dataFile
+                                        "./",            // pathOut
+                                        "",              // predictFile
+                                        lib,             // lib_str
+                                        "",              // pred_str
+                                        E,               //
+                                        Tp,              //
+                                        knn,             //
+                                        tau,             //
+                                        0,               // theta
+                                        exclusionRadius, //
+                                        columns,         //
+                                        target,          //
+                                        embedded,        //
+                                        const_predict,   //
+                                        verbose,         //
+                                        "",              // SmapFile
+                                        "",              // blockFile
+                                        0,               // multiviewEnsemble
+                                        0,               // multiviewD
+                                        true,            // multiviewTrainLib
+                                        false,           // multiviewExcludeTarg
+                                        "",              // libSizes_str
+                                        0,               // subSamples
+                                        true,            // randomLib
+                                        false,           // replacement
+                                        0,               // seed
+                                        false,           // includeData
+                                        exactExp,        //
+                                        solver,          // solver_str
+                                        ridge,           //
+                                        weightCutoff,    //
+                                        weightFraction,  //
+                                        nThreads,        //
+                                        singlePrecision, //
+                                        partialDistance, //
+                                        metric,          // metric_str
+                                        metricScales,    // metricScales_str
+                                        approxTrees,     //
+                                        recallSample );  //
+
+    return r::internal::make_new_object(
+        new EDMModel_rcpp( data, parameters, modelFile ) );
+}
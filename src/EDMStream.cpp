@@ -0,0 +1,102 @@
+
+#include "RcppEDMCommon.h"
+
+//-------------------------------------------------------------
+// EDMStream_rcpp methods
+//-------------------------------------------------------------
+EDMStream_rcpp::EDMStream_rcpp( DataFrame< double > & data,
+                                Parameters          & parameters ) :
+    stream( data, parameters ) {}
+
+void EDMStream_rcpp::Append( r::DataFrame rows ) {
+    DataFrame< double > rowsDF = DFToDataFrame( rows );
+    stream.Append( rowsDF );
+}
+
+r::DataFrame EDMStream_rcpp::Forecast() {
+    return DataFrameToDF( stream.Forecast() );
+}
+
+//-------------------------------------------------------------
+// New EDMStream_rcpp object with the prepared history data
+//-------------------------------------------------------------
+SEXP NewEDMStream_rcpp( std::string  pathIn,
+                        std::string  dataFile,
+                        r::DataFrame dataFrame,
+                        std::string  lib,
+                        int          E,
+                        int          Tp,
+                        int          knn,
+                        int          tau,
+                        int          exclusionRadius,
+                        std::string  columns,
+                        std::string  target,
+                        bool         embedded,
+                        bool         const_predict,
+                        bool         verbose,
+                        bool         exactExp,
+                        bool         singlePrecision,
+                        std::string  metric,
+                        std::string  metricScales,
+                        int          approxTrees ) {
+
+    DataFrame< double > data;
+
+    if ( dataFile.size() ) {
+        // dataFile specified, ignore dataFrame
+        data = DataFrame< double >( pathIn, dataFile );
+    }
+    else if ( dataFrame.size() ) {
+        data = DFToDataFrame( dataFrame );
+    }
+    else {
+        Rcpp::stop( "NewEDMStream_rcpp(): Invalid input.\n" );
+    }
+
+    // Validated by EDMStream as Method::Simplex
+    Parameters parameters = Parameters( Method::None,
+                                        "",              // pathIn
+                                        "",              // dataFile
+                                        "./",            // pathOut
+                                        "",              // predictFile
+                                        lib,             // lib_str
+                                        "",              // pred_str
+                                        E,               //
+                                        Tp,              //
+                                        knn,             //
+                                        tau,             //
+                                        0,               // theta
+                                        exclusionRadius, //
+                                        columns,         //
+                                        target,          //
+                                        embedded,        //
+                                        const_predict,   //
+                                        verbose,         //
+                                        "",              // SmapFile
+                                        "",              // blockFile
+                                        0,               // multiviewEnsemble
+                                        0,               // multiviewD
+                                        true,            // multiviewTrainLib
+                                        false,           // multiviewExcludeTarg
+                                        "",              // libSizes_str
+                                        0,               // subSamples
+                                        true,            // randomLib
+                                        false,           // replacement
+                                        0,               // seed
+                                        false,           // includeData
+                                        exactExp,        //
+                                        "SVD",           // solver_str
+                                        0,               // ridge
+                                        0,               // weightCutoff
+                                        1,               // weightFraction
+                                        1,               // nThreads
+                                        singlePrecision, //
+                                        false,           // partialDistance
+                                        metric,          // metric_str
+                                        metricScales,    // metricScales_str
+                                        approxTrees,     //
+                                        0 );             // recallSample
+
+    return r::internal::make_new_object(
+        new EDMStream_rcpp( data, parameters ) );
+}
@@ -0,0 +1,129 @@
+
+#include "RcppEDMCommon.h"
+
+//----------------------------------------------------------
+// Series of the panel: the series column groups of a long
+// format data.frame, or the data.frames of a list
+//----------------------------------------------------------
+static std::vector< DataFrame< double > > PanelFrames( r::List     dataList,
+                                                       std::string series ) {
+    if ( not dataList.size() ) {
+        Rcpp::stop( "Panel: Invalid input.\n" );
+    }
+
+    if ( series.size() ) {
+        return PanelSeries( DFToDataFrame( r::DataFrame( dataList ) ), series );
+    }
+
+    std::vector< DataFrame< double > > panel;
+    panel.reserve( dataList.size() );
+    for ( R_xlen_t i = 0; i < dataList.size(); i++ ) {
+        panel.push_back( DFToDataFrame( r::DataFrame( dataList[ i ] ) ) );
+    }
+    return panel;
+}
+
+//----------------------------------------------------------
+// 
+//----------------------------------------------------------
+r::DataFrame SimplexPanel_rcpp( r::List     dataList,
+                                std::string series,
+                                std::string lib,
+                                std::string pred,
+                                int         E,
+                                int         Tp,
+                                int         knn,
+                                int         tau,
+                                int         exclusionRadius,
+                                std::string columns,
+                                std::string target, 
+                                bool        embedded,
+                                bool        const_predict,
+                                bool        verbose,
+                                bool        exactExp,
+                                bool        singlePrecision,
+                                std::string metric,
+                                std::string metricScales,
+                                unsigned    nThreads ) {
+
+    std::vector< DataFrame< double > > panel =
+        PanelFrames( dataList, series );
+
+    PanelValues PV = SimplexPanel( panel,
+                                   lib,
+                                   pred,
+                                   E,
+                                   Tp,
+                                   knn,
+                                   tau,
+                                   exclusionRadius,
+                                   columns,
+                                   target,
+                                   embedded,
+                                   const_predict,
+                                   verbose,
+                                   exactExp,
+                                   singlePrecision,
+                                   metric,
+                                   metricScales,
+                                   nThreads );
+
+    return DataFrameToDF( PV.predictions );
+}
+
+//----------------------------------------------------------
+// 
+//----------------------------------------------------------
+r::List SMapPanel_rcpp( r::List     dataList,
+                        std::string series,
+                        std::string lib,
+                        std::string pred,
+                        int         E,
+                        int         Tp,
+                        int         knn,
+                        int         tau,
+                        double      theta,
+                        int         exclusionRadius,
+                        std::string columns,
+                        std::string target, 
+                        bool        embedded,
+                        bool        const_predict,
+                        bool        verbose,
+                        bool        exactExp,
+                        std::string solver,
+                        double      ridge,
+                        bool        singlePrecision,
+                        std::string metric,
+                        std::string metricScales,
+                        unsigned    nThreads ) {
+
+    std::vector< DataFrame< double > > panel =
+        PanelFrames( dataList, series );
+
+    PanelValues PV = SMapPanel( panel,
+                                lib,
+                                pred,
+                                E,
+                                Tp,
+                                knn,
+                                tau,
+                                theta,
+                                exclusionRadius,
+                                columns,
+                                target,
+                                embedded,
+                                const_predict,
+                                verbose,
+                                exactExp,
+                                solver,
+                                ridge,
+                                singlePrecision,
+                                metric,
+                                metricScales,
+                                nThreads );
+
+    return r::List::create( r::Named("predictions")  =
+                            DataFrameToDF( PV.predictions  ),
+                            r::Named("coefficients") =
+                            DataFrameToDF( PV.coefficients ) );
+}
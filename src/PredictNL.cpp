@@ -20,7 +20,10 @@ r::DataFrame PredictNonlinear_rcpp( std::string  pathIn,
                                     std::string  target,
                                     bool         embedded,
                                     bool         verbose,
-                                    unsigned     numThreads ) {
+                                    unsigned     numThreads,
+                                    std::string  solver,
+                                    double       ridge,
+                                    std::string  ridgePath ) {
 
     DataFrame< double > PredictDF;
 
@@ -42,7 +45,10 @@ r::DataFrame PredictNonlinear_rcpp( std::string  pathIn,
                                        target,
                                        embedded,
                                        verbose,
-                                       numThreads );
+                                       numThreads,
+                                       solver,
+                                       ridge,
+                                       ridgePath );
     }
     else if ( dataFrame.size() ) {
         DataFrame< double > dataFrame_ = DFToDataFrame( dataFrame );
@@ -61,7 +67,10 @@ r::DataFrame PredictNonlinear_rcpp( std::string  pathIn,
                                        target,
                                        embedded,
                                        verbose,
-                                       numThreads );
+                                       numThreads,
+                                       solver,
+                                       ridge,
+                                       ridgePath );
     }
     else {
         Rcpp::warning("PredictNonlinear_rcpp(): Invalid input.\n");
@@ -13,6 +13,28 @@
 
 #include "RcppEDMCommon.h"
 
+//-------------------------------------------------------------------------
+// Rcpp::List::create() takes at most 20 elements: argument lists longer
+// than 20 are created in parts and joined in order.
+//-------------------------------------------------------------------------
+static r::List JoinArgs( r::List first, r::List second ) {
+    r::List          args ( first.size() + second.size() );
+    r::CharacterVector names( first.size() + second.size() );
+    r::CharacterVector firstNames  = first.names();
+    r::CharacterVector secondNames = second.names();
+
+    for ( R_xlen_t i = 0; i < first.size(); i++ ) {
+        args [ i ] = first[ i ];
+        names[ i ] = firstNames[ i ];
+    }
+    for ( R_xlen_t i = 0; i < second.size(); i++ ) {
+        args [ first.size() + i ] = second[ i ];
+        names[ first.size() + i ] = secondNames[ i ];
+    }
+    args.names() = names;
+    return args;
+}
+
 //-------------------------------------------------------------------------
 // Definitions of formal arguments and default params of the R functions
 // that encapsulate the C++ functions in an Rcpp::List.
@@ -35,7 +57,7 @@ auto EmbedArgs = r::List::create(
     r::_["columns"]  = std::string(""),
     r::_["verbose"]  = false );
 
-auto SimplexArgs = r::List::create( 
+auto SimplexArgs = JoinArgs( r::List::create( 
     r::_["pathIn"]          = std::string("./"),
     r::_["dataFile"]        = std::string(""),
     r::_["dataFrame"]       = r::DataFrame(),
@@ -47,14 +69,21 @@ auto SimplexArgs = r::List::create(
     r::_["Tp"]              = 1,
     r::_["knn"]             = 0,
     r::_["tau"]             = -1,
-    r::_["exclusionRadius"] = 0,
+    r::_["exclusionRadius"] = 0 ), r::List::create(
     r::_["columns"]         = std::string(""),
     r::_["target"]          = std::string(""),
     r::_["embedded"]        = false,
     r::_["const_predict"]   = false,
-    r::_["verbose"]         = false );
+    r::_["verbose"]         = false,
+    r::_["exactExp"]        = false,
+    r::_["singlePrecision"] = false,
+    r::_["partialDistance"] = false,
+    r::_["metric"]          = std::string("Euclidean"),
+    r::_["metricScales"]    = std::string(""),
+    r::_["approxTrees"]     = 0,
+    r::_["recallSample"]    = 0 ) );
     
-auto SMapArgs = r::List::create( 
+auto SMapArgs = JoinArgs( r::List::create( 
     r::_["pathIn"]          = std::string("./"),
     r::_["dataFile"]        = std::string("./"),
     r::_["dataFrame"]       = r::DataFrame(),
@@ -67,14 +96,214 @@ auto SMapArgs = r::List::create(
     r::_["knn"]             = 0,
     r::_["tau"]             = -1,
     r::_["theta"]           = 0,
-    r::_["exclusionRadius"] = 0,
+    r::_["exclusionRadius"] = 0 ), r::List::create(
     r::_["columns"]         = std::string(""),
     r::_["target"]          = std::string(""),
     r::_["smapFile"]        = std::string(""),
     r::_["jacobians"]       = std::string(""),
     r::_["embedded"]        = false,
     r::_["const_predict"]   = false,
-    r::_["verbose"]         = false );
+    r::_["verbose"]         = false,
+    r::_["exactExp"]        = false,
+    r::_["solver"]          = std::string("SVD"),
+    r::_["ridge"]           = 0,
+    r::_["weightCutoff"]    = 0,
+    r::_["weightFraction"]  = 1,
+    r::_["nThreads"]        = 1,
+    r::_["singlePrecision"] = false,
+    r::_["partialDistance"] = false,
+    r::_["metric"]          = std::string("Euclidean"),
+    r::_["metricScales"]    = std::string(""),
+    r::_["approxTrees"]     = 0,
+    r::_["recallSample"]    = 0 ) );
+
+auto EDMModelArgs = JoinArgs( r::List::create( 
+    r::_["pathIn"]          = std::string("./"),
+    r::_["dataFile"]        = std::string(""),
+    r::_["dataFrame"]       = r::DataFrame(),
+    r::_["lib"]             = std::string(""),
+    r::_["E"]               = 0,
+    r::_["Tp"]              = 1,
+    r::_["knn"]             = 0,
+    r::_["tau"]             = -1,
+    r::_["exclusionRadius"] = 0,
+    r::_["columns"]         = std::string(""),
+    r::_["target"]          = std::string(""),
+    r::_["embedded"]        = false,
+    r::_["const_predict"]   = false ), r::List::create(
+    r::_["verbose"]         = false,
+    r::_["exactExp"]        = false,
+    r::_["solver"]          = std::string("SVD"),
+    r::_["ridge"]           = 0,
+    r::_["weightCutoff"]    = 0,
+    r::_["weightFraction"]  = 1,
+    r::_["nThreads"]        = 1,
+    r::_["singlePrecision"] = false,
+    r::_["partialDistance"] = false,
+    r::_["metric"]          = std::string("Euclidean"),
+    r::_["metricScales"]    = std::string(""),
+    r::_["approxTrees"]     = 0,
+    r::_["recallSample"]    = 0,
+    r::_["modelFile"]       = std::string("") ) );
+
+auto SimplexPanelArgs = JoinArgs( r::List::create( 
+    r::_["dataFrame"]       = r::List(),
+    r::_["series"]          = std::string(""),
+    r::_["lib"]             = std::string(""),
+    r::_["pred"]            = std::string(""),
+    r::_["E"]               = 0,
+    r::_["Tp"]              = 1,
+    r::_["knn"]             = 0,
+    r::_["tau"]             = -1,
+    r::_["exclusionRadius"] = 0 ), r::List::create(
+    r::_["columns"]         = std::string(""),
+    r::_["target"]          = std::string(""),
+    r::_["embedded"]        = false,
+    r::_["const_predict"]   = false,
+    r::_["verbose"]         = false,
+    r::_["exactExp"]        = false,
+    r::_["singlePrecision"] = false,
+    r::_["metric"]          = std::string("Euclidean"),
+    r::_["metricScales"]    = std::string(""),
+    r::_["nThreads"]        = 4 ) );
+
+auto SMapPanelArgs = JoinArgs( r::List::create( 
+    r::_["dataFrame"]       = r::List(),
+    r::_["series"]          = std::string(""),
+    r::_["lib"]             = std::string(""),
+    r::_["pred"]            = std::string(""),
+    r::_["E"]               = 0,
+    r::_["Tp"]              = 1,
+    r::_["knn"]             = 0,
+    r::_["tau"]             = -1,
+    r::_["theta"]           = 0,
+    r::_["exclusionRadius"] = 0 ), r::List::create(
+    r::_["columns"]         = std::string(""),
+    r::_["target"]          = std::string(""),
+    r::_["embedded"]        = false,
+    r::_["const_predict"]   = false,
+    r::_["verbose"]         = false,
+    r::_["exactExp"]        = false,
+    r::_["solver"]          = std::string("SVD"),
+    r::_["ridge"]           = 0,
+    r::_["singlePrecision"] = false,
+    r::_["metric"]          = std::string("Euclidean"),
+    r::_["metricScales"]    = std::string(""),
+    r::_["nThreads"]        = 4 ) );
+
+auto CrossValidationArgs = JoinArgs( r::List::create( 
+    r::_["pathIn"]          = std::string("./"),
+    r::_["dataFile"]        = std::string(""),
+    r::_["dataFrame"]       = r::DataFrame(),
+    r::_["lib"]             = std::string(""),
+    r::_["E"]               = 0,
+    r::_["Tp"]              = 1,
+    r::_["knn"]             = 0,
+    r::_["tau"]             = -1,
+    r::_["exclusionRadius"] = 0,
+    r::_["columns"]         = std::string(""),
+    r::_["target"]          = std::string("") ), r::List::create(
+    r::_["folds"]           = 10,
+    r::_["foldBuffer"]      = 0,
+    r::_["embedded"]        = false,
+    r::_["const_predict"]   = false,
+    r::_["verbose"]         = false,
+    r::_["exactExp"]        = false,
+    r::_["singlePrecision"] = false,
+    r::_["metric"]          = std::string("Euclidean"),
+    r::_["metricScales"]    = std::string(""),
+    r::_["nThreads"]        = 4 ) );
+
+auto BacktestArgs = JoinArgs( r::List::create( 
+    r::_["pathIn"]          = std::string("./"),
+    r::_["dataFile"]        = std::string(""),
+    r::_["dataFrame"]       = r::DataFrame(),
+    r::_["lib"]             = std::string(""),
+    r::_["E"]               = 0,
+    r::_["Tp"]              = 1,
+    r::_["knn"]             = 0,
+    r::_["tau"]             = -1,
+    r::_["theta"]           = 0,
+    r::_["exclusionRadius"] = 0,
+    r::_["columns"]         = std::string(""),
+    r::_["target"]          = std::string("") ), r::List::create(
+    r::_["method"]          = std::string("Simplex"),
+    r::_["step"]            = 1,
+    r::_["window"]          = 0,
+    r::_["embedded"]        = false,
+    r::_["verbose"]         = false,
+    r::_["exactExp"]        = false,
+    r::_["singlePrecision"] = false,
+    r::_["metric"]          = std::string("Euclidean"),
+    r::_["metricScales"]    = std::string(""),
+    r::_["nThreads"]        = 4 ) );
+
+auto EDMStreamArgs = r::List::create(
+    r::_["pathIn"]          = std::string("./"),
+    r::_["dataFile"]        = std::string(""),
+    r::_["dataFrame"]       = r::DataFrame(),
+    r::_["lib"]             = std::string(""),
+    r::_["E"]               = 0,
+    r::_["Tp"]              = 1,
+    r::_["knn"]             = 0,
+    r::_["tau"]             = -1,
+    r::_["exclusionRadius"] = 0,
+    r::_["columns"]         = std::string(""),
+    r::_["target"]          = std::string(""),
+    r::_["embedded"]        = false,
+    r::_["const_predict"]   = false,
+    r::_["verbose"]         = false,
+    r::_["exactExp"]        = false,
+    r::_["singlePrecision"] = false,
+    r::_["metric"]          = std::string("Euclidean"),
+    r::_["metricScales"]    = std::string(""),
+    r::_["approxTrees"]     = 0 );
+
+auto SMapMultiTargetArgs = JoinArgs( r::List::create( 
+    r::_["pathIn"]          = std::string("./"),
+    r::_["dataFile"]        = std::string(""),
+    r::_["dataFrame"]       = r::DataFrame(),
+    r::_["lib"]             = std::string(""),
+    r::_["pred"]            = std::string(""),
+    r::_["E"]               = 0,
+    r::_["Tp"]              = 1,
+    r::_["knn"]             = 0,
+    r::_["tau"]             = -1,
+    r::_["theta"]           = 0,
+    r::_["exclusionRadius"] = 0 ), r::List::create(
+    r::_["columns"]         = std::string(""),
+    r::_["target"]          = std::string(""),
+    r::_["embedded"]        = false,
+    r::_["const_predict"]   = false,
+    r::_["verbose"]         = false,
+    r::_["exactExp"]        = false,
+    r::_["solver"]          = std::string("SVD"),
+    r::_["ridge"]           = 0,
+    r::_["weightCutoff"]    = 0,
+    r::_["weightFraction"]  = 1 ) );
+
+auto SMapRidgePathArgs = JoinArgs( r::List::create( 
+    r::_["pathIn"]          = std::string("./"),
+    r::_["dataFile"]        = std::string(""),
+    r::_["dataFrame"]       = r::DataFrame(),
+    r::_["lib"]             = std::string(""),
+    r::_["pred"]            = std::string(""),
+    r::_["E"]               = 0,
+    r::_["Tp"]              = 1,
+    r::_["knn"]             = 0,
+    r::_["tau"]             = -1,
+    r::_["theta"]           = 0,
+    r::_["exclusionRadius"] = 0 ), r::List::create(
+    r::_["columns"]         = std::string(""),
+    r::_["target"]          = std::string(""),
+    r::_["ridgePath"]       = std::string(""),
+    r::_["embedded"]        = false,
+    r::_["const_predict"]   = false,
+    r::_["verbose"]         = false,
+    r::_["exactExp"]        = false,
+    r::_["weightCutoff"]    = 0,
+    r::_["weightFraction"]  = 1,
+    r::_["nThreads"]        = 1 ) );
 
 auto MultiviewArgs = r::List::create( 
     r::_["pathIn"]          = std::string("./"),
@@ -98,7 +327,7 @@ auto MultiviewArgs = r::List::create(
     r::_["verbose"]         = false,
     r::_["numThreads"]      = 4 );
 
-auto CCMArgs = r::List::create( 
+auto CCMArgs = JoinArgs( r::List::create( 
     r::_["pathIn"]          = std::string("./"),
     r::_["dataFile"]        = std::string(""),
     r::_["dataFrame"]       = r::DataFrame(),
@@ -108,7 +337,7 @@ auto CCMArgs = r::List::create(
     r::_["Tp"]              = 0,
     r::_["knn"]             = 0,
     r::_["tau"]             = -1,
-    r::_["exlcusionRadius"] = 0,
+    r::_["exlcusionRadius"] = 0 ), r::List::create(
     r::_["columns"]         = std::string(""),
     r::_["target"]          = std::string(""),
     r::_["libSizes"]        = std::string(""),
@@ -117,7 +346,10 @@ auto CCMArgs = r::List::create(
     r::_["replacement"]     = false,
     r::_["seed"]            = 0,
     r::_["includeData"]     = false,
-    r::_["verbose"]         = false );
+    r::_["verbose"]         = false,
+    r::_["singlePrecision"] = false,
+    r::_["metric"]          = std::string("Euclidean"),
+    r::_["metricScales"]    = std::string("") ) );
     
 auto EmbedDimensionArgs = r::List::create( 
     r::_["pathIn"]      = std::string("./"),
@@ -170,7 +402,10 @@ auto PredictNonlinearArgs = r::List::create(
     r::_["target"]      = std::string(""),
     r::_["embedded"]    = false,
     r::_["verbose"]     = false,
-    r::_["numThreads"]  = 4 );
+    r::_["numThreads"]  = 4,
+    r::_["solver"]      = std::string("SVD"),
+    r::_["ridge"]       = 0,
+    r::_["ridgePath"]   = std::string("") );
 
 //-------------------------------------------------------------------------
 // Export / map the functions
@@ -186,6 +421,18 @@ RCPP_MODULE(EDMInternal) {
     r::function( "RtoCpp_Embed",         &Embed_rcpp,      EmbedArgs         );
     r::function( "RtoCpp_Simplex",       &Simplex_rcpp,    SimplexArgs       );
     r::function( "RtoCpp_SMap",          &SMap_rcpp,       SMapArgs          );
+    r::function( "RtoCpp_SMapMultiTarget",  &SMapMultiTarget_rcpp,
+                                             SMapMultiTargetArgs  );
+    r::function( "RtoCpp_SMapRidgePath",    &SMapRidgePath_rcpp,
+                                             SMapRidgePathArgs    );
+    r::function( "RtoCpp_SimplexPanel",     &SimplexPanel_rcpp,
+                                             SimplexPanelArgs     );
+    r::function( "RtoCpp_SMapPanel",        &SMapPanel_rcpp,
+                                             SMapPanelArgs        );
+    r::function( "RtoCpp_CrossValidation",  &CrossValidation_rcpp,
+                                             CrossValidationArgs  );
+    r::function( "RtoCpp_Backtest",         &Backtest_rcpp,
+                                             BacktestArgs         );
     r::function( "RtoCpp_Multiview",     &Multiview_rcpp,  MultiviewArgs     );
     r::function( "RtoCpp_CCM",           &CCM_rcpp,        CCMArgs           );
     r::function( "RtoCpp_EmbedDimension",   &EmbedDimension_rcpp, 
@@ -194,4 +441,22 @@ RCPP_MODULE(EDMInternal) {
                                              PredictIntervalArgs  );
     r::function( "RtoCpp_PredictNonlinear", &PredictNonlinear_rcpp, 
                                              PredictNonlinearArgs );
+    r::function( "RtoCpp_NewEDMModel",      &NewEDMModel_rcpp,
+                                             EDMModelArgs         );
+    r::function( "RtoCpp_NewEDMStream",     &NewEDMStream_rcpp,
+                                             EDMStreamArgs        );
+
+    r::class_< EDMModel_rcpp >( "RtoCpp_EDMModel" )
+        .method( "predictSimplex", &EDMModel_rcpp::PredictSimplex )
+        .method( "predictSMap",    &EDMModel_rcpp::PredictSMap    )
+        .method( "neighbors",      &EDMModel_rcpp::Neighbors      )
+        .method( "save",           &EDMModel_rcpp::Save           )
+        .method( "predictSimplexStates",
+                 &EDMModel_rcpp::PredictSimplexStates )
+        .method( "predictSMapStates",
+                 &EDMModel_rcpp::PredictSMapStates    );
+
+    r::class_< EDMStream_rcpp >( "RtoCpp_EDMStream" )
+        .method( "append",   &EDMStream_rcpp::Append   )
+        .method( "forecast", &EDMStream_rcpp::Forecast );
 }
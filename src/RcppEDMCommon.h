@@ -38,7 +38,10 @@ r::DataFrame PredictNonlinear_rcpp( std::string  pathIn,
                                     std::string  target,
                                     bool         embedded,
                                     bool         verbose,
-                                    unsigned     numThreads );
+                                    unsigned     numThreads,
+                                    std::string  solver,
+                                    double       ridge,
+                                    std::string  ridgePath );
 
 r::DataFrame PredictInterval_rcpp( std::string  pathIn,
                                    std::string  dataFile,
@@ -127,7 +130,10 @@ r::List CCM_rcpp( std::string  pathIn,
                   bool         replacement,
                   unsigned     seed,
                   bool         includeData,
-                  bool         verbose );
+                  bool         verbose,
+                  bool         singlePrecision,
+                  std::string  metric,
+                  std::string  metricScales );
 
 r::DataFrame Simplex_rcpp( std::string  pathIn,
                            std::string  dataFile,
@@ -145,7 +151,14 @@ r::DataFrame Simplex_rcpp( std::string  pathIn,
                            std::string  target,
                            bool         embedded,
                            bool         const_predict,
-                           bool         verbose );
+                           bool         verbose,
+                           bool         exactExp,
+                           bool         singlePrecision,
+                           bool         partialDistance,
+                           std::string  metric,
+                           std::string  metricScales,
+                           int          approxTrees,
+                           int          recallSample );
 
 r::List SMap_rcpp( std::string  pathIn, 
                    std::string  dataFile,
@@ -166,5 +179,232 @@ r::List SMap_rcpp( std::string  pathIn,
                    std::string  jacobians,
                    bool         embedded,
                    bool         const_predict,
-                   bool         verbose );
+                   bool         verbose,
+                   bool         exactExp,
+                   std::string  solver,
+                   double       ridge,
+                   double       weightCutoff,
+                   double       weightFraction,
+                   unsigned     nThreads,
+                   bool         singlePrecision,
+                   bool         partialDistance,
+                   std::string  metric,
+                   std::string  metricScales,
+                   int          approxTrees,
+                   int          recallSample );
+
+r::List SMapMultiTarget_rcpp( std::string  pathIn, 
+                              std::string  dataFile,
+                              r::DataFrame dataList,
+                              std::string  lib,
+                              std::string  pred, 
+                              int          E,
+                              int          Tp,
+                              int          knn,
+                              int          tau,
+                              double       theta,
+                              int          exclusionRadius, 
+                              std::string  columns,
+                              std::string  target,
+                              bool         embedded,
+                              bool         const_predict,
+                              bool         verbose,
+                              bool         exactExp,
+                              std::string  solver,
+                              double       ridge,
+                              double       weightCutoff,
+                              double       weightFraction );
+
+r::List SMapRidgePath_rcpp( std::string  pathIn, 
+                            std::string  dataFile,
+                            r::DataFrame dataList,
+                            std::string  lib,
+                            std::string  pred, 
+                            int          E,
+                            int          Tp,
+                            int          knn,
+                            int          tau,
+                            double       theta,
+                            int          exclusionRadius, 
+                            std::string  columns,
+                            std::string  target,
+                            std::string  ridgePath,
+                            bool         embedded,
+                            bool         const_predict,
+                            bool         verbose,
+                            bool         exactExp,
+                            double       weightCutoff,
+                            double       weightFraction,
+                            unsigned     nThreads );
+
+//-------------------------------------------------------------
+// EDMModel exposed to R as class RtoCpp_EDMModel: a prepared
+// library for repeated Simplex, SMap and neighbor queries.
+// pred is a string or vector of start stop row pairs.
+// save() writes the prepared library to a model file.
+//-------------------------------------------------------------
+class EDMModel_rcpp {
+public:
+    EDMModel model;
+
+    EDMModel_rcpp( DataFrame< double > & data, Parameters & parameters,
+                   std::string modelFile );
+
+    r::DataFrame PredictSimplex( SEXP pred );
+    r::List      PredictSMap   ( SEXP pred, double theta );
+    r::List      Neighbors     ( SEXP pred );
+    void         Save          ( std::string modelFile );
+    r::DataFrame PredictSimplexStates( SEXP states );
+    r::List      PredictSMapStates   ( SEXP states, double theta );
+};
+
+SEXP NewEDMModel_rcpp( std::string  pathIn,
+                       std::string  dataFile,
+                       r::DataFrame dataList,
+                       std::string  lib,
+                       int          E,
+                       int          Tp,
+                       int          knn,
+                       int          tau,
+                       int          exclusionRadius,
+                       std::string  columns,
+                       std::string  target,
+                       bool         embedded,
+                       bool         const_predict,
+                       bool         verbose,
+                       bool         exactExp,
+                       std::string  solver,
+                       double       ridge,
+                       double       weightCutoff,
+                       double       weightFraction,
+                       unsigned     nThreads,
+                       bool         singlePrecision,
+                       bool         partialDistance,
+                       std::string  metric,
+                       std::string  metricScales,
+                       int          approxTrees,
+                       int          recallSample,
+                       std::string  modelFile );
+
+r::DataFrame SimplexPanel_rcpp( r::List     dataList,
+                                std::string series,
+                                std::string lib,
+                                std::string pred,
+                                int         E,
+                                int         Tp,
+                                int         knn,
+                                int         tau,
+                                int         exclusionRadius,
+                                std::string columns,
+                                std::string target, 
+                                bool        embedded,
+                                bool        const_predict,
+                                bool        verbose,
+                                bool        exactExp,
+                                bool        singlePrecision,
+                                std::string metric,
+                                std::string metricScales,
+                                unsigned    nThreads );
+
+r::List SMapPanel_rcpp( r::List     dataList,
+                        std::string series,
+                        std::string lib,
+                        std::string pred,
+                        int         E,
+                        int         Tp,
+                        int         knn,
+                        int         tau,
+                        double      theta,
+                        int         exclusionRadius,
+                        std::string columns,
+                        std::string target, 
+                        bool        embedded,
+                        bool        const_predict,
+                        bool        verbose,
+                        bool        exactExp,
+                        std::string solver,
+                        double      ridge,
+                        bool        singlePrecision,
+                        std::string metric,
+                        std::string metricScales,
+                        unsigned    nThreads );
+
+r::List CrossValidation_rcpp( std::string  pathIn,
+                              std::string  dataFile,
+                              r::DataFrame dataFrame,
+                              std::string  lib,
+                              int          E,
+                              int          Tp,
+                              int          knn,
+                              int          tau,
+                              int          exclusionRadius,
+                              std::string  columns,
+                              std::string  target,
+                              int          folds,
+                              int          foldBuffer,
+                              bool         embedded,
+                              bool         const_predict,
+                              bool         verbose,
+                              bool         exactExp,
+                              bool         singlePrecision,
+                              std::string  metric,
+                              std::string  metricScales,
+                              unsigned     nThreads );
+
+r::List Backtest_rcpp( std::string  pathIn,
+                       std::string  dataFile,
+                       r::DataFrame dataFrame,
+                       std::string  lib,
+                       int          E,
+                       int          Tp,
+                       int          knn,
+                       int          tau,
+                       double       theta,
+                       int          exclusionRadius,
+                       std::string  columns,
+                       std::string  target,
+                       std::string  method,
+                       int          step,
+                       int          window,
+                       bool         embedded,
+                       bool         verbose,
+                       bool         exactExp,
+                       bool         singlePrecision,
+                       std::string  metric,
+                       std::string  metricScales,
+                       unsigned     nThreads );
+
+//-------------------------------------------------------------
+// EDMStream exposed to R as class RtoCpp_EDMStream: a streaming
+// Simplex session of appended observations.
+//-------------------------------------------------------------
+class EDMStream_rcpp {
+public:
+    EDMStream stream;
+
+    EDMStream_rcpp( DataFrame< double > & data, Parameters & parameters );
+
+    void         Append  ( r::DataFrame rows );
+    r::DataFrame Forecast();
+};
+
+SEXP NewEDMStream_rcpp( std::string  pathIn,
+                        std::string  dataFile,
+                        r::DataFrame dataList,
+                        std::string  lib,
+                        int          E,
+                        int          Tp,
+                        int          knn,
+                        int          tau,
+                        int          exclusionRadius,
+                        std::string  columns,
+                        std::string  target,
+                        bool         embedded,
+                        bool         const_predict,
+                        bool         verbose,
+                        bool         exactExp,
+                        bool         singlePrecision,
+                        std::string  metric,
+                        std::string  metricScales,
+                        int          approxTrees );
 #endif
@@ -22,7 +22,19 @@ r::List SMap_rcpp( std::string  pathIn,
                    std::string  jacobians,
                    bool         embedded,
                    bool         const_predict,
-                   bool         verbose ) {
+                   bool         verbose,
+                   bool         exactExp,
+                   std::string  solver,
+                   double       ridge,
+                   double       weightCutoff,
+                   double       weightFraction,
+                   unsigned     nThreads,
+                   bool         singlePrecision,
+                   bool         partialDistance,
+                   std::string  metric,
+                   std::string  metricScales,
+                   int          approxTrees,
+                   int          recallSample ) {
     
     SMapValues SM;
     
@@ -47,7 +59,19 @@ r::List SMap_rcpp( std::string  pathIn,
                    jacobians,
                    embedded,
                    const_predict,
-                   verbose );
+                   verbose,
+                   exactExp,
+                   solver,
+                   ridge,
+                   weightCutoff,
+                   weightFraction,
+                   nThreads,
+                   singlePrecision,
+                   partialDistance,
+                   metric,
+                   metricScales,
+                   approxTrees,
+                   recallSample );
     }
     else if ( dataFrame.size() ) {
         DataFrame< double > dataFrame_ = DFToDataFrame( dataFrame );
@@ -69,7 +93,19 @@ r::List SMap_rcpp( std::string  pathIn,
                    jacobians,
                    embedded,
                    const_predict,
-                   verbose );
+                   verbose,
+                   exactExp,
+                   solver,
+                   ridge,
+                   weightCutoff,
+                   weightFraction,
+                   nThreads,
+                   singlePrecision,
+                   partialDistance,
+                   metric,
+                   metricScales,
+                   approxTrees,
+                   recallSample );
     }
     else {
         Rcpp::warning( "SMap_rcpp(): Invalid input.\n" );
@@ -80,5 +116,205 @@ r::List SMap_rcpp( std::string  pathIn,
     r::List output = r::List::create( r::Named("predictions")  = df_pred,
                                       r::Named("coefficients") = df_coef );
 
+    if ( SM.truncation.NRows() ) {
+        output.push_back( DataFrameToDF( SM.truncation ), "truncation" );
+    }
+
+    return output;
+}
+
+//----------------------------------------------------------
+// Multi-target SMap: list of SMap_rcpp() lists named by target
+//----------------------------------------------------------
+r::List SMapMultiTarget_rcpp( std::string  pathIn, 
+                              std::string  dataFile,
+                              r::DataFrame dataFrame,
+                              std::string  lib,
+                              std::string  pred, 
+                              int          E,
+                              int          Tp,
+                              int          knn,
+                              int          tau,
+                              double       theta,
+                              int          exlusionRadius,
+                              std::string  columns,
+                              std::string  target,
+                              bool         embedded,
+                              bool         const_predict,
+                              bool         verbose,
+                              bool         exactExp,
+                              std::string  solver,
+                              double       ridge,
+                              double       weightCutoff,
+                              double       weightFraction ) {
+
+    SMapMultiTargetValues SM;
+
+    if ( dataFile.size() ) {
+        // dataFile specified, dispatch overloaded SMap, ignore dataFrame
+
+        SM = SMapMultiTarget( pathIn,
+                              dataFile,
+                              lib,
+                              pred,
+                              E, 
+                              Tp,
+                              knn,
+                              tau,
+                              theta,
+                              exlusionRadius,
+                              columns, 
+                              target,
+                              embedded,
+                              const_predict,
+                              verbose,
+                              exactExp,
+                              solver,
+                              ridge,
+                              weightCutoff,
+                              weightFraction );
+    }
+    else if ( dataFrame.size() ) {
+        DataFrame< double > dataFrame_ = DFToDataFrame( dataFrame );
+
+        SM = SMapMultiTarget( dataFrame_,
+                              lib,
+                              pred,
+                              E, 
+                              Tp,
+                              knn,
+                              tau,
+                              theta,
+                              exlusionRadius,
+                              columns, 
+                              target,
+                              embedded,
+                              const_predict,
+                              verbose,
+                              exactExp,
+                              solver,
+                              ridge,
+                              weightCutoff,
+                              weightFraction );
+    }
+    else {
+        Rcpp::warning( "SMapMultiTarget_rcpp(): Invalid input.\n" );
+    }
+
+    r::List output;
+    for ( size_t t = 0; t < SM.values.size(); t++ ) {
+        r::DataFrame df_pred = DataFrameToDF( SM.values[ t ].predictions  );
+        r::DataFrame df_coef = DataFrameToDF( SM.values[ t ].coefficients );
+        r::List targetOutput =
+            r::List::create( r::Named("predictions")  = df_pred,
+                             r::Named("coefficients") = df_coef );
+
+        if ( SM.values[ t ].truncation.NRows() ) {
+            targetOutput.push_back( DataFrameToDF( SM.values[ t ].truncation ),
+                                    "truncation" );
+        }
+        output.push_back( targetOutput, SM.targets[ t ] );
+    }
+
+    return output;
+}
+
+//----------------------------------------------------------
+// SMap ridge regularization path: list of SMap_rcpp() lists
+// named by ridge lambda
+//----------------------------------------------------------
+r::List SMapRidgePath_rcpp( std::string  pathIn, 
+                            std::string  dataFile,
+                            r::DataFrame dataFrame,
+                            std::string  lib,
+                            std::string  pred, 
+                            int          E,
+                            int          Tp,
+                            int          knn,
+                            int          tau,
+                            double       theta,
+                            int          exlusionRadius,
+                            std::string  columns,
+                            std::string  target,
+                            std::string  ridgePath,
+                            bool         embedded,
+                            bool         const_predict,
+                            bool         verbose,
+                            bool         exactExp,
+                            double       weightCutoff,
+                            double       weightFraction,
+                            unsigned     nThreads ) {
+
+    SMapRidgePathValues SM;
+
+    if ( dataFile.size() ) {
+        // dataFile specified, dispatch overloaded SMap, ignore dataFrame
+
+        SM = SMapRidgePath( pathIn,
+                            dataFile,
+                            lib,
+                            pred,
+                            E, 
+                            Tp,
+                            knn,
+                            tau,
+                            theta,
+                            exlusionRadius,
+                            columns, 
+                            target,
+                            ridgePath,
+                            embedded,
+                            const_predict,
+                            verbose,
+                            exactExp,
+                            weightCutoff,
+                            weightFraction,
+                            nThreads );
+    }
+    else if ( dataFrame.size() ) {
+        DataFrame< double > dataFrame_ = DFToDataFrame( dataFrame );
+
+        SM = SMapRidgePath( dataFrame_,
+                            lib,
+                            pred,
+                            E, 
+                            Tp,
+                            knn,
+                            tau,
+                            theta,
+                            exlusionRadius,
+                            columns, 
+                            target,
+                            ridgePath,
+                            embedded,
+                            const_predict,
+                            verbose,
+                            exactExp,
+                            weightCutoff,
+                            weightFraction,
+                            nThreads );
+    }
+    else {
+        Rcpp::warning( "SMapRidgePath_rcpp(): Invalid input.\n" );
+    }
+
+    r::List output;
+    for ( size_t l = 0; l < SM.values.size(); l++ ) {
+        r::DataFrame df_pred = DataFrameToDF( SM.values[ l ].predictions  );
+        r::DataFrame df_coef = DataFrameToDF( SM.values[ l ].coefficients );
+        r::List ridgeOutput =
+            r::List::create( r::Named("predictions")  = df_pred,
+                             r::Named("coefficients") = df_coef );
+
+        if ( SM.values[ l ].truncation.NRows() ) {
+            ridgeOutput.push_back( DataFrameToDF( SM.values[ l ].truncation ),
+                                   "truncation" );
+        }
+
+        std::stringstream ridgeName;
+        ridgeName << SM.ridge[ l ];
+        output.push_back( ridgeOutput, ridgeName.str() );
+    }
+
     return output;
 }
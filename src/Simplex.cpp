@@ -20,7 +20,14 @@ r::DataFrame Simplex_rcpp( std::string  pathIn,
                            std::string  target,
                            bool         embedded,
                            bool         const_predict,
-                           bool         verbose ) {
+                           bool         verbose,
+                           bool         exactExp,
+                           bool         singlePrecision,
+                           bool         partialDistance,
+                           std::string  metric,
+                           std::string  metricScales,
+                           int          approxTrees,
+                           int          recallSample ) {
 
     DataFrame< double > S;
     
@@ -41,7 +48,14 @@ r::DataFrame Simplex_rcpp( std::string  pathIn,
                      target, 
                      embedded,
                      const_predict,
-                     verbose );
+                     verbose,
+                     exactExp,
+                     singlePrecision,
+                     partialDistance,
+                     metric,
+                     metricScales,
+                     approxTrees,
+                     recallSample );
     }
     else if ( dataFrame.size() ) {
         DataFrame< double > dataFrame_ = DFToDataFrame( dataFrame );
@@ -60,7 +74,14 @@ r::DataFrame Simplex_rcpp( std::string  pathIn,
                      target, 
                      embedded,
                      const_predict,
-                     verbose );
+                     verbose,
+                     exactExp,
+                     singlePrecision,
+                     partialDistance,
+                     metric,
+                     metricScales,
+                     approxTrees,
+                     recallSample );
     }
     else {
         Rcpp::warning( "Simplex_rcpp(): Invalid input.\n" );
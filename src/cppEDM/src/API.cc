@@ -42,10 +42,10 @@ DataFrame< double > Embed( DataFrame< double > & dataFrameIn,
     // Instantiate EDM object
     EDM EDM_Embed = EDM( dataFrameIn, std::ref( parameters ) );
 
-    // Perform embedding : calls MakeBlock() API function
+    // Perform embedding : EmbeddingView of the columns
     EDM_Embed.EmbedData();
 
-    return EDM_Embed.embedding;
+    return EDM_Embed.embedding.Materialize();
 }
 
 //------------------------------------------------------------------------
@@ -147,7 +147,14 @@ DataFrame< double > Simplex( std::string pathIn,
                              std::string targetName,
                              bool        embedded,
                              bool        const_predict,
-                             bool        verbose )
+                             bool        verbose,
+                             bool        exactExp,
+                             bool        singlePrecision,
+                             bool        partialDistance,
+                             std::string metric,
+                             std::string metricScales,
+                             int         approxTrees,
+                             int         recallSample )
 {
     // DataFrame constructor loads data
     DataFrame< double > DF( pathIn, dataFile );
@@ -167,13 +174,22 @@ DataFrame< double > Simplex( std::string pathIn,
                                                      targetName,
                                                      embedded,
                                                      const_predict,
-                                                     verbose );
+                                                     verbose,
+                                                     exactExp,
+                                                     singlePrecision,
+                                                     partialDistance,
+                                                     metric,
+                                                     metricScales,
+                                                     approxTrees,
+                                                     recallSample );
 
     return simplexProjection;
 }
 
 //----------------------------------------------------------------------
 // Simplex with DataFrame input
+// targetName may list several targets: see ProjectMultiTarget().
+// The first target is validated by Parameters.
 //----------------------------------------------------------------------
 DataFrame<double> Simplex( DataFrame< double > & DF,
                            std::string pathOut,
@@ -189,20 +205,72 @@ DataFrame<double> Simplex( DataFrame< double > & DF,
                            std::string targetName,
                            bool        embedded,
                            bool        const_predict,
-                           bool        verbose )
+                           bool        verbose,
+                           bool        exactExp,
+                           bool        singlePrecision,
+                           bool        partialDistance,
+                           std::string metric,
+                           std::string metricScales,
+                           int         approxTrees,
+                           int         recallSample )
 {
+    std::vector< std::string > targetNames =
+        SplitString( targetName, " \t," );
+
     // Instantiate Parameters
-    Parameters parameters = Parameters( Method::Simplex, "", "",
-                                        pathOut, predictFile,
-                                        lib, pred, E, Tp, knn, tau, 0,
-                                        exclusionRadius,
-                                        colNames, targetName, embedded,
-                                        const_predict, verbose );
+    Parameters parameters = Parameters( Method::Simplex,
+                                        "",              // pathIn
+                                        "",              // dataFile
+                                        pathOut,         //
+                                        predictFile,     //
+                                        lib,             // lib_str
+                                        pred,            // pred_str
+                                        E,               //
+                                        Tp,              //
+                                        knn,             //
+                                        tau,             //
+                                        0,               // theta
+                                        exclusionRadius, //
+                                        colNames,        //
+                                        targetNames.size() > 1 ? // target
+                                        targetNames[0] : targetName,
+                                        embedded,        //
+                                        const_predict,   //
+                                        verbose,         //
+                                        "",              // SmapFile
+                                        "",              // blockFile
+                                        0,               // multiviewEnsemble
+                                        0,               // multiviewD
+                                        true,            // multiviewTrainLib
+                                        false,           // multiviewExcludeTarg
+                                        "",              // libSizes_str
+                                        0,               // subSamples
+                                        true,            // randomLib
+                                        false,           // replacement
+                                        0,               // seed
+                                        false,           // includeData
+                                        exactExp,        //
+                                        "SVD",           // solver_str
+                                        0,               // ridge
+                                        0,               // weightCutoff
+                                        1,               // weightFraction
+                                        1,               // nThreads
+                                        singlePrecision, //
+                                        partialDistance, //
+                                        metric,          // metric_str
+                                        metricScales,    // metricScales_str
+                                        approxTrees,     //
+                                        recallSample );  //
     
     // Instantiate EDM::SimplexClass object
     SimplexClass SimplexModel = SimplexClass( DF, std::ref( parameters ) );
 
-    SimplexModel.Project();
+    if ( targetNames.size() > 1 ) {
+        SimplexModel.ProjectMultiTarget( targetNames );
+    }
+    else {
+        SimplexModel.Project();
+    }
 
     return SimplexModel.projection;
 }
@@ -229,7 +297,19 @@ SMapValues SMap( std::string pathIn,
                  std::string derivatives,
                  bool        embedded,
                  bool        const_predict,
-                 bool        verbose )
+                 bool        verbose,
+                 bool        exactExp,
+                 std::string solverName,
+                 double      ridge,
+                 double      weightCutoff,
+                 double      weightFraction,
+                 unsigned    nThreads,
+                 bool        singlePrecision,
+                 bool        partialDistance,
+                 std::string metric,
+                 std::string metricScales,
+                 int         approxTrees,
+                 int         recallSample )
 {
     // DataFrame constructor loads data
     DataFrame< double > DF( pathIn, dataFile );
@@ -239,7 +319,12 @@ SMapValues SMap( std::string pathIn,
                                   lib, pred, E, Tp, knn, tau, theta,
                                   exclusionRadius,
                                   columns, target, smapFile, derivatives, 
-                                  embedded, const_predict, verbose );
+                                  embedded, const_predict, verbose,
+                                  exactExp, solverName, ridge,
+                                  weightCutoff, weightFraction, nThreads,
+                                  singlePrecision, partialDistance,
+                                  metric, metricScales,
+                                  approxTrees, recallSample );
     return SMapOutput;
 }
 
@@ -264,7 +349,19 @@ SMapValues SMap( DataFrame< double > & DF,
                  std::string derivatives,
                  bool        embedded,
                  bool        const_predict,
-                 bool        verbose )
+                 bool        verbose,
+                 bool        exactExp,
+                 std::string solverName,
+                 double      ridge,
+                 double      weightCutoff,
+                 double      weightFraction,
+                 unsigned    nThreads,
+                 bool        singlePrecision,
+                 bool        partialDistance,
+                 std::string metric,
+                 std::string metricScales,
+                 int         approxTrees,
+                 int         recallSample )
 {
     // Call overload 4) with default SVD function
     SMapValues SMapOutput = SMap( DF, pathOut, predictFile,
@@ -272,7 +369,12 @@ SMapValues SMap( DataFrame< double > & DF,
                                   exclusionRadius,
                                   columns, target, smapFile, derivatives,
                                   & SVD, // LAPACK SVD default
-                                  embedded, const_predict, verbose);
+                                  embedded, const_predict, verbose,
+                                  exactExp, solverName, ridge,
+                                  weightCutoff, weightFraction, nThreads,
+                                  singlePrecision, partialDistance,
+                                  metric, metricScales,
+                                  approxTrees, recallSample );
 
     return SMapOutput;
 }
@@ -300,7 +402,19 @@ SMapValues SMap( std::string pathIn,
                                                std::valarray < double >),
                  bool        embedded,
                  bool        const_predict,
-                 bool        verbose )
+                 bool        verbose,
+                 bool        exactExp,
+                 std::string solverName,
+                 double      ridge,
+                 double      weightCutoff,
+                 double      weightFraction,
+                 unsigned    nThreads,
+                 bool        singlePrecision,
+                 bool        partialDistance,
+                 std::string metric,
+                 std::string metricScales,
+                 int         approxTrees,
+                 int         recallSample )
 {
     // DataFrame constructor loads data
     DataFrame< double > DF( pathIn, dataFile );
@@ -310,7 +424,12 @@ SMapValues SMap( std::string pathIn,
                                   lib, pred, E, Tp, knn, tau, theta,
                                   exclusionRadius,
                                   columns, target, smapFile, derivatives, 
-                                  solver, embedded, const_predict, verbose );
+                                  solver, embedded, const_predict, verbose,
+                                  exactExp, solverName, ridge,
+                                  weightCutoff, weightFraction, nThreads,
+                                  singlePrecision, partialDistance,
+                                  metric, metricScales,
+                                  approxTrees, recallSample );
     return SMapOutput;
 }
 
@@ -336,17 +455,64 @@ SMapValues SMap( DataFrame< double > & DF,
                                                std::valarray < double >),
                  bool        embedded,
                  bool        const_predict,
-                 bool        verbose )
+                 bool        verbose,
+                 bool        exactExp,
+                 std::string solverName,
+                 double      ridge,
+                 double      weightCutoff,
+                 double      weightFraction,
+                 unsigned    nThreads,
+                 bool        singlePrecision,
+                 bool        partialDistance,
+                 std::string metric,
+                 std::string metricScales,
+                 int         approxTrees,
+                 int         recallSample )
 {
     if ( derivatives.size() ) {} // -Wunused-parameter
     
-    Parameters parameters = Parameters( Method::SMap, "", "",
-                                        pathOut, predictFile,
-                                        lib, pred, E, Tp, knn, tau, theta,
-                                        exclusionRadius,
-                                        columns, target, embedded,
-                                        const_predict, verbose,
-                                        smapFile );
+    Parameters parameters = Parameters( Method::SMap,
+                                        "",              // pathIn
+                                        "",              // dataFile
+                                        pathOut,         //
+                                        predictFile,     //
+                                        lib,             // lib_str
+                                        pred,            // pred_str
+                                        E,               //
+                                        Tp,              //
+                                        knn,             //
+                                        tau,             //
+                                        theta,           //
+                                        exclusionRadius, //
+                                        columns,         //
+                                        target,          //
+                                        embedded,        //
+                                        const_predict,   //
+                                        verbose,         //
+                                        smapFile,        // SmapFile
+                                        "",              // blockFile
+                                        0,               // multiviewEnsemble
+                                        0,               // multiviewD
+                                        true,            // multiviewTrainLib
+                                        false,           // multiviewExcludeTarg
+                                        "",              // libSizes_str
+                                        0,               // subSamples
+                                        true,            // randomLib
+                                        false,           // replacement
+                                        0,               // seed
+                                        false,           // includeData
+                                        exactExp,        //
+                                        solverName,      // solver_str
+                                        ridge,           //
+                                        weightCutoff,    //
+                                        weightFraction,  //
+                                        nThreads,        //
+                                        singlePrecision, //
+                                        partialDistance, //
+                                        metric,          // metric_str
+                                        metricScales,    // metricScales_str
+                                        approxTrees,     //
+                                        recallSample );  //
     
     // Instantiate EDM::SMapClass object
     SMapClass SMapModel = SMapClass( DF, std::ref( parameters ) );
@@ -356,10 +522,248 @@ SMapValues SMap( DataFrame< double > & DF,
     SMapValues values = SMapValues();
     values.predictions  = SMapModel.projection;
     values.coefficients = SMapModel.coefficients;
+    values.truncation   = SMapModel.truncation;
 
     return values;    
 }
 
+//----------------------------------------------------------------------------
+// SMapMultiTarget with path/file input
+//----------------------------------------------------------------------------
+SMapMultiTargetValues SMapMultiTarget( std::string pathIn,
+                                       std::string dataFile,
+                                       std::string lib,
+                                       std::string pred,
+                                       int         E,
+                                       int         Tp,
+                                       int         knn,
+                                       int         tau,
+                                       double      theta,
+                                       int         exclusionRadius,
+                                       std::string columns,
+                                       std::string target,
+                                       bool        embedded,
+                                       bool        const_predict,
+                                       bool        verbose,
+                                       bool        exactExp,
+                                       std::string solverName,
+                                       double      ridge,
+                                       double      weightCutoff,
+                                       double      weightFraction )
+{
+    // DataFrame constructor loads data
+    DataFrame< double > DF( pathIn, dataFile );
+
+    SMapMultiTargetValues values =
+        SMapMultiTarget( std::ref( DF ), lib, pred, E, Tp, knn, tau, theta,
+                         exclusionRadius, columns, target, embedded,
+                         const_predict, verbose, exactExp, solverName, ridge,
+                         weightCutoff, weightFraction );
+    return values;
+}
+
+//----------------------------------------------------------------------------
+// SMapMultiTarget with DataFrame
+// The first target is validated by Parameters, all targets are
+// read in SMapClass::ProjectMultiTarget()
+//----------------------------------------------------------------------------
+SMapMultiTargetValues SMapMultiTarget( DataFrame< double > & DF,
+                                       std::string lib,
+                                       std::string pred,
+                                       int         E,
+                                       int         Tp,
+                                       int         knn,
+                                       int         tau,
+                                       double      theta,
+                                       int         exclusionRadius,
+                                       std::string columns,
+                                       std::string target,
+                                       bool        embedded,
+                                       bool        const_predict,
+                                       bool        verbose,
+                                       bool        exactExp,
+                                       std::string solverName,
+                                       double      ridge,
+                                       double      weightCutoff,
+                                       double      weightFraction )
+{
+    std::vector< std::string > targetNames = SplitString( target, " \t," );
+
+    if ( targetNames.empty() ) {
+        throw std::runtime_error( "SMapMultiTarget(): no target.\n" );
+    }
+
+    Parameters parameters = Parameters( Method::SMap,
+                                        "",              // pathIn
+                                        "",              // dataFile
+                                        "",              // pathOut
+                                        "",              // predictFile
+                                        lib,             // lib_str
+                                        pred,            // pred_str
+                                        E,               //
+                                        Tp,              //
+                                        knn,             //
+                                        tau,             //
+                                        theta,           //
+                                        exclusionRadius, //
+                                        columns,         //
+                                        targetNames[0],  // target
+                                        embedded,        //
+                                        const_predict,   //
+                                        verbose,         //
+                                        "",              // SmapFile
+                                        "",              // blockFile
+                                        0,               // multiviewEnsemble
+                                        0,               // multiviewD
+                                        true,            // multiviewTrainLib
+                                        false,           // multiviewExcludeTarg
+                                        "",              // libSizes_str
+                                        0,               // subSamples
+                                        true,            // randomLib
+                                        false,           // replacement
+                                        0,               // seed
+                                        false,           // includeData
+                                        exactExp,        //
+                                        solverName,      // solver_str
+                                        ridge,           //
+                                        weightCutoff,    //
+                                        weightFraction ); //
+
+    // Instantiate EDM::SMapClass object
+    SMapClass SMapModel = SMapClass( DF, std::ref( parameters ) );
+
+    SMapModel.ProjectMultiTarget( & SVD, targetNames );
+
+    SMapMultiTargetValues values = SMapMultiTargetValues();
+    values.targets = targetNames;
+    values.values  = SMapModel.multiValues;
+
+    return values;
+}
+
+//----------------------------------------------------------------------------
+// SMapRidgePath with path/file input
+//----------------------------------------------------------------------------
+SMapRidgePathValues SMapRidgePath( std::string pathIn,
+                                   std::string dataFile,
+                                   std::string lib,
+                                   std::string pred,
+                                   int         E,
+                                   int         Tp,
+                                   int         knn,
+                                   int         tau,
+                                   double      theta,
+                                   int         exclusionRadius,
+                                   std::string columns,
+                                   std::string target,
+                                   std::string ridgePath,
+                                   bool        embedded,
+                                   bool        const_predict,
+                                   bool        verbose,
+                                   bool        exactExp,
+                                   double      weightCutoff,
+                                   double      weightFraction,
+                                   unsigned    nThreads )
+{
+    // DataFrame constructor loads data
+    DataFrame< double > DF( pathIn, dataFile );
+
+    SMapRidgePathValues values =
+        SMapRidgePath( std::ref( DF ), lib, pred, E, Tp, knn, tau, theta,
+                       exclusionRadius, columns, target, ridgePath, embedded,
+                       const_predict, verbose, exactExp,
+                       weightCutoff, weightFraction, nThreads );
+    return values;
+}
+
+//----------------------------------------------------------------------------
+// SMapRidgePath with DataFrame
+//----------------------------------------------------------------------------
+SMapRidgePathValues SMapRidgePath( DataFrame< double > & DF,
+                                   std::string lib,
+                                   std::string pred,
+                                   int         E,
+                                   int         Tp,
+                                   int         knn,
+                                   int         tau,
+                                   double      theta,
+                                   int         exclusionRadius,
+                                   std::string columns,
+                                   std::string target,
+                                   std::string ridgePath,
+                                   bool        embedded,
+                                   bool        const_predict,
+                                   bool        verbose,
+                                   bool        exactExp,
+                                   double      weightCutoff,
+                                   double      weightFraction,
+                                   unsigned    nThreads )
+{
+    std::vector< double > ridgeValues;
+
+    std::vector< std::string > ridge_vec = SplitString( ridgePath, " \t,\n" );
+
+    try {
+        for ( auto ci = ridge_vec.begin(); ci != ridge_vec.end(); ++ci ) {
+            ridgeValues.push_back( std::stod( *ci ) );
+        }
+    }
+    catch ( const std::invalid_argument &ia ) {
+        std::stringstream errMsg;
+        errMsg << "SMapRidgePath(): Unable to convert ridgePath ["
+               << ia.what() << "] to numeric.";
+        throw std::runtime_error( errMsg.str() );
+    }
+
+    Parameters parameters = Parameters( Method::SMap,
+                                        "",              // pathIn
+                                        "",              // dataFile
+                                        "",              // pathOut
+                                        "",              // predictFile
+                                        lib,             // lib_str
+                                        pred,            // pred_str
+                                        E,               //
+                                        Tp,              //
+                                        knn,             //
+                                        tau,             //
+                                        theta,           //
+                                        exclusionRadius, //
+                                        columns,         //
+                                        target,          //
+                                        embedded,        //
+                                        const_predict,   //
+                                        verbose,         //
+                                        "",              // SmapFile
+                                        "",              // blockFile
+                                        0,               // multiviewEnsemble
+                                        0,               // multiviewD
+                                        true,            // multiviewTrainLib
+                                        false,           // multiviewExcludeTarg
+                                        "",              // libSizes_str
+                                        0,               // subSamples
+                                        true,            // randomLib
+                                        false,           // replacement
+                                        0,               // seed
+                                        false,           // includeData
+                                        exactExp,        //
+                                        "SVD",           // solver_str
+                                        0,               // ridge
+                                        weightCutoff,    //
+                                        weightFraction,  //
+                                        nThreads );      //
+
+    // Instantiate EDM::SMapClass object
+    SMapClass SMapModel = SMapClass( DF, std::ref( parameters ) );
+
+    SMapModel.ProjectRidgePath( & SVD, ridgeValues );
+
+    SMapRidgePathValues values = SMapRidgePathValues();
+    values.ridge  = ridgeValues;
+    values.values = SMapModel.multiValues;
+
+    return values;
+}
+
 //----------------------------------------------------------------------
 // CCM with path/file input
 //----------------------------------------------------------------------
@@ -380,7 +784,10 @@ CCMValues CCM( std::string pathIn,
                bool        replacement,
                unsigned    seed,
                bool        includeData,
-               bool        verbose )
+               bool        verbose,
+               bool        singlePrecision,
+               std::string metric,
+               std::string metricScales )
 {
     // DataFrame constructor loads data
     DataFrame< double > DF( pathIn, dataFile );
@@ -389,7 +796,8 @@ CCMValues CCM( std::string pathIn,
                                E, Tp, knn, tau, exclusionRadius,
                                colNames, targetName, libSizes_str,
                                sample, random, replacement,
-                               seed, includeData, verbose );
+                               seed, includeData, verbose,
+                               singlePrecision, metric, metricScales );
 
     return ccmValues;
 }
@@ -413,7 +821,10 @@ CCMValues CCM( DataFrame< double > & DF,
                bool        replacement,
                unsigned    seed,
                bool        includeData,
-               bool        verbose )
+               bool        verbose,
+               bool        singlePrecision,
+               std::string metric,
+               std::string metricScales )
 {
     // Set library and prediction indices to entire library (embedded)
     std::stringstream ss;
@@ -448,7 +859,17 @@ CCMValues CCM( DataFrame< double > & DF,
                                         random,          // 
                                         replacement,     // 
                                         seed,            //
-                                        includeData );   //
+                                        includeData,     //
+                                        false,           // exactExp
+                                        "SVD",           // solver_str
+                                        0,               // ridge
+                                        0,               // weightCutoff
+                                        1,               // weightFraction
+                                        1,               // nThreads
+                                        singlePrecision, //
+                                        false,           // partialDistance
+                                        metric,          // metric_str
+                                        metricScales );  // metricScales_str
 
     // Instantiate EDM::Simplex::CCM object
     CCMClass CCMModel = CCMClass( DF, std::ref( parameters ) );
@@ -7,6 +7,8 @@
 #include "SMap.h"
 #include "CCM.h"
 #include "Multiview.h"
+#include "EDMModel.h"
+#include "EDMStream.h"
 
 //-------------------------------------------------------------
 // API function declarations.
@@ -38,6 +40,10 @@ DataFrame< double > MakeBlock( DataFrame< double >      & dataFrame,
                                int                      tau,
                                std::vector<std::string> columnNames );
 
+// Simplex of several targets: targetName a space separated list of
+// names or indices. Targets share the neighbors and weights of each
+// prediction row; the projection has the Observations, Predictions and
+// Pred_Variance columns of each target suffixed by the target name.
 DataFrame< double > Simplex( std::string pathIn          = "./data/",
                              std::string dataFile        = "",
                              std::string pathOut         = "./",
@@ -53,7 +59,14 @@ DataFrame< double > Simplex( std::string pathIn          = "./data/",
                              std::string targetName      = "",
                              bool        embedded        = false,
                              bool        const_predict   = false,
-                             bool        verbose         = true );
+                             bool        verbose         = true,
+                             bool        exactExp        = false,
+                             bool        singlePrecision = false,
+                             bool        partialDistance = false,
+                             std::string metric          = "Euclidean",
+                             std::string metricScales    = "",
+                             int         approxTrees     = 0,
+                             int         recallSample    = 0 );
 
 DataFrame< double > Simplex( DataFrame< double > & dataFrameIn,
                              std::string pathOut         = "./",
@@ -69,11 +82,31 @@ DataFrame< double > Simplex( DataFrame< double > & dataFrameIn,
                              std::string targetName      = "",
                              bool        embedded        = false,
                              bool        const_predict   = false,
-                             bool        verbose         = true );
+                             bool        verbose         = true,
+                             bool        exactExp        = false,
+                             bool        singlePrecision = false,
+                             bool        partialDistance = false,
+                             std::string metric          = "Euclidean",
+                             std::string metricScales    = "",
+                             int         approxTrees     = 0,
+                             int         recallSample    = 0 );
 
 // SMap is a special case since it can be called with a function pointer
 // to the SVD solver. This is done so that interfaces such as pybind11
 // can provide their own object for the solver.
+// nThreads > 1 solves the prediction rows in parallel, each thread
+// with its own solver workspace. External solvers use one thread.
+// singlePrecision = true (also Simplex, CCM) computes the embedding
+// distances in float; weights and solutions remain double.
+// partialDistance = true (also Simplex) finds the neighbors by a
+// partial distance search of the embedding, without distance matrix.
+// metric (also Simplex, CCM) is the neighbor distance: Euclidean,
+// SquaredEuclidean, Manhattan, Chebyshev or WeightedEuclidean with
+// metricScales a space separated scale of each embedding column.
+// approxTrees > 0 (also Simplex) finds approximate neighbors in a
+// forest of approxTrees random projection trees: more trees, more
+// accurate. recallSample > 0 prints the recall@knn and the change in
+// rho of the approximate neighbors on that many prediction rows.
 // 1) Data path/file with default SVD (LAPACK) assigned in Smap.cc 2)
 SMapValues SMap( std::string pathIn          = "./data/",
                  std::string dataFile        = "",
@@ -93,7 +126,19 @@ SMapValues SMap( std::string pathIn          = "./data/",
                  std::string derivatives     = "",
                  bool        embedded        = false,
                  bool        const_predict   = false,
-                 bool        verbose         = true );
+                 bool        verbose         = true,
+                 bool        exactExp        = false,
+                 std::string solverName      = "SVD",
+                 double      ridge           = 0,
+                 double      weightCutoff    = 0,
+                 double      weightFraction  = 1,
+                 unsigned    nThreads        = 1,
+                 bool        singlePrecision = false,
+                 bool        partialDistance = false,
+                 std::string metric          = "Euclidean",
+                 std::string metricScales    = "",
+                 int         approxTrees     = 0,
+                 int         recallSample    = 0 );
 
 // 2) DataFrame with default SVD (LAPACK) assigned in Smap.cc 2)
 SMapValues SMap( DataFrame< double > &dataFrameIn,
@@ -113,7 +158,19 @@ SMapValues SMap( DataFrame< double > &dataFrameIn,
                  std::string derivatives     = "",
                  bool        embedded        = false,
                  bool        const_predict   = false,
-                 bool        verbose         = true );
+                 bool        verbose         = true,
+                 bool        exactExp        = false,
+                 std::string solverName      = "SVD",
+                 double      ridge           = 0,
+                 double      weightCutoff    = 0,
+                 double      weightFraction  = 1,
+                 unsigned    nThreads        = 1,
+                 bool        singlePrecision = false,
+                 bool        partialDistance = false,
+                 std::string metric          = "Euclidean",
+                 std::string metricScales    = "",
+                 int         approxTrees     = 0,
+                 int         recallSample    = 0 );
 
 // 3) Data path/file with external solver object, init to default SVD
 SMapValues SMap( std::string pathIn          = "./data/",
@@ -137,7 +194,19 @@ SMapValues SMap( std::string pathIn          = "./data/",
                       std::valarray < double >) = & SVD,
                  bool        embedded        = false,
                  bool        const_predict   = false,
-                 bool        verbose         = true );
+                 bool        verbose         = true,
+                 bool        exactExp        = false,
+                 std::string solverName      = "SVD",
+                 double      ridge           = 0,
+                 double      weightCutoff    = 0,
+                 double      weightFraction  = 1,
+                 unsigned    nThreads        = 1,
+                 bool        singlePrecision = false,
+                 bool        partialDistance = false,
+                 std::string metric          = "Euclidean",
+                 std::string metricScales    = "",
+                 int         approxTrees     = 0,
+                 int         recallSample    = 0 );
 
 // 4) DataFrame with external solver object, init to default SVD
 SMapValues SMap( DataFrame< double > &dataFrameIn,
@@ -160,7 +229,113 @@ SMapValues SMap( DataFrame< double > &dataFrameIn,
                       std::valarray < double >) = & SVD,
                  bool        embedded        = false,
                  bool        const_predict   = false,
-                 bool        verbose         = true );
+                 bool        verbose         = true,
+                 bool        exactExp        = false,
+                 std::string solverName      = "SVD",
+                 double      ridge           = 0,
+                 double      weightCutoff    = 0,
+                 double      weightFraction  = 1,
+                 unsigned    nThreads        = 1,
+                 bool        singlePrecision = false,
+                 bool        partialDistance = false,
+                 std::string metric          = "Euclidean",
+                 std::string metricScales    = "",
+                 int         approxTrees     = 0,
+                 int         recallSample    = 0 );
+
+// SMap of several targets from the same columns embedding
+// Targets share the neighbors and one factorization per prediction
+// row. target is a space separated list of names or indices.
+// Output files are not written.
+SMapMultiTargetValues SMapMultiTarget(
+                 std::string pathIn          = "./data/",
+                 std::string dataFile        = "",
+                 std::string lib             = "",
+                 std::string pred            = "",
+                 int         E               = 0,
+                 int         Tp              = 1,
+                 int         knn             = 0,
+                 int         tau             = -1,
+                 double      theta           = 0,
+                 int         exclusionRadius = 0,
+                 std::string columns         = "",
+                 std::string target          = "",
+                 bool        embedded        = false,
+                 bool        const_predict   = false,
+                 bool        verbose         = true,
+                 bool        exactExp        = false,
+                 std::string solverName      = "SVD",
+                 double      ridge           = 0,
+                 double      weightCutoff    = 0,
+                 double      weightFraction  = 1 );
+
+SMapMultiTargetValues SMapMultiTarget(
+                 DataFrame< double > &dataFrameIn,
+                 std::string lib             = "",
+                 std::string pred            = "",
+                 int         E               = 0,
+                 int         Tp              = 1,
+                 int         knn             = 0,
+                 int         tau             = -1,
+                 double      theta           = 0,
+                 int         exclusionRadius = 0,
+                 std::string columns         = "",
+                 std::string target          = "",
+                 bool        embedded        = false,
+                 bool        const_predict   = false,
+                 bool        verbose         = true,
+                 bool        exactExp        = false,
+                 std::string solverName      = "SVD",
+                 double      ridge           = 0,
+                 double      weightCutoff    = 0,
+                 double      weightFraction  = 1 );
+
+// SMap ridge regularization path: SMap for each lambda in ridgePath,
+// a space separated list, from one SVD of each prediction row.
+// lambda is the ridge of the Cholesky solver. Output files are not
+// written.
+SMapRidgePathValues SMapRidgePath(
+                 std::string pathIn          = "./data/",
+                 std::string dataFile        = "",
+                 std::string lib             = "",
+                 std::string pred            = "",
+                 int         E               = 0,
+                 int         Tp              = 1,
+                 int         knn             = 0,
+                 int         tau             = -1,
+                 double      theta           = 0,
+                 int         exclusionRadius = 0,
+                 std::string columns         = "",
+                 std::string target          = "",
+                 std::string ridgePath       = "",
+                 bool        embedded        = false,
+                 bool        const_predict   = false,
+                 bool        verbose         = true,
+                 bool        exactExp        = false,
+                 double      weightCutoff    = 0,
+                 double      weightFraction  = 1,
+                 unsigned    nThreads        = 1 );
+
+SMapRidgePathValues SMapRidgePath(
+                 DataFrame< double > &dataFrameIn,
+                 std::string lib             = "",
+                 std::string pred            = "",
+                 int         E               = 0,
+                 int         Tp              = 1,
+                 int         knn             = 0,
+                 int         tau             = -1,
+                 double      theta           = 0,
+                 int         exclusionRadius = 0,
+                 std::string columns         = "",
+                 std::string target          = "",
+                 std::string ridgePath       = "",
+                 bool        embedded        = false,
+                 bool        const_predict   = false,
+                 bool        verbose         = true,
+                 bool        exactExp        = false,
+                 double      weightCutoff    = 0,
+                 double      weightFraction  = 1,
+                 unsigned    nThreads        = 1 );
 
 CCMValues CCM( std::string pathIn          = "./data/",
                std::string dataFile        = "",
@@ -179,7 +354,10 @@ CCMValues CCM( std::string pathIn          = "./data/",
                bool        replacement     = false,
                unsigned    seed            = 0,     // seed=0: use RNG
                bool        includeData     = false,
-               bool        verbose         = true );
+               bool        verbose         = true,
+               bool        singlePrecision = false,
+               std::string metric          = "Euclidean",
+               std::string metricScales    = "" );
 
 CCMValues CCM( DataFrame< double > & dataFrameIn,
                std::string pathOut         = "./",
@@ -197,7 +375,10 @@ CCMValues CCM( DataFrame< double > & dataFrameIn,
                bool        replacement     = false,
                unsigned    seed            = 0, // seed=0: use RNG
                bool        includeData     = false,
-               bool        verbose         = true );
+               bool        verbose         = true,
+               bool        singlePrecision = false,
+               std::string metric          = "Euclidean",
+               std::string metricScales    = "" );
 
 MultiviewValues Multiview( std::string pathIn          = "./",
                            std::string dataFile        = "",
@@ -311,7 +492,10 @@ DataFrame< double > PredictNonlinear( std::string pathIn      = "./data/",
                                       std::string targetName  = "",
                                       bool        embedded    = false,
                                       bool        verbose     = true,
-                                      unsigned    nThreads    = 4 );
+                                      unsigned    nThreads    = 4,
+                                      std::string solverName  = "SVD",
+                                      double      ridge       = 0,
+                                      std::string ridgePath   = "" );
 
 DataFrame< double > PredictNonlinear( DataFrame< double > & dataFrameIn,
                                       std::string pathOut     = "./",
@@ -327,5 +511,155 @@ DataFrame< double > PredictNonlinear( DataFrame< double > & dataFrameIn,
                                       std::string targetName  = "",
                                       bool        embedded    = false,
                                       bool        verbose     = true,
-                                      unsigned    nThreads    = 4 );
+                                      unsigned    nThreads    = 4,
+                                      std::string solverName  = "SVD",
+                                      double      ridge       = 0,
+                                      std::string ridgePath   = "" );
+
+// Panel of independent series with the same parameters (Panel.cc):
+// Simplex or SMap of each series, series in nThreads threads.
+// PanelSeries() splits a long format data frame into the series of
+// each value of seriesColumn. PanelValues are the outputs of all
+// series concatenated, with the series number (1-offset) in the
+// first column. Output files are not written.
+std::vector< DataFrame< double > > PanelSeries(
+    const DataFrame< double > & dataFrameIn,
+    std::string                 seriesColumn );
+
+PanelValues SimplexPanel( std::vector< DataFrame< double > > & panel,
+                          std::string lib             = "",
+                          std::string pred            = "",
+                          int         E               = 0,
+                          int         Tp              = 1,
+                          int         knn             = 0,
+                          int         tau             = -1,
+                          int         exclusionRadius = 0,
+                          std::string colNames        = "",
+                          std::string targetName      = "",
+                          bool        embedded        = false,
+                          bool        const_predict   = false,
+                          bool        verbose         = false,
+                          bool        exactExp        = false,
+                          bool        singlePrecision = false,
+                          std::string metric          = "Euclidean",
+                          std::string metricScales    = "",
+                          unsigned    nThreads        = 4 );
+
+PanelValues SMapPanel( std::vector< DataFrame< double > > & panel,
+                       std::string lib             = "",
+                       std::string pred            = "",
+                       int         E               = 0,
+                       int         Tp              = 1,
+                       int         knn             = 0,
+                       int         tau             = -1,
+                       double      theta           = 0,
+                       int         exclusionRadius = 0,
+                       std::string columns         = "",
+                       std::string target          = "",
+                       bool        embedded        = false,
+                       bool        const_predict   = false,
+                       bool        verbose         = false,
+                       bool        exactExp        = false,
+                       std::string solverName      = "SVD",
+                       double      ridge           = 0,
+                       bool        singlePrecision = false,
+                       std::string metric          = "Euclidean",
+                       std::string metricScales    = "",
+                       unsigned    nThreads        = 4 );
+
+// Blocked k-fold cross validation of Simplex (CrossValidation.cc):
+// the lib rows, one segment, are split into folds contiguous blocks
+// each predicted from the library outside the block widened by
+// foldBuffer rows. folds = 0 is leave-one-out. Each row's neighbors
+// are searched once; folds run in nThreads threads.
+CrossValidationValues CrossValidation(
+                       std::string pathIn          = "./data/",
+                       std::string dataFile        = "",
+                       std::string lib             = "",
+                       int         E               = 0,
+                       int         Tp              = 1,
+                       int         knn             = 0,
+                       int         tau             = -1,
+                       int         exclusionRadius = 0,
+                       std::string colNames        = "",
+                       std::string targetName      = "",
+                       int         folds           = 10,
+                       int         foldBuffer      = 0,
+                       bool        embedded        = false,
+                       bool        const_predict   = false,
+                       bool        verbose         = false,
+                       bool        exactExp        = false,
+                       bool        singlePrecision = false,
+                       std::string metric          = "Euclidean",
+                       std::string metricScales    = "",
+                       unsigned    nThreads        = 4 );
+
+CrossValidationValues CrossValidation(
+                       DataFrame< double > & dataFrameIn,
+                       std::string lib             = "",
+                       int         E               = 0,
+                       int         Tp              = 1,
+                       int         knn             = 0,
+                       int         tau             = -1,
+                       int         exclusionRadius = 0,
+                       std::string colNames        = "",
+                       std::string targetName      = "",
+                       int         folds           = 10,
+                       int         foldBuffer      = 0,
+                       bool        embedded        = false,
+                       bool        const_predict   = false,
+                       bool        verbose         = false,
+                       bool        exactExp        = false,
+                       bool        singlePrecision = false,
+                       std::string metric          = "Euclidean",
+                       std::string metricScales    = "",
+                       unsigned    nThreads        = 4 );
+
+// Rolling origin backtest of Simplex or SMap (Backtest.cc): lib is
+// the initial library "start end", origins every step rows from its
+// end are forecast Tp ahead from the library of targets observed at
+// the origin: expanding (window = 0) or the last window rows. The
+// data are embedded once, origins run in nThreads threads.
+BacktestValues Backtest( std::string pathIn          = "./data/",
+                         std::string dataFile        = "",
+                         std::string lib             = "",
+                         int         E               = 0,
+                         int         Tp              = 1,
+                         int         knn             = 0,
+                         int         tau             = -1,
+                         double      theta           = 0,
+                         int         exclusionRadius = 0,
+                         std::string colNames        = "",
+                         std::string targetName      = "",
+                         std::string method          = "Simplex",
+                         int         step            = 1,
+                         int         window          = 0,
+                         bool        embedded        = false,
+                         bool        verbose         = false,
+                         bool        exactExp        = false,
+                         bool        singlePrecision = false,
+                         std::string metric          = "Euclidean",
+                         std::string metricScales    = "",
+                         unsigned    nThreads        = 4 );
+
+BacktestValues Backtest( DataFrame< double > & dataFrameIn,
+                         std::string lib             = "",
+                         int         E               = 0,
+                         int         Tp              = 1,
+                         int         knn             = 0,
+                         int         tau             = -1,
+                         double      theta           = 0,
+                         int         exclusionRadius = 0,
+                         std::string colNames        = "",
+                         std::string targetName      = "",
+                         std::string method          = "Simplex",
+                         int         step            = 1,
+                         int         window          = 0,
+                         bool        embedded        = false,
+                         bool        verbose         = false,
+                         bool        exactExp        = false,
+                         bool        singlePrecision = false,
+                         std::string metric          = "Euclidean",
+                         std::string metricScales    = "",
+                         unsigned    nThreads        = 4 );
 #endif
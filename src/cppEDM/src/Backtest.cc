@@ -0,0 +1,321 @@
+
+#include "API.h"
+
+namespace {
+    //------------------------------------------------------------------
+    // Rolling origins of the prepared model: the prediction rows and
+    // the library range of each, embedding rows. The first origin is
+    // the last initial library row, libEnd (data row, 1-offset).
+    //------------------------------------------------------------------
+    void BacktestOrigins( EDM                   & model,
+                          int                     libEnd,
+                          int                     step,
+                          int                     window,
+                          bool                    knnAll,
+                          std::vector< size_t > & libFirst,
+                          std::vector< size_t > & libLast ) {
+
+        Parameters & P = model.parameters;
+
+        // Embedding rows are data rows less the partial data rows
+        // deleted at the start of the data if tau < 0
+        int shift = 0;
+        if ( not P.embedded and P.tau < 0 ) {
+            shift = abs( P.tau ) * ( P.E - 1 );
+        }
+
+        int first   = (int) P.library.front();
+        int last    = (int) model.embedding.NRows() - 1;
+        int origin0 = libEnd - 1 - shift;
+
+        if ( origin0 < first ) {
+            std::stringstream errMsg;
+            errMsg << "Backtest(): No initial library rows before row "
+                   << libEnd << " after the embedding partial data rows.\n";
+            throw std::runtime_error( errMsg.str() );
+        }
+
+        P.prediction.clear();
+        libFirst.clear();
+        libLast.clear();
+
+        // Origins with the target Tp ahead observed in the data
+        for ( int origin = origin0; origin + P.Tp <= last; origin += step ) {
+            int hi = origin - P.Tp;                  // target known
+            int lo = window ? std::max( first, hi - window + 1 ) : first;
+
+            // knn neighbors, less the leave-one-out row of Tp = 0
+            int nLib = hi - lo + 1 - ( P.Tp ? 0 : 1 );
+            if ( nLib < 1 or ( not knnAll and nLib < P.knn ) ) {
+                std::stringstream errMsg;
+                errMsg << "Backtest(): " << std::max( nLib, 0 )
+                       << " library rows at origin row "
+                       << origin + shift + 1 << " are fewer than knn "
+                       << P.knn << ".\n";
+                throw std::runtime_error( errMsg.str() );
+            }
+
+            P.prediction.push_back( origin );
+            libFirst.push_back( lo );
+            libLast.push_back ( hi );
+        }
+
+        if ( not P.prediction.size() ) {
+            std::stringstream errMsg;
+            errMsg << "Backtest(): No origin from row " << libEnd
+                   << " with the target Tp = " << P.Tp << " ahead in the "
+                   << "data.\n";
+            throw std::runtime_error( errMsg.str() );
+        }
+    }
+
+    //------------------------------------------------------------------
+    // One row per origin of the model predictions, and pooled skill
+    //------------------------------------------------------------------
+    BacktestValues BacktestOutput( EDM                         & model,
+                                   const std::vector< size_t > & libFirst,
+                                   const std::vector< size_t > & libLast ) {
+
+        const Parameters              & P           = model.parameters;
+        const std::valarray< double > & target      = model.target;
+        const std::valarray< double > & predictions = model.predictions;
+
+        size_t Norigin = P.prediction.size();
+
+        int shift = 0;
+        if ( not P.embedded and P.tau < 0 ) {
+            shift = abs( P.tau ) * ( P.E - 1 );
+        }
+
+        BacktestValues values = BacktestValues();
+        values.predictions = DataFrame< double >( Norigin, 5,
+            "Origin Library Observations Predictions Pred_Variance" );
+
+        std::valarray< double > observations( NAN, Norigin );
+
+        for ( size_t row = 0; row < Norigin; row++ ) {
+            int targetRow = (int) P.prediction[ row ] + P.Tp - model.embedShift;
+            if ( targetRow >= 0 and targetRow < (int) target.size() ) {
+                observations[ row ] = target[ targetRow ];
+            }
+            values.predictions( row, 0 ) = P.prediction[ row ] + shift + 1;
+            values.predictions( row, 1 ) = libLast[ row ] - libFirst[ row ] + 1;
+        }
+
+        values.predictions.WriteColumn( 2, observations   );
+        values.predictions.WriteColumn( 3, predictions    );
+        values.predictions.WriteColumn( 4, model.variance );
+
+        // Time of the forecast target of each origin
+        const std::vector< std::string > & time = model.allTime;
+        if ( time.size() ) {
+            std::vector< std::string > targetTime( Norigin );
+            for ( size_t row = 0; row < Norigin; row++ ) {
+                targetTime[ row ] = time[ P.prediction[ row ] + shift + P.Tp ];
+            }
+            values.predictions.Time()     = targetTime;
+            values.predictions.TimeName() = model.data.TimeName();
+        }
+
+        values.skill = ComputeError( observations, predictions );
+
+        return values;
+    }
+}
+
+//----------------------------------------------------------------------------
+// Backtest with path/file input
+//----------------------------------------------------------------------------
+BacktestValues Backtest( std::string pathIn,
+                         std::string dataFile,
+                         std::string lib,
+                         int         E,
+                         int         Tp,
+                         int         knn,
+                         int         tau,
+                         double      theta,
+                         int         exclusionRadius,
+                         std::string colNames,
+                         std::string targetName,
+                         std::string method,
+                         int         step,
+                         int         window,
+                         bool        embedded,
+                         bool        verbose,
+                         bool        exactExp,
+                         bool        singlePrecision,
+                         std::string metric,
+                         std::string metricScales,
+                         unsigned    nThreads )
+{
+    // DataFrame constructor loads data
+    DataFrame< double > DF( pathIn, dataFile );
+
+    BacktestValues values =
+        Backtest( std::ref( DF ), lib, E, Tp, knn, tau, theta,
+                  exclusionRadius, colNames, targetName, method, step,
+                  window, embedded, verbose, exactExp, singlePrecision,
+                  metric, metricScales, nThreads );
+    return values;
+}
+
+//----------------------------------------------------------------------------
+// Backtest with DataFrame
+// Rolling origin evaluation of Simplex or SMap: lib is the initial
+// library "start end". Origins are the data rows end, end + step, ...
+// with the target Tp ahead in the data; each is forecast from the
+// library rows with targets observed at the origin: all from start
+// (window = 0, expanding) or the last window rows (sliding).
+// The data are embedded once and the neighbors of all origins found
+// in one pass of EDM::OriginNeighbors(), origins in nThreads threads,
+// then predicted in one Simplex() or SMap().
+//----------------------------------------------------------------------------
+BacktestValues Backtest( DataFrame< double > & DF,
+                         std::string lib,
+                         int         E,
+                         int         Tp,
+                         int         knn,
+                         int         tau,
+                         double      theta,
+                         int         exclusionRadius,
+                         std::string colNames,
+                         std::string targetName,
+                         std::string method,
+                         int         step,
+                         int         window,
+                         bool        embedded,
+                         bool        verbose,
+                         bool        exactExp,
+                         bool        singlePrecision,
+                         std::string metric,
+                         std::string metricScales,
+                         unsigned    nThreads )
+{
+    if ( method != "Simplex" and method != "SMap" ) {
+        std::stringstream errMsg;
+        errMsg << "Backtest(): method " << method
+               << " must be Simplex or SMap.\n";
+        throw std::runtime_error( errMsg.str() );
+    }
+    if ( step < 1 or window < 0 ) {
+        std::stringstream errMsg;
+        errMsg << "Backtest(): step " << step << " must be >= 1, window "
+               << window << " >= 0.\n";
+        throw std::runtime_error( errMsg.str() );
+    }
+    if ( ( not embedded and tau > 0 ) or Tp < 0 ) {
+        std::stringstream errMsg;
+        errMsg << "Backtest(): tau " << tau << " Tp " << Tp
+               << ": backtesting requires tau < 0 or embedded, "
+               << "and Tp >= 0.\n";
+        throw std::runtime_error( errMsg.str() );
+    }
+
+    std::vector< std::string > lib_vec = SplitString( lib, " \t," );
+    if ( lib_vec.size() != 2 ) {
+        std::stringstream errMsg;
+        errMsg << "Backtest(): lib " << lib << " must be the start and "
+               << "end rows of the initial library.\n";
+        throw std::runtime_error( errMsg.str() );
+    }
+    int libStart = std::stoi( lib_vec[ 0 ] );
+    int libEnd   = std::stoi( lib_vec[ 1 ] );
+
+    if ( libStart < 1 or libEnd < libStart or libEnd > (int) DF.NRows() ) {
+        std::stringstream errMsg;
+        errMsg << "Backtest(): lib " << lib << " is not in the "
+               << DF.NRows() << " data rows.\n";
+        throw std::runtime_error( errMsg.str() );
+    }
+
+    // Embedding of the rows from the library start to the data end
+    std::stringstream rows;
+    rows << libStart << " " << DF.NRows();
+
+    bool smap = method == "SMap";
+
+    // Instantiate Parameters
+    Parameters parameters = Parameters( smap ? Method::SMap : Method::Simplex,
+                                        "",              // pathIn
+                                        "",              // dataFile
+                                        "",              // pathOut
+                                        "",              // predictFile
+                                        rows.str(),      // lib_str
+                                        rows.str(),      // pred_str
+                                        E,               //
+                                        Tp,              //
+                                        knn,             //
+                                        tau,             //
+                                        theta,           //
+                                        exclusionRadius, //
+                                        colNames,        //
+                                        targetName,      //
+                                        embedded,        //
+                                        false,           // const_predict
+                                        verbose,         //
+                                        "",              // SmapFile
+                                        "",              // blockFile
+                                        0,               // multiviewEnsemble
+                                        0,               // multiviewD
+                                        true,            // multiviewTrainLib
+                                        false,           // multiviewExcludeTarg
+                                        "",              // libSizes_str
+                                        0,               // subSamples
+                                        true,            // randomLib
+                                        false,           // replacement
+                                        0,               // seed
+                                        false,           // includeData
+                                        exactExp,        //
+                                        "SVD",           // solver_str
+                                        0,               // ridge
+                                        0,               // weightCutoff
+                                        1,               // weightFraction
+                                        nThreads,        //
+                                        singlePrecision, //
+                                        false,           // partialDistance
+                                        metric,          // metric_str
+                                        metricScales,    // metricScales_str
+                                        0,               // approxTrees
+                                        0 );             // recallSample
+
+    // SMap knn = 0: all library rows of each origin
+    bool knnAll = smap and knn == 0;
+
+    std::vector< size_t > libFirst;
+    std::vector< size_t > libLast;
+
+    BacktestValues values;
+
+    if ( smap ) {
+        // Instantiate EDM::SMapClass object
+        SMapClass SMapModel = SMapClass( DF, std::ref( parameters ) );
+
+        SMapModel.PrepareEmbedding();
+
+        BacktestOrigins( SMapModel, libEnd, step, window, knnAll,
+                         libFirst, libLast );
+
+        SMapModel.OriginNeighbors( libFirst, libLast );
+
+        SMapModel.SMap( & SVD );
+
+        values = BacktestOutput( SMapModel, libFirst, libLast );
+    }
+    else {
+        // Instantiate EDM::SimplexClass object
+        SimplexClass SimplexModel = SimplexClass( DF, std::ref( parameters ) );
+
+        SimplexModel.PrepareEmbedding();
+
+        BacktestOrigins( SimplexModel, libEnd, step, window, knnAll,
+                         libFirst, libLast );
+
+        SimplexModel.OriginNeighbors( libFirst, libLast );
+
+        SimplexModel.Simplex();
+
+        values = BacktestOutput( SimplexModel, libFirst, libLast );
+    }
+
+    return values;
+}
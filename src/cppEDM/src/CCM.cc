@@ -298,8 +298,14 @@ void CrossMap( SimplexClass   & S,
             Simplex_.allLibRows = 
                 S.allLibRows.DataFrameFromColumnIndex( lib_i );
             
-            Simplex_.allDistances =
-                S.allDistances.DataFrameFromColumnIndex( lib_i );            
+            if ( S.parameters.singlePrecision ) {
+                Simplex_.allDistancesFloat =
+                    S.allDistancesFloat.DataFrameFromColumnIndex( lib_i );
+            }
+            else {
+                Simplex_.allDistances =
+                    S.allDistances.DataFrameFromColumnIndex( lib_i );
+            }
 
             //----------------------------------------------------------
             // Cross mapping
@@ -12,6 +12,29 @@ bool DistanceCompare( const std::pair<double, size_t> & x,
     return x.first < y.first;
 }
 
+//---------------------------------------------------------------
+// Sort the < distance, libRow > pairs within the knn-th distance,
+// with its ties, for InsertNeighbors(); the pairs beyond are erased.
+// Only these are sorted: nth_element() selects the knn-th.
+//---------------------------------------------------------------
+void SortNearest( std::vector< std::pair<double, size_t> > & rowPair,
+                  size_t knn ) {
+
+    if ( rowPair.size() > knn and knn ) {
+        std::nth_element( rowPair.begin(), rowPair.begin() + knn - 1,
+                          rowPair.end(), DistanceCompare );
+        double knnDistance = rowPair[ knn - 1 ].first;
+
+        auto last = std::partition( rowPair.begin() + knn, rowPair.end(),
+            [knnDistance]( const std::pair< double, size_t > & pair ) {
+                return pair.first <= knnDistance;
+            } );
+        rowPair.erase( last, rowPair.end() );
+    }
+
+    std::sort( rowPair.begin(), rowPair.end(), DistanceCompare );
+}
+
 //----------------------------------------------------------------
 // 
 //----------------------------------------------------------------
@@ -131,8 +154,8 @@ std::vector<std::string> SplitString( std::string inString,
 //----------------------------------------------------------------
 // 
 //----------------------------------------------------------------
-VectorError ComputeError( std::valarray< double > obsIn,
-                          std::valarray< double > predIn ) {
+VectorError ComputeError( const std::valarray< double > & obsIn,
+                          const std::valarray< double > & predIn ) {
 
     if ( obsIn.size() != predIn.size() ) {
         std::stringstream errMsg;
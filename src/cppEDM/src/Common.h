@@ -17,7 +17,9 @@
 
 // Enumerations
 enum class Method         { None, Embed, Simplex, SMap, CCM };
-enum class DistanceMetric { Euclidean, Manhattan };
+enum class DistanceMetric { Euclidean, Manhattan, SquaredEuclidean,
+                            Chebyshev, WeightedEuclidean };
+enum class SMapSolver     { SVD, QR, Cholesky };
 
 #include "DataFrame.h"
 
@@ -30,9 +32,62 @@ struct VectorError {
     double MAE;
 };
 
+// Approximate neighbors of a sample of prediction rows against the
+// exact neighbors: recall@knn, and rho of the predictions of each
+struct RecallValues {
+    size_t rows;
+    double recall;
+    double rhoExact;
+    double rhoApprox;
+};
+
 struct SMapValues {
     DataFrame< double > predictions;
     DataFrame< double > coefficients;
+    DataFrame< double > truncation;   // weight truncation, empty if not set
+};
+
+// Return object for SMapRidgePath() : values[ i ] of ridge[ i ]
+struct SMapRidgePathValues {
+    std::vector< double >     ridge;
+    std::vector< SMapValues > values;
+};
+
+// Return object for SMapMultiTarget() : values[ i ] of targets[ i ]
+struct SMapMultiTargetValues {
+    std::vector< std::string > targets;
+    std::vector< SMapValues >  values;
+};
+
+// Return object for SimplexPanel() and SMapPanel() : the outputs of
+// all series, series number (1-offset) in the first column
+struct PanelValues {
+    DataFrame< double > predictions;
+    DataFrame< double > coefficients; // SMapPanel()
+};
+
+// Return object for CrossValidation() : the Simplex projection of the
+// library rows, skill of each fold (Fold Start End rho MAE RMSE) and
+// of all folds pooled
+struct CrossValidationValues {
+    DataFrame< double > predictions;
+    DataFrame< double > folds;
+    VectorError         pooled;
+};
+
+// Return object for Backtest() : one row of each forecast origin
+// (Origin Library Observations Predictions Pred_Variance) with the
+// time of the forecast, and skill of all origins
+struct BacktestValues {
+    DataFrame< double > predictions;
+    VectorError         skill;
+};
+
+// Return object for EDMModel::Neighbors() : knn columns of each
+// prediction row, neighbor data rows (1-offset) and distances
+struct NeighborValues {
+    DataFrame< double > neighbors;
+    DataFrame< double > distances;
 };
 
 // Return object for CrossMap() worker function
@@ -64,8 +119,13 @@ bool        OnlyDigits( std::string str, bool integerOnly );
 std::vector<std::string> SplitString( std::string inString, 
                                       std::string delimeters );
 
-VectorError ComputeError( std::valarray< double > obs,
-                          std::valarray< double > pred );
+VectorError ComputeError( const std::valarray< double > & obs,
+                          const std::valarray< double > & pred );
+
+bool DistanceCompare( const std::pair<double, size_t> & x,
+                      const std::pair<double, size_t> & y );
+void SortNearest( std::vector< std::pair<double, size_t> > & rowPair,
+                  size_t knn );
 
 std::string increment_datetime_str( std::string datetime1, 
                                     std::string datetime2,
@@ -0,0 +1,198 @@
+
+#include "API.h"
+
+//----------------------------------------------------------------------------
+// CrossValidation with path/file input
+//----------------------------------------------------------------------------
+CrossValidationValues CrossValidation( std::string pathIn,
+                                       std::string dataFile,
+                                       std::string lib,
+                                       int         E,
+                                       int         Tp,
+                                       int         knn,
+                                       int         tau,
+                                       int         exclusionRadius,
+                                       std::string colNames,
+                                       std::string targetName,
+                                       int         folds,
+                                       int         foldBuffer,
+                                       bool        embedded,
+                                       bool        const_predict,
+                                       bool        verbose,
+                                       bool        exactExp,
+                                       bool        singlePrecision,
+                                       std::string metric,
+                                       std::string metricScales,
+                                       unsigned    nThreads )
+{
+    // DataFrame constructor loads data
+    DataFrame< double > DF( pathIn, dataFile );
+
+    CrossValidationValues values =
+        CrossValidation( std::ref( DF ), lib, E, Tp, knn, tau,
+                         exclusionRadius, colNames, targetName, folds,
+                         foldBuffer, embedded, const_predict, verbose,
+                         exactExp, singlePrecision, metric, metricScales,
+                         nThreads );
+    return values;
+}
+
+//----------------------------------------------------------------------------
+// CrossValidation with DataFrame
+// Simplex of the lib rows in blocked folds: the library rows are the
+// prediction rows, split into folds contiguous blocks of rows. Each
+// row is predicted from the library rows outside its fold block
+// widened by foldBuffer rows. folds = 0 is leave-one-out, one row
+// per fold. The neighbors of all folds are found in one pass of
+// EDM::FoldNeighbors() with the folds in nThreads threads, and
+// predicted in one Simplex().
+//----------------------------------------------------------------------------
+CrossValidationValues CrossValidation( DataFrame< double > & DF,
+                                       std::string lib,
+                                       int         E,
+                                       int         Tp,
+                                       int         knn,
+                                       int         tau,
+                                       int         exclusionRadius,
+                                       std::string colNames,
+                                       std::string targetName,
+                                       int         folds,
+                                       int         foldBuffer,
+                                       bool        embedded,
+                                       bool        const_predict,
+                                       bool        verbose,
+                                       bool        exactExp,
+                                       bool        singlePrecision,
+                                       std::string metric,
+                                       std::string metricScales,
+                                       unsigned    nThreads )
+{
+    if ( folds < 0 or foldBuffer < 0 ) {
+        std::stringstream errMsg;
+        errMsg << "CrossValidation(): folds " << folds << " foldBuffer "
+               << foldBuffer << " must be >= 0.\n";
+        throw std::runtime_error( errMsg.str() );
+    }
+
+    // Instantiate Parameters: the library rows are the prediction rows
+    Parameters parameters = Parameters( Method::Simplex,
+                                        "",              // pathIn
+                                        "",              // dataFile
+                                        "",              // pathOut
+                                        "",              // predictFile
+                                        lib,             // lib_str
+                                        lib,             // pred_str
+                                        E,               //
+                                        Tp,              //
+                                        knn,             //
+                                        tau,             //
+                                        0,               // theta
+                                        exclusionRadius, //
+                                        colNames,        //
+                                        targetName,      //
+                                        embedded,        //
+                                        const_predict,   //
+                                        verbose,         //
+                                        "",              // SmapFile
+                                        "",              // blockFile
+                                        0,               // multiviewEnsemble
+                                        0,               // multiviewD
+                                        true,            // multiviewTrainLib
+                                        false,           // multiviewExcludeTarg
+                                        "",              // libSizes_str
+                                        0,               // subSamples
+                                        true,            // randomLib
+                                        false,           // replacement
+                                        0,               // seed
+                                        false,           // includeData
+                                        exactExp,        //
+                                        "SVD",           // solver_str
+                                        0,               // ridge
+                                        0,               // weightCutoff
+                                        1,               // weightFraction
+                                        nThreads,        //
+                                        singlePrecision, //
+                                        false,           // partialDistance
+                                        metric,          // metric_str
+                                        metricScales,    // metricScales_str
+                                        0,               // approxTrees
+                                        0 );             // recallSample
+
+    // Instantiate EDM::SimplexClass object
+    SimplexClass SimplexModel = SimplexClass( DF, std::ref( parameters ) );
+
+    SimplexModel.PrepareEmbedding();
+
+    const std::vector< size_t > & prediction = SimplexModel.parameters.prediction;
+
+    size_t Npred = prediction.size();
+
+    if ( prediction.back() - prediction.front() + 1 != Npred ) {
+        std::stringstream errMsg;
+        errMsg << "CrossValidation(): lib " << lib << " must be one "
+               << "contiguous segment of rows.\n";
+        throw std::runtime_error( errMsg.str() );
+    }
+
+    // Blocked folds of the prediction rows, sizes differ by at most 1
+    size_t Nfolds = ( folds == 0 or (size_t) folds > Npred ) ?
+                    Npred : (size_t) folds;
+
+    std::vector< size_t > foldStart( Nfolds + 1 );
+    for ( size_t f = 0; f <= Nfolds; f++ ) {
+        foldStart[ f ] = f * Npred / Nfolds;
+    }
+
+    SimplexModel.FoldNeighbors( foldStart, foldBuffer );
+
+    SimplexModel.Simplex();
+
+    SimplexModel.FormatOutput();
+
+    //------------------------------------------------------------------
+    // Skill of each fold and pooled: observations are the target Tp
+    // ahead of each prediction row, as the library targets of Simplex()
+    //------------------------------------------------------------------
+    const std::valarray< double > & target      = SimplexModel.target;
+    const std::valarray< double > & predictions = SimplexModel.predictions;
+
+    std::valarray< double > observations( NAN, Npred );
+    for ( size_t row = 0; row < Npred; row++ ) {
+        int targetRow = (int) prediction[ row ] + Tp - SimplexModel.embedShift;
+        if ( targetRow >= 0 and targetRow < (int) target.size() ) {
+            observations[ row ] = target[ targetRow ];
+        }
+    }
+
+    // Data rows (1-offset) of the embedding rows, as EDMModel::Neighbors()
+    size_t shift = 0;
+    if ( not embedded and SimplexModel.parameters.tau < 0 ) {
+        shift = abs( SimplexModel.parameters.tau ) *
+                ( SimplexModel.parameters.E - 1 );
+    }
+
+    CrossValidationValues values = CrossValidationValues();
+    values.predictions = SimplexModel.projection;
+    values.folds       = DataFrame< double >( Nfolds, 6,
+                                              "Fold Start End rho MAE RMSE" );
+
+    for ( size_t f = 0; f < Nfolds; f++ ) {
+        size_t first = foldStart[ f ];
+        size_t N     = foldStart[ f + 1 ] - first;
+
+        VectorError err = ComputeError(
+            observations[ std::slice( first, N, 1 ) ],
+            predictions [ std::slice( first, N, 1 ) ] );
+
+        values.folds( f, 0 ) = f + 1;
+        values.folds( f, 1 ) = prediction[ first         ] + shift + 1;
+        values.folds( f, 2 ) = prediction[ first + N - 1 ] + shift + 1;
+        values.folds( f, 3 ) = err.rho;
+        values.folds( f, 4 ) = err.MAE;
+        values.folds( f, 5 ) = err.RMSE;
+    }
+
+    values.pooled = ComputeError( observations, predictions );
+
+    return values;
+}
@@ -11,6 +11,7 @@
 #include <iomanip>
 #include <fstream>
 #include <iterator>
+#include <memory>
 
 // Common.cc
 extern std::vector<std::string> SplitString( std::string inString, 
@@ -20,10 +21,49 @@ extern bool OnlyDigits( std::string str, bool integerOnly );
 // Type definition for CSV NamedData to pair column names & column data
 typedef std::vector<std::pair<std::string, std::vector<double>>> NamedData;
 
+//----------------------------------------------------------------
+// DataFrameSpan class
+// Non-owning view of a DataFrame row or column: pointer, length and
+// stride into the row major elements, element i at data[ i * stride ].
+// A row has stride 1, a column stride NColumns(). No copy is made;
+// the span is valid while the DataFrame elements are not reassigned
+// and, for a non-const span, while the DataFrame is not copied.
+// T is const for views of a const DataFrame.
+//----------------------------------------------------------------
+template <class T>
+class DataFrameSpan {
+
+    T      *ptr;
+    size_t  length;
+    size_t  step;
+
+public:
+    DataFrameSpan( T *data, size_t size, size_t stride ):
+        ptr( data ), length( size ), step( stride ) {}
+
+    // A span of T converts to a span of const T
+    template <class U>
+    DataFrameSpan( const DataFrameSpan< U > & span ):
+        ptr( span.data() ), length( span.size() ), step( span.stride() ) {}
+
+    T &operator[]( size_t i ) const { return ptr[ i * step ]; }
+
+    T     *data()   const { return ptr;    }
+    size_t size()   const { return length; }
+    size_t stride() const { return step;   }
+};
+
 //----------------------------------------------------------------
 // DataFrame class
 // Data container is a single, contiguous valarray: elements.
 // NOTE: elements are Row Major format, ala C, C++, numpy
+// Copies of a DataFrame share one reference counted elements valarray
+// (copy-on-write): copying is O(1) and the elements are copied only
+// when a DataFrame whose elements are shared is modified through a
+// non-const element accessor, WriteRow(), WriteColumn() or
+// DeletePartialDataRows(). Const accessors never copy. Threads each
+// copy a shared DataFrame; threads writing disjoint rows of one
+// DataFrame object require that its elements are not shared.
 // DataFrame element access is through the () operator: (row,col).
 // The time column is not processed as data, but as strings.
 //----------------------------------------------------------------
@@ -32,7 +72,7 @@ class DataFrame {
 
     size_t           n_rows;
     size_t           n_columns;
-    std::valarray<T> elements;
+    std::shared_ptr< std::valarray<T> > elements; // copy-on-write
 
     std::vector< std::string >      columnNames;
     std::map< std::string, size_t > columnNameToIndex;
@@ -45,6 +85,25 @@ class DataFrame {
     bool   noTime;
     bool   partialDataRowsDeleted;
 
+    //-----------------------------------------------------------------
+    // Elements for modification: copy shared elements first
+    //-----------------------------------------------------------------
+    std::valarray<T> &MutableElements() {
+        if ( elements.use_count() > 1 ) {
+            elements = std::make_shared< std::valarray<T> >( *elements );
+        }
+        return *elements;
+    }
+
+    // Pointer to elements[ i ], nullptr if no elements
+    T *ElementPointer( size_t i ) {
+        std::valarray<T> &mutableElements = MutableElements();
+        return mutableElements.size() ? &mutableElements[ 0 ] + i : nullptr;
+    }
+    const T *ElementPointer( size_t i ) const {
+        return elements->size() ? &(*elements)[ 0 ] + i : nullptr;
+    }
+
 public:
     //-----------------------------------------------------------------
     // Destructor
@@ -55,7 +114,8 @@ public:
     // Constructors
     //-----------------------------------------------------------------
     DataFrame():
-        n_rows( 0 ), n_columns( 0 ), elements( 0 ),
+        n_rows( 0 ), n_columns( 0 ),
+        elements( std::make_shared< std::valarray<T> >() ),
         maxRowPrint( 10 ), noTime( false ), partialDataRowsDeleted( false ) {}
 
     //-----------------------------------------------------------------
@@ -72,7 +132,8 @@ public:
     // Empty DataFrame of size (row, columns), no column names
     //-----------------------------------------------------------------
     DataFrame( size_t rows, size_t columns ):
-        n_rows( rows ), n_columns( columns ), elements( columns * rows ),
+        n_rows( rows ), n_columns( columns ),
+        elements( std::make_shared< std::valarray<T> >( columns * rows ) ),
         maxRowPrint( 10 ), noTime( false ), partialDataRowsDeleted( false ) {}
 
     //-----------------------------------------------------------------
@@ -80,7 +141,8 @@ public:
     // single whitespace delimited string. 
     //-----------------------------------------------------------------
     DataFrame( size_t rows, size_t columns, std::string colNames ):
-        n_rows( rows ), n_columns( columns ), elements( columns * rows ),
+        n_rows( rows ), n_columns( columns ),
+        elements( std::make_shared< std::valarray<T> >( columns * rows ) ),
         columnNames( std::vector<std::string>(columns) ), maxRowPrint( 10 ),
         noTime( false ), partialDataRowsDeleted( false )
     {
@@ -93,7 +155,8 @@ public:
     //-----------------------------------------------------------------
     DataFrame( size_t rows, size_t columns,
                std::vector< std::string > columnNames ):
-        n_rows( rows ), n_columns( columns ), elements( columns * rows ),
+        n_rows( rows ), n_columns( columns ),
+        elements( std::make_shared< std::valarray<T> >( columns * rows ) ),
         columnNames( columnNames ), maxRowPrint( 10 ),
         noTime( false ), partialDataRowsDeleted( false ) 
     {
@@ -104,10 +167,10 @@ public:
     // Fortran style element access operators M(row,col)
     //-----------------------------------------------------------------
     T &operator()( size_t row, size_t column ) {
-        return elements[ row * n_columns + column ];
+        return MutableElements()[ row * n_columns + column ];
     }
     T operator()( size_t row, size_t column ) const {
-        return elements[ row * n_columns + column ];
+        return (*elements)[ row * n_columns + column ];
     }
 
     //-----------------------------------------------------------------
@@ -117,19 +180,21 @@ public:
     size_t NRows()    const { return n_rows;             }
     size_t size()     const { return n_rows * n_columns; }
 
-    std::valarray<T>  Elements() const { return elements; }
-    std::valarray<T> &Elements()       { return elements; }
+    const std::valarray<T> &Elements() const { return *elements;         }
+    std::valarray<T>       &Elements()       { return MutableElements(); }
 
-    std::vector< std::string >  Time() const { return time; }
-    std::vector< std::string > &Time()       { return time; }
+    const std::vector< std::string > &Time() const { return time; }
+    std::vector< std::string >       &Time()       { return time; }
 
     std::string  TimeName() const { return timeName; }
     std::string &TimeName()       { return timeName; }
 
-    std::vector< std::string >  ColumnNames() const { return columnNames; }
-    std::vector< std::string > &ColumnNames()       { return columnNames; }
+    const std::vector< std::string > &ColumnNames() const {
+        return columnNames;
+    }
+    std::vector< std::string > &ColumnNames() { return columnNames; }
 
-    std::map< std::string, size_t > ColumnNameToIndex() const {
+    const std::map< std::string, size_t > &ColumnNameToIndex() const {
         return columnNameToIndex;
     }
     std::map< std::string, size_t > &ColumnNameToIndex() {
@@ -147,7 +212,7 @@ public:
     //-----------------------------------------------------------------
     std::valarray<T> Column( size_t col ) const {
         // slice( size_t start, size_t length, size_t stride )
-        return elements[ std::slice( col, n_rows, n_columns ) ];
+        return (*elements)[ std::slice( col, n_rows, n_columns ) ];
     }
 
     //-----------------------------------------------------------------
@@ -155,20 +220,54 @@ public:
     //-----------------------------------------------------------------
     std::valarray<T> Row( size_t row ) const {
         // slice( size_t start, size_t length, size_t stride )
-        return elements[ std::slice( row * n_columns, n_columns, 1 ) ];
+        return (*elements)[ std::slice( row * n_columns, n_columns, 1 ) ];
+    }
+
+    //-----------------------------------------------------------------
+    // Non-owning row and column views of elements, no copy
+    //-----------------------------------------------------------------
+    DataFrameSpan< T > RowSpan( size_t row ) {
+        return DataFrameSpan< T >( ElementPointer( row * n_columns ),
+                                   n_columns, 1 );
+    }
+    DataFrameSpan< const T > RowSpan( size_t row ) const {
+        return DataFrameSpan< const T >( ElementPointer( row * n_columns ),
+                                         n_columns, 1 );
+    }
+
+    DataFrameSpan< T > ColumnSpan( size_t col ) {
+        return DataFrameSpan< T >( ElementPointer( col ), n_rows, n_columns );
+    }
+    DataFrameSpan< const T > ColumnSpan( size_t col ) const {
+        return DataFrameSpan< const T >( ElementPointer( col ),
+                                         n_rows, n_columns );
     }
 
     //------------------------------------------------------------------
     // Return data column selected by column name
     //------------------------------------------------------------------
-    std::valarray< double > VectorColumnName( std::string column ) {
-        
-        std::vector< std::string >::iterator ci = std::find(columnNames.begin(),
-                                                            columnNames.end(),
-                                                            column );
+    std::valarray< double > VectorColumnName( std::string column ) const {
+        return Column( ColumnNameIndex( column, "VectorColumnName" ) );
+    }
+
+    //------------------------------------------------------------------
+    // Non-owning view of data column selected by column name
+    //------------------------------------------------------------------
+    DataFrameSpan< const T > ColumnSpanName( std::string column ) const {
+        return ColumnSpan( ColumnNameIndex( column, "ColumnSpanName" ) );
+    }
+
+    //------------------------------------------------------------------
+    // Column index of column name, caller names the accessor in errors
+    //------------------------------------------------------------------
+    size_t ColumnNameIndex( const std::string & column,
+                            const std::string & caller ) const {
+
+        auto ci = std::find( columnNames.begin(), columnNames.end(), column );
+
         if ( ci == columnNames.end() ) {
             std::stringstream errMsg;
-            errMsg << "DataFrame::VectorColumnName() Failed to find column: "
+            errMsg << "DataFrame::" << caller << "() Failed to find column: "
                    << column;
             errMsg << " in DataFrame columns:\n[ ";
             for ( auto cni  = columnNames.begin();
@@ -178,17 +277,14 @@ public:
             throw std::runtime_error( errMsg.str() );
         }
 
-        size_t col_i = std::distance( columnNames.begin(), ci );
-
-        std::valarray< double > vec = Column( col_i );
-
-        return vec;
+        return std::distance( columnNames.begin(), ci );
     }
 
     //-----------------------------------------------------------------
     // Return (sub)DataFrame of specified column indices
     //-----------------------------------------------------------------
-    DataFrame< T > DataFrameFromColumnIndex( std::vector<size_t> column_i ) {
+    DataFrame< T > DataFrameFromColumnIndex(
+        std::vector<size_t> column_i ) const {
 
         DataFrame< T > M = DataFrame( n_rows, column_i.size() );
 
@@ -205,9 +301,12 @@ public:
                 throw std::runtime_error( errMsg.str() );
             }
 
-            std::valarray< T > column_vec_i = Column( col_i );
+            DataFrameSpan< const T > column_i_span = ColumnSpan( col_i );
+            DataFrameSpan< T >       column_j_span = M.ColumnSpan( col_j );
 
-            M.WriteColumn( col_j, column_vec_i );
+            for ( size_t row = 0; row < n_rows; row++ ) {
+                column_j_span[ row ] = column_i_span[ row ];
+            }
             col_j++;
         }
 
@@ -234,7 +333,7 @@ public:
     // columnNames converted to column indices for DataFrameFromColumnIndex()
     //------------------------------------------------------------------
     DataFrame< T > DataFrameFromColumnNames(
-        std::vector<std::string> colNames ) {
+        std::vector<std::string> colNames ) const {
 
         // vector of column indices for DataFrameFromColumnIndex()
         std::vector< size_t > col_i_vec;
@@ -278,7 +377,8 @@ public:
     //-----------------------------------------------------------------
     // Return (sub)DataFrame of specified row indices
     //-----------------------------------------------------------------
-    DataFrame< T > DataFrameFromRowIndex( std::vector<size_t> row_index ) {
+    DataFrame< T > DataFrameFromRowIndex(
+        std::vector<size_t> row_index ) const {
 
         DataFrame< T > M = DataFrame( row_index.size(), n_columns );
 
@@ -293,9 +393,9 @@ public:
                 throw std::runtime_error( errMsg.str() );
             }
             
-            std::valarray< T > row_vec_i = Row( row_i );
-
-            M.WriteRow( row_j, row_vec_i );
+            const T *row_i_data = ElementPointer( row_i * n_columns );
+            std::copy( row_i_data, row_i_data + n_columns,
+                       M.RowSpan( row_j ).data() );
             row_j++;
         }
         
@@ -322,12 +422,13 @@ public:
     //-----------------------------------------------------------------
     std::valarray< T > ColumnMajorData() const {
 
-        std::valarray< T > colMajorElements( elements.size() );
+        std::valarray< T > colMajorElements( elements->size() );
 
         for ( size_t col = 0; col < n_columns; col++ ) {
-            // slice( size_t start, size_t length, size_t stride )
-            colMajorElements[ std::slice( col * n_rows, n_rows, 1 ) ] =
-                Column( col );
+            DataFrameSpan< const T > column = ColumnSpan( col );
+            for ( size_t row = 0; row < n_rows; row++ ) {
+                colMajorElements[ col * n_rows + row ] = column[ row ];
+            }
         }
 
         return colMajorElements;
@@ -336,7 +437,7 @@ public:
     //-----------------------------------------------------------------
     // Write array to row
     //-----------------------------------------------------------------
-    void WriteRow( size_t row, std::valarray< T > array ) {
+    void WriteRow( size_t row, const std::valarray< T > & array ) {
         size_t N = array.size();
 
         if ( N != n_columns ) {
@@ -351,15 +452,16 @@ public:
                    << n_rows << ". " << row << " was provided.\n";
             throw std::runtime_error( errMsg.str() );
         }
+        std::valarray< T > &mutableElements = MutableElements();
         for ( size_t i = 0; i < N; i++ ) {
-            (*this)( row, i ) = array[ i ];
+            mutableElements[ row * n_columns + i ] = array[ i ];
         }
     }
 
     //-----------------------------------------------------------------
     // Write array to col
     //-----------------------------------------------------------------
-    void WriteColumn( size_t col, std::valarray< T > array ) {
+    void WriteColumn( size_t col, const std::valarray< T > & array ) {
         size_t N = array.size();
     
         if ( N != n_rows ) {
@@ -374,8 +476,9 @@ public:
                    << n_columns << ". " << col << " was provided.\n";
             throw std::runtime_error( errMsg.str() );
         }
+        std::valarray< T > &mutableElements = MutableElements();
         for ( size_t i = 0; i < N; i++ ) {
-            (*this)( i, col ) = array[ i ];
+            mutableElements[ i * n_columns + col ] = array[ i ];
         }
     }
 
@@ -408,14 +511,9 @@ public:
             }
         }
 
-        // Copy elements into data
-        std::valarray< T > data( elements );
-
-        // Resize elements
-        size_t n_elements = elements.size() - nrows * n_columns;
-        elements.resize( n_elements );
+        size_t n_elements = elements->size() - nrows * n_columns;
 
-        // Copy non deleted data to resized elements. NOTE: Row major format
+        // Non deleted data slice of elements. NOTE: Row major format
         std::slice elements_i;
         if ( tau < 0 ) {
             elements_i = std::slice( nrows * n_columns, n_elements, 1 );
@@ -424,9 +522,10 @@ public:
             elements_i = std::slice( 0, n_elements, 1 );
         }
 
-        // Bogus cast for MSVC 
-        elements[ std::slice( 0, n_elements, 1 ) ] =
-            ( std::valarray< T > ) data[ elements_i ];
+        // New elements from the slice: elements shared with copies of
+        // this DataFrame are left intact. Bogus cast for MSVC
+        elements = std::make_shared< std::valarray< T > >(
+            ( std::valarray< T > ) (*elements)[ elements_i ] );
     }
 
     //-----------------------------------------------------------------
@@ -574,7 +673,7 @@ public:
             
             for ( size_t colIdx = 0; colIdx < n_columns; colIdx++ ) {
 
-                lineStr << (*this) ( rowIdx, colIdx );
+                lineStr << (*elements)[ rowIdx * n_columns + colIdx ];
 
                 if ( colIdx != n_columns - 1 ) {
                     lineStr << ",";
@@ -621,7 +720,7 @@ private:
         // Initialize DataFrame members and storage
         n_rows      = namedData.begin()->second.size();
         n_columns   = namedData.size();
-        elements    = std::valarray <T>( n_rows * n_columns );
+        elements    = std::make_shared< std::valarray<T> >( n_rows * n_columns );
         columnNames = colNames;
 
         BuildColumnNameIndex();
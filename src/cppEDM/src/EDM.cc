@@ -1,16 +1,13 @@
 
 #include "EDM.h"
 
-// Declared in API.h
-extern DataFrame< double > MakeBlock( DataFrame< double > &, int, int,
-                                      std::vector< std::string > );
-
 //----------------------------------------------------------------
 // Constructors
 //----------------------------------------------------------------
 EDM::EDM ( DataFrame< double > & data,
            Parameters          & parameters ) :
-    data( data ), anyTies( false ), embedShift( 0 ),
+    data( data ), dimensionsEvaluated( 0 ), dimensionsTotal( 0 ),
+    recallValues(), embedShift( 0 ),
     parameters( parameters ) {}
 
 //----------------------------------------------------------------
@@ -35,12 +32,42 @@ void EDM::GetTarget() {
 }
 
 //----------------------------------------------------------------
-// Implemented as a wrapper for API MakeBlock()
+// targets of the target names or indices: entire records read as
+// GetTarget(), before PrepareEmbedding() removes partial data rows
+//----------------------------------------------------------------
+void EDM::GetTargets( const std::vector< std::string > & names ) {
+
+    size_t      targetIndex = parameters.targetIndex;
+    std::string targetName  = parameters.targetName;
+
+    targetNames = names;
+
+    targets.clear();
+    for ( auto name : targetNames ) {
+        if ( OnlyDigits( name, true ) ) {
+            parameters.targetIndex = std::stoi( name );
+            parameters.targetName  = "";
+        }
+        else {
+            parameters.targetIndex = 0;
+            parameters.targetName  = name;
+        }
+        GetTarget();
+        targets.push_back( target );
+    }
+
+    parameters.targetIndex = targetIndex;
+    parameters.targetName  = targetName;
+}
+
+//----------------------------------------------------------------
+// Time delay embedding view of the data columns, see EmbeddingView.h
+// Same embedding as the API MakeBlock() without the E-fold copy.
 // Note: dataFrame must have the columnNameToIndex map
 //
 // NOTE: Truncates data by tau * (E-1) rows to remove
 //       nan values (partial data rows)
-// NOTE: The returned data block does NOT have the time column
+// NOTE: The embedding does NOT have the time column
 //----------------------------------------------------------------
 void EDM::EmbedData() {
 
@@ -96,6 +123,6 @@ void EDM::EmbedData() {
         dataFrame = data.DataFrameFromColumnIndex( parameters.columnIndex );
     }
 
-    embedding = MakeBlock( std::ref( dataFrame ), parameters.E,
-                           parameters.tau, colNames );
+    embedding = EmbeddingView( dataFrame, parameters.E,
+                               parameters.tau, colNames );
 }
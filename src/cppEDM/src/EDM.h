@@ -2,9 +2,16 @@
 #ifndef EDM_H
 #define EDM_H
 
+#include <functional>
 #include <mutex>
 #include "Common.h"
 #include "Parameter.h"
+#include "EmbeddingView.h"
+#include "NeighborTable.h"
+#include "ProjectionForest.h"
+
+// Neighbor searches of the embedding without the distance matrix
+enum class NeighborSearch { Partial, Approximate, Exact };
 
 //---------------------------------------------------------------------
 // EDM Class
@@ -18,13 +25,14 @@ class EDM {
 
 public: // No need for private or protected
     DataFrame< double > data;
-    DataFrame< double > embedding;
+    EmbeddingView       embedding; // PrepareEmbedding() : EmbedData()
 
-    DataFrame< size_t > knn_neighbors; // N pred rows, knn columns; sorted
-    DataFrame< double > knn_distances; // N pred rows, knn columns; sorted
+    // N pred rows, knn columns; sorted. Simplex ties in the overflow
+    NeighborTable       knnTable;      // FindNeighbors()
 
-    DataFrame< size_t > allLibRows;   // 1 row,       N lib columns
+    DataFrame< NeighborIndex > allLibRows; // 1 row,  N lib columns
     DataFrame< double > allDistances; // N pred rows  N lib columns
+    DataFrame< float >  allDistancesFloat; // singlePrecision allDistances
 
     DataFrame< double > projection;   // Simplex & SMap Output
     DataFrame< double > coefficients; // SMap Output
@@ -35,18 +43,33 @@ public: // No need for private or protected
     std::valarray< double > const_predictions;
     std::valarray< double > variance;
 
-    // Simplex :: Prediction row accounting of library neighbor ties
-    bool                  anyTies;
-    std::vector< bool >   ties;          // true/false each prediction row
-    std::vector< size_t > tieFirstIndex; // index in knn of first tie
-    std::vector< std::vector< std::pair< double, size_t > > > tiePairs;
-
     // SMap :: Each prediction row can have variable knn
     std::vector< size_t > knnSmap;
 
+    // FindNeighbors() partial distance or approximate search: distance
+    // terms evaluated, and of a full search
+    size_t dimensionsEvaluated;
+    size_t dimensionsTotal;
+
+    // Approximate search index of the library rows, and the recall of
+    // the approximate neighbors in NeighborRecall()
+    ProjectionForest forest;
+    RecallValues     recallValues;
+
+    // StateNeighbors() query state vectors, rows of the embedding
+    // columns predicted in place of prediction rows
+    DataFrame< double > states;
+
     std::valarray< double >    target;  // entire record
     std::vector< std::string > allTime; // entire record
 
+    // ProjectMultiTarget(): targets share the embedding and neighbors,
+    // multiPredictions[ i ], multiVariance[ i ] of targets[ i ]
+    std::vector< std::string >             targetNames;
+    std::vector< std::valarray< double > > targets; // entire records
+    std::vector< std::valarray< double > > multiPredictions;
+    std::vector< std::valarray< double > > multiVariance;
+
     int embedShift; // number of data rows lost to embedding
 
     Parameters parameters;
@@ -57,6 +80,7 @@ public: // No need for private or protected
     // Method declarations
     // EDM.cc
     void GetTarget();
+    void GetTargets( const std::vector< std::string > & names );
     void EmbedData();
     void Project();  // Simplex.cc : SMap.cc : CCM.cc : Multiview.cc
 
@@ -64,11 +88,55 @@ public: // No need for private or protected
     void PrepareEmbedding( bool checkDataRows = true );
     void Distances();
     void FindNeighbors();
+    bool ExcludeNeighbor( size_t predictionRow, size_t libRow,
+                          int max_lib_index ) const;
+    bool ExcludeTarget( size_t libRow, int max_lib_index ) const;
+    void InsertNeighbors( size_t pred_row,
+                          const std::vector< std::pair< double, size_t > > & );
+    template< class T >
+    std::vector< T > InverseScales() const;
+    template< class T, class Metric >
+    void PartialDistanceSearch( const T *source, const T *invScale,
+                                int max_lib_index, const Metric & );
+    void SearchEmbedding( NeighborSearch search, int max_lib_index );
+    template< class T >
+    void SearchEmbedding( const T *source, NeighborSearch search,
+                          int max_lib_index );
+    void BuildForest();
+    template< class T >
+    void BuildForest( const T *source, const T *invScale );
+    template< class T, class Metric >
+    void ForestSearch( const T *source, int max_lib_index, bool exhaustive,
+                       const Metric & );
+    void NeighborRecall( std::function< void() > predict );
+    void StateNeighbors( const DataFrame< double > & queryStates );
+    template< class T >
+    void SearchStates( const T *source, int max_lib_index );
+    template< class T, class Metric >
+    void StateSearch( const T *source, const T *queries, size_t span,
+                      int max_lib_index, const Metric & );
+    void FoldNeighbors( const std::vector< size_t > & foldStart,
+                        int foldBuffer );
+    template< class T >
+    void SearchFolds( const T *source, const std::vector< size_t > & foldStart,
+                      int foldBuffer, int max_lib_index );
+    template< class T, class Metric >
+    void FoldSearch( const T *source, const std::vector< size_t > & foldStart,
+                     int foldBuffer, int max_lib_index, const Metric & );
+    void OriginNeighbors( const std::vector< size_t > & libFirst,
+                          const std::vector< size_t > & libLast );
+    template< class T >
+    void SearchOrigins( const T *source, const std::vector< size_t > & libFirst,
+                        const std::vector< size_t > & libLast );
+    template< class T, class Metric >
+    void OriginSearch( const T *source, const std::vector< size_t > & libFirst,
+                       const std::vector< size_t > & libLast, const Metric & );
 
     // EDM_Formatting.cc
     void CheckDataRows( std::string call );
     void RemovePartialData();
     void FormatOutput();
+    void FormatStateOutput();
     void FillTimes( std::vector< std::string > & timeOut );
 
     void PrintDataFrameIn(); // EDM_Neighbors.cc #ifdef DEBUG_ALL
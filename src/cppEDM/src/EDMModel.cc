@@ -0,0 +1,388 @@
+
+#include "EDMModel.h"
+
+//----------------------------------------------------------------
+// Constructor
+// parameters are the model parameters, Method::None: not validated.
+// Prepares the Simplex embedding, target and library, or loads them
+// from modelFile.
+//----------------------------------------------------------------
+EDMModel::EDMModel (
+    DataFrame< double > & data,
+    Parameters          & parameters,
+    std::string           modelFile ):
+    parameters( parameters ), simplex( data, parameters ),
+    smap( data, parameters ), smapPrepared( false ), hash( 0 ) {
+
+    // Queries return the projections, no output files
+    this->parameters.predictOutputFile = "";
+    this->parameters.SmapOutputFile    = "";
+
+    hash = ContentHash( data );
+
+    if ( modelFile.size() ) {
+        Load( modelFile );
+    }
+    else {
+        Prepare( simplex, Method::Simplex );
+    }
+}
+
+//----------------------------------------------------------------
+// Simplex projection of the pred_str prediction rows
+//----------------------------------------------------------------
+DataFrame< double > EDMModel::PredictSimplex( std::string pred ) {
+
+    Query( simplex, Method::Simplex, pred, 0 );
+
+    if ( simplex.parameters.recallSample ) {
+        simplex.NeighborRecall( [this]() { simplex.Simplex(); } );
+    }
+
+    simplex.Simplex();
+
+    simplex.FormatOutput();
+
+    return simplex.projection;
+}
+
+//----------------------------------------------------------------
+// SMap projection of the pred_str prediction rows with theta
+//----------------------------------------------------------------
+SMapValues EDMModel::PredictSMap( std::string pred, double theta,
+                                  Solver      solver ) {
+
+    if ( not smapPrepared ) {
+        Prepare( smap, Method::SMap );
+        smapPrepared = true;
+    }
+
+    Query( smap, Method::SMap, pred, theta );
+
+    if ( smap.parameters.recallSample ) {
+        smap.NeighborRecall( [this, solver]() { smap.SMap( solver ); } );
+    }
+
+    smap.SMap( solver );
+
+    smap.FormatOutput();
+
+    smap.WriteOutput(); // coefficients & truncation formatting, no files
+
+    SMapValues values = SMapValues();
+    values.predictions  = smap.projection;
+    values.coefficients = smap.coefficients;
+    values.truncation   = smap.truncation;
+
+    return values;
+}
+
+//----------------------------------------------------------------
+// Simplex projection of the query state vectors: rows of states
+// with the embedding columns, see EDM::StateNeighbors()
+//----------------------------------------------------------------
+DataFrame< double > EDMModel::PredictSimplexStates(
+    const DataFrame< double > & states ) {
+
+    QueryStates( simplex, Method::Simplex, states, 0 );
+
+    simplex.Simplex();
+
+    simplex.FormatStateOutput();
+
+    return simplex.projection;
+}
+
+//----------------------------------------------------------------
+// SMap projection of the query state vectors with theta
+//----------------------------------------------------------------
+SMapValues EDMModel::PredictSMapStates( const DataFrame< double > & states,
+                                        double theta, Solver solver ) {
+
+    if ( not smapPrepared ) {
+        Prepare( smap, Method::SMap );
+        smapPrepared = true;
+    }
+
+    QueryStates( smap, Method::SMap, states, theta );
+
+    smap.SMap( solver );
+
+    smap.FormatStateOutput();
+
+    smap.FormatStateCoefficients();
+
+    SMapValues values = SMapValues();
+    values.predictions  = smap.projection;
+    values.coefficients = smap.coefficients;
+    values.truncation   = smap.truncation;
+
+    return values;
+}
+
+//----------------------------------------------------------------
+// Simplex knn neighbors of the pred_str prediction rows:
+//   neighbors : library data rows (1-offset) of the knn neighbors
+//   distances : neighbor distances
+// Rows are the prediction rows with the data time.
+//----------------------------------------------------------------
+NeighborValues EDMModel::Neighbors( std::string pred ) {
+
+    Query( simplex, Method::Simplex, pred, 0 );
+
+    const Parameters    & query = simplex.parameters;
+    const NeighborTable & table = simplex.knnTable;
+
+    size_t Npred = table.NRows();
+    size_t knn   = table.NColumns();
+
+    // Embedding rows are data rows less the partial data rows
+    // deleted at the start of the data if tau < 0
+    size_t shift = 0;
+    if ( not query.embedded and query.tau < 0 ) {
+        shift = abs( query.tau ) * ( query.E - 1 );
+    }
+
+    std::stringstream neighborNames;
+    std::stringstream distanceNames;
+    for ( size_t k = 1; k <= knn; k++ ) {
+        neighborNames << "knn_"  << k << " ";
+        distanceNames << "dist_" << k << " ";
+    }
+
+    NeighborValues values = NeighborValues();
+    values.neighbors = DataFrame< double >( Npred, knn, neighborNames.str() );
+    values.distances = DataFrame< double >( Npred, knn, distanceNames.str() );
+
+    for ( size_t row = 0; row < Npred; row++ ) {
+        for ( size_t k = 0; k < knn; k++ ) {
+            double distance = table.Distance( row, k );
+            values.distances( row, k ) = distance;
+            values.neighbors( row, k ) = std::isnan( distance ) ? NAN :
+                table.Neighbors( row )[ k ] + shift + 1;
+        }
+    }
+
+    // Time of the prediction rows
+    const std::vector< std::string > & time = simplex.data.Time();
+    if ( time.size() ) {
+        std::vector< std::string > predTime( Npred );
+        for ( size_t row = 0; row < Npred; row++ ) {
+            predTime[ row ] = time[ query.prediction[ row ] ];
+        }
+        values.neighbors.Time()     = predTime;
+        values.neighbors.TimeName() = simplex.data.TimeName();
+        values.distances.Time()     = predTime;
+        values.distances.TimeName() = simplex.data.TimeName();
+    }
+
+    return values;
+}
+
+//----------------------------------------------------------------
+// Write the prepared Simplex state to modelFile, see ModelFile.h.
+// The approxTrees forest is built if no query has built it.
+//----------------------------------------------------------------
+void EDMModel::Save( std::string modelFile ) {
+
+    if ( parameters.approxTrees and not simplex.forest.NTrees() ) {
+        simplex.BuildForest();
+    }
+
+    const std::valarray< double > & target = simplex.target;
+
+    ModelFileWriter file( modelFile, hash );
+
+    file.Scalar< int64_t >( simplex.embedShift );
+    simplex.embedding.Save( file );
+    file.Array( target.size() ? &target[ 0 ] : nullptr, target.size() );
+    file.Array( simplex.parameters.library );
+    simplex.forest.Save( file );
+
+    file.Close();
+}
+
+//----------------------------------------------------------------
+// Load the prepared Simplex state of Save() from modelFile.
+// The data rows and library indices are adjusted for the embedding
+// as in PrepareEmbedding(): these are not in the file.
+//----------------------------------------------------------------
+void EDMModel::Load( std::string modelFile ) {
+
+    ModelFileReader file( modelFile );
+
+    if ( file.Hash() != hash ) {
+        std::stringstream errMsg;
+        errMsg << "EDMModel::Load(): " << modelFile << " was not saved "
+               << "from this data and parameters: content hash "
+               << file.Hash() << " expected " << hash << ".\n";
+        throw std::runtime_error( errMsg.str() );
+    }
+
+    simplex.parameters = QueryParameters( Method::Simplex, PreparePred(),
+                                          parameters.theta );
+
+    simplex.CheckDataRows( "EDMModel::Load" );
+
+    simplex.allTime = simplex.data.Time(); // Original, full record of time
+
+    if ( not simplex.parameters.embedded and
+         not simplex.data.PartialDataRowsDeleted() ) {
+        simplex.RemovePartialData(); // the model data copy: no lock
+    }
+
+    simplex.embedShift = (int) file.Scalar< int64_t >();
+    simplex.embedding.Load( file );
+
+    size_t        nTarget;
+    const double *target = file.Array< double >( nTarget );
+    simplex.target = std::valarray< double >( target, nTarget );
+
+    std::vector< size_t > library = file.Vector< size_t >();
+
+    simplex.forest.Load( file );
+
+    // The state indexes the data rows of the parameters
+    size_t nRows = simplex.embedding.NRows();
+    if ( library != simplex.parameters.library or
+         nRows   != simplex.data.NRows() or nTarget < nRows or
+         simplex.forest.RowsIndexed() > nRows ) {
+        std::stringstream errMsg;
+        errMsg << "EDMModel::Load(): " << modelFile << " state does not "
+               << "match the data rows.\n";
+        throw std::runtime_error( errMsg.str() );
+    }
+}
+
+//----------------------------------------------------------------
+// Content hash of the data and the parameters of the prepared state:
+// embedding, target, library rows and forest
+//----------------------------------------------------------------
+uint64_t EDMModel::ContentHash( const DataFrame< double > & data ) const {
+
+    size_t dims[ 2 ] = { data.NRows(), data.NColumns() };
+    uint64_t h = ::ContentHash( dims, sizeof( dims ) );
+
+    if ( data.size() ) {
+        h = ::ContentHash( &data.Elements()[ 0 ],
+                           data.size() * sizeof( double ), h );
+    }
+    for ( auto & name : data.ColumnNames() ) {
+        h = ::ContentHash( name.c_str(), name.size() + 1, h );
+    }
+
+    for ( auto str : { parameters.lib_str,    parameters.columns_str,
+                       parameters.target_str, parameters.metric_str,
+                       parameters.metricScales_str } ) {
+        h = ::ContentHash( str.c_str(), str.size() + 1, h );
+    }
+
+    int values[ 8 ] = { parameters.E, parameters.Tp, parameters.knn,
+                        parameters.tau, parameters.embedded,
+                        parameters.singlePrecision, parameters.approxTrees,
+                        (int) parameters.seed };
+
+    return ::ContentHash( values, sizeof( values ), h );
+}
+
+//----------------------------------------------------------------
+// Validated copy of the model parameters for method with the
+// pred_str prediction rows and theta
+//----------------------------------------------------------------
+Parameters EDMModel::QueryParameters( Method      method,
+                                      std::string pred,
+                                      double      theta ) const {
+    Parameters query = parameters;
+    query.method     = method;
+    query.pred_str   = pred;
+    query.theta      = theta;
+
+    query.Validate();
+
+    return query;
+}
+
+//----------------------------------------------------------------
+// PrepareEmbedding() of edm for method, with the first library
+// segment as prediction rows. Deletes the partial data rows of edm.
+//----------------------------------------------------------------
+void EDMModel::Prepare( EDM & edm, Method method ) {
+
+    edm.parameters = QueryParameters( method, PreparePred(),
+                                      parameters.theta );
+
+    edm.PrepareEmbedding();
+}
+
+//----------------------------------------------------------------
+// pred_str of the first library segment
+//----------------------------------------------------------------
+std::string EDMModel::PreparePred() const {
+
+    std::vector< std::string > lib_vec =
+        SplitString( parameters.lib_str, " \t," );
+
+    std::string pred;
+    if ( lib_vec.size() > 1 ) {
+        pred = lib_vec[ 0 ] + " " + lib_vec[ 1 ];
+    }
+    return pred;
+}
+
+//----------------------------------------------------------------
+// Distances() and FindNeighbors() of the pred_str prediction rows
+// in the prepared edm. The partial data rows were deleted in
+// Prepare(): the library and prediction rows are adjusted here as
+// in RemovePartialData().
+//----------------------------------------------------------------
+void EDMModel::Query( EDM & edm, Method method, std::string pred,
+                      double theta ) {
+
+    Parameters query = EmbeddingParameters( method, pred, theta );
+
+    if ( not query.prediction.size() ) {
+        std::stringstream errMsg;
+        errMsg << "EDMModel::Query(): No prediction rows in pred "
+               << pred << " after the embedding partial data rows.\n";
+        throw std::runtime_error( errMsg.str() );
+    }
+
+    edm.parameters = query;
+
+    edm.Distances(); // pred : lib distances, or the embedding search
+
+    edm.FindNeighbors();
+}
+
+//----------------------------------------------------------------
+// StateNeighbors() of the query states in the prepared edm. The
+// prediction rows are the states: no const_predict of data rows.
+//----------------------------------------------------------------
+void EDMModel::QueryStates( EDM & edm, Method method,
+                            const DataFrame< double > & states,
+                            double theta ) {
+
+    Parameters query = EmbeddingParameters( method, PreparePred(), theta );
+    query.const_predict = false;
+
+    edm.parameters = query;
+
+    edm.StateNeighbors( states );
+}
+
+//----------------------------------------------------------------
+// QueryParameters() with the library and prediction rows adjusted
+// for the partial data rows deleted in Prepare()
+//----------------------------------------------------------------
+Parameters EDMModel::EmbeddingParameters( Method      method,
+                                          std::string pred,
+                                          double      theta ) const {
+
+    Parameters query = QueryParameters( method, pred, theta );
+
+    if ( not query.embedded and abs( query.tau ) * ( query.E - 1 ) > 0 ) {
+        query.DeleteLibPred();
+    }
+
+    return query;
+}
@@ -0,0 +1,73 @@
+#ifndef EDM_MODEL_H
+#define EDM_MODEL_H
+
+#include "EDM.h"
+#include "ModelFile.h"
+#include "Simplex.h"
+#include "SMap.h"
+
+//----------------------------------------------------------------
+// EDMModel class
+// Library embedding, target and neighbor index of a data set
+// prepared once for repeated Simplex, SMap and neighbor queries of
+// prediction rows.
+//
+// parameters hold the library (lib_str) and embedding of the model,
+// the pred_str and theta of each query are applied to a copy.
+// The Simplex object is prepared on construction, the SMap object
+// on the first SMap query: PrepareEmbedding() with the library as
+// prediction rows. Queries then compute only the distances and
+// neighbors of the prediction rows, with the approxTrees forest
+// built once for each object.
+//
+// PredictSimplexStates() and PredictSMapStates() predict external
+// query state vectors in place of prediction rows: rows of the
+// embedding columns, searched against the prepared library in
+// nThreads threads with no leave-one-out, exclusion radius or time.
+//
+// Save() writes the prepared Simplex state to a model file:
+// embedding, target, library rows and forest, see ModelFile.h.
+// The constructor with a modelFile loads that state in place of
+// PrepareEmbedding() and the forest build, if the file hash of the
+// data and the parameters of the state matches the arguments.
+//----------------------------------------------------------------
+class EDMModel {
+public:
+    Parameters   parameters; // model parameters, not validated
+    SimplexClass simplex;    // prepared Simplex state
+    SMapClass    smap;       // prepared SMap state
+    bool         smapPrepared;
+    uint64_t     hash;       // ContentHash() of data and parameters
+
+    // Constructor
+    EDMModel ( DataFrame< double > & data,
+               Parameters          & parameters,
+               std::string           modelFile = "" );
+
+    // Method declarations
+    DataFrame< double > PredictSimplex( std::string pred );
+    SMapValues          PredictSMap   ( std::string pred, double theta,
+                                        Solver solver = & SVD );
+    NeighborValues      Neighbors     ( std::string pred );
+    DataFrame< double > PredictSimplexStates(
+                            const DataFrame< double > & states );
+    SMapValues          PredictSMapStates(
+                            const DataFrame< double > & states, double theta,
+                            Solver solver = & SVD );
+    void                Save          ( std::string modelFile );
+
+    Parameters  QueryParameters( Method method, std::string pred,
+                                 double theta ) const;
+    Parameters  EmbeddingParameters( Method method, std::string pred,
+                                     double theta ) const;
+    uint64_t    ContentHash( const DataFrame< double > & data ) const;
+    std::string PreparePred() const;
+    void        Prepare( EDM & edm, Method method );
+    void        Load   ( std::string modelFile );
+    void        Query  ( EDM & edm, Method method, std::string pred,
+                         double theta );
+    void        QueryStates( EDM & edm, Method method,
+                             const DataFrame< double > & states,
+                             double theta );
+};
+#endif
@@ -0,0 +1,260 @@
+
+#include <limits>
+
+#include "EDMStream.h"
+#include "EDM_Metrics.h"
+
+//----------------------------------------------------------------
+// EDMStream::Search() arguments, called by EDM_Metric::Dispatch()
+// with the metric policy
+//----------------------------------------------------------------
+template< class T >
+struct StreamSearchKernel {
+    EDMStream & stream;
+    const T   * source;
+
+    template< class Metric >
+    void operator()( const Metric & metric ) {
+        stream.Search( source, metric );
+    }
+};
+
+//----------------------------------------------------------------
+// Constructor
+// parameters are the session parameters, Method::None: not validated.
+// Prepares the history data.
+//----------------------------------------------------------------
+EDMStream::EDMStream (
+    DataFrame< double > & data,
+    Parameters          & parameters ):
+    SimplexClass( data, parameters ), nTarget( 0 ), maxLibIndex( 0 ) {
+
+    Parameters & P = this->parameters;
+
+    // Validate() pred of the last two rows, Forecast() sets the last
+    std::stringstream pred;
+    pred << data.NRows() - 1 << " " << data.NRows();
+
+    P.method            = Method::Simplex;
+    P.pred_str          = pred.str();
+    P.predictOutputFile = ""; // Forecasts are returned, not written
+    P.Validate();
+
+    if ( ( not P.embedded and P.tau > 0 ) or P.Tp < 0 ) {
+        std::stringstream errMsg;
+        errMsg << "EDMStream(): tau " << P.tau << " Tp " << P.Tp
+               << ": streaming requires tau < 0 or embedded, "
+               << "and Tp >= 0.\n";
+        throw std::runtime_error( errMsg.str() );
+    }
+
+    PrepareEmbedding();
+
+    if ( not P.library.size() ) {
+        std::stringstream errMsg;
+        errMsg << "EDMStream(): No library rows in lib " << P.lib_str
+               << " after the embedding partial data rows.\n";
+        throw std::runtime_error( errMsg.str() );
+    }
+
+    nTarget     = target.size();
+    maxLibIndex = *std::max_element( P.library.begin(), P.library.end() );
+
+    invScale      = InverseScales< double >();
+    invScaleFloat = InverseScales< float  >();
+
+    if ( P.singlePrecision ) {
+        embedding.SinglePrecision( false ); // Simplex distances only
+    }
+
+    if ( P.approxTrees ) {
+        BuildForest();
+    }
+}
+
+//----------------------------------------------------------------
+// Append rows with the data columns: the embedding, target and
+// time rows as EmbedData() and GetTarget() of the history, and the
+// embedding rows to the library and forest.
+//----------------------------------------------------------------
+void EDMStream::Append( DataFrame< double > & rows ) {
+
+    if ( not rows.NRows() ) {
+        return;
+    }
+
+    DataFrame< double > block;
+    if ( parameters.columnNames.size() ) {
+        block = rows.DataFrameFromColumnNames( parameters.columnNames );
+    }
+    else {
+        block = rows.DataFrameFromColumnIndex( parameters.columnIndex );
+    }
+
+    std::valarray< double > rowsTarget;
+    if ( parameters.targetIndex ) {
+        rowsTarget = rows.Column( parameters.targetIndex );
+    }
+    else if ( parameters.targetName.size() ) {
+        rowsTarget = rows.VectorColumnName( parameters.targetName );
+    }
+    else {
+        rowsTarget = rows.Column( 0 );
+    }
+
+    bool time = data.Time().size();
+    if ( time and rows.Time().size() != rows.NRows() ) {
+        std::stringstream errMsg;
+        errMsg << "EDMStream::Append(): rows have no time column "
+               << data.TimeName() << ".\n";
+        throw std::runtime_error( errMsg.str() );
+    }
+
+    if ( embedding.NRows() + rows.NRows() >
+         std::numeric_limits< NeighborIndex >::max() ) {
+        std::stringstream errMsg;
+        errMsg << "EDMStream::Append(): embedding rows exceed the "
+               << "neighbor index range "
+               << std::numeric_limits< NeighborIndex >::max();
+        throw std::runtime_error( errMsg.str() );
+    }
+
+    for ( size_t row = 0; row < rows.NRows(); row++ ) {
+
+        size_t libRow = embedding.NRows(); // embedding row of row
+
+        embedding.Append( block.RowSpan( row ).data() );
+
+        AppendTarget( rowsTarget[ row ] );
+
+        if ( time ) {
+            data.Time().push_back( rows.Time()[ row ] );
+            allTime.push_back( rows.Time()[ row ] );
+        }
+
+        parameters.library.push_back( libRow );
+        maxLibIndex = (int) libRow;
+
+        if ( forest.NTrees() ) {
+            if ( parameters.singlePrecision ) {
+                forest.Insert( (NeighborIndex) libRow,
+                               embedding.RowBaseFloat( 0 ),
+                               embedding.Stride(), embedding.Offsets(),
+                               invScaleFloat.size() ?
+                               invScaleFloat.data() : nullptr );
+            }
+            else {
+                forest.Insert( (NeighborIndex) libRow,
+                               embedding.RowBase( 0 ),
+                               embedding.Stride(), embedding.Offsets(),
+                               invScale.size() ? invScale.data() : nullptr );
+            }
+        }
+    }
+}
+
+//----------------------------------------------------------------
+// Simplex projection Tp ahead of the last row: the Simplex()
+// output of pred the last row
+//----------------------------------------------------------------
+DataFrame< double > EDMStream::Forecast() {
+
+    parameters.prediction.assign( 1, embedding.NRows() - 1 );
+
+    knnTable = NeighborTable( 1, parameters.knn, parameters.singlePrecision );
+    knnSmap  = std::vector< size_t >( 1, parameters.knn );
+
+    if ( parameters.singlePrecision ) {
+        StreamSearchKernel< float > kernel = {
+            *this, embedding.RowBaseFloat( 0 ) };
+        EDM_Metric::Dispatch( parameters.metric, invScaleFloat.data(),
+                              kernel );
+    }
+    else {
+        StreamSearchKernel< double > kernel = {
+            *this, embedding.RowBase( 0 ) };
+        EDM_Metric::Dispatch( parameters.metric, invScale.data(), kernel );
+    }
+
+    Simplex();
+
+    FormatOutput();
+
+    return projection;
+}
+
+//----------------------------------------------------------------
+// knn neighbors of the prediction row in knnTable row 0.
+// The library rows are scanned, or with approxTrees the forest
+// leaves are visited as in ForestSearch(): best first until
+// approxTrees * leafSize rows are visited and knn are valid.
+// Distances are computed as in EmbeddingDistances().
+//----------------------------------------------------------------
+template< class T, class Metric >
+void EDMStream::Search( const T * source, const Metric & metric ) {
+
+    size_t        stride        = embedding.Stride();
+    const size_t *offset        = embedding.Offsets();
+    size_t        nDim          = embedding.NColumns();
+    size_t        knn           = (size_t) parameters.knn;
+    size_t        predictionRow = parameters.prediction[ 0 ];
+    const T      *v1            = source + predictionRow * stride;
+
+    rowPair.clear();
+
+    auto distance = [&]( size_t libRow ) {
+        if ( ExcludeNeighbor( predictionRow, libRow, maxLibIndex ) ) {
+            return;
+        }
+
+        const T *v2 = source + libRow * stride;
+
+        T acc = 0;
+        for ( size_t i = 0; i < nDim; i++ ) {
+            acc = metric.Add( acc, v2[ offset[ i ] ] - v1[ offset[ i ] ], i );
+        }
+        rowPair.push_back(
+            std::make_pair( (double) metric.Distance( acc ), libRow ) );
+    };
+
+    if ( forest.NTrees() ) {
+        size_t budget = (size_t) parameters.approxTrees * forest.LeafSize();
+
+        visited.clear();
+
+        auto visit = [&]( const NeighborIndex * begin,
+                          const NeighborIndex * end ) {
+            for ( const NeighborIndex *row = begin; row != end; ++row ) {
+                if ( visited.insert( *row ).second ) {
+                    distance( *row ); // not in a leaf of a previous tree
+                }
+            }
+            return visited.size() < budget or rowPair.size() < knn;
+        };
+
+        forest.Search( v1, offset, visit );
+    }
+    else {
+        for ( size_t libRow : parameters.library ) {
+            distance( libRow );
+        }
+    }
+
+    SortNearest( rowPair, knn );
+
+    InsertNeighbors( 0, rowPair );
+}
+
+//----------------------------------------------------------------
+// Target of an appended row, the target grown by doubling
+//----------------------------------------------------------------
+void EDMStream::AppendTarget( double value ) {
+    if ( nTarget == target.size() ) {
+        std::valarray< double > grown( NAN, std::max( 2 * nTarget,
+                                                      (size_t) 16 ) );
+        std::copy( std::begin( target ), std::end( target ),
+                   std::begin( grown ) );
+        target.swap( grown );
+    }
+    target[ nTarget++ ] = value;
+}
@@ -0,0 +1,55 @@
+#ifndef EDM_STREAM_H
+#define EDM_STREAM_H
+
+#include <unordered_set>
+
+#include "Simplex.h"
+
+//----------------------------------------------------------------
+// EDMStream class
+// Streaming Simplex session: observations are appended as they
+// arrive, each Forecast() is the Simplex projection Tp ahead of the
+// last observation.
+//
+// The history data are prepared once as in Simplex(): embedding,
+// target, the lib_str library rows and the approxTrees forest.
+// Append() extends the delay embedding, target and time by the new
+// rows, and the library and forest by their embedding rows.
+// Forecast() searches the knn neighbors of the last row alone: a
+// scan of the library rows, or a search of the forest, without the
+// distance matrix or a new embedding. The forecast is that of
+// Simplex() of the history and appended rows, with pred the last
+// row and the library extended by the appended rows.
+//
+// data holds the history: only its time is extended. The target
+// has room to grow, unused rows are nan as rows beyond the target
+// in FormatOutput().
+//
+// The embedding row of an observation must be complete when it is
+// appended: tau < 0, or embedded = true.
+//----------------------------------------------------------------
+class EDMStream : public SimplexClass {
+public:
+    size_t nTarget;     // target rows in use
+    int    maxLibIndex; // last library row
+
+    // Forecast() search state, reused
+    std::vector< double >                      invScale;
+    std::vector< float >                       invScaleFloat;
+    std::vector< std::pair< double, size_t > > rowPair;
+    std::unordered_set< NeighborIndex >        visited;
+
+    // Constructor
+    EDMStream ( DataFrame< double > & data, Parameters & parameters );
+
+    // Method declarations
+    void                Append  ( DataFrame< double > & rows );
+    DataFrame< double > Forecast();
+
+    template< class T, class Metric >
+    void Search( const T * source, const Metric & metric );
+
+private:
+    void AppendTarget( double value );
+};
+#endif
@@ -181,6 +181,19 @@ void EDM::FormatOutput() {
 #endif
 }
 
+//----------------------------------------------------------
+// Projection of the StateNeighbors() states: one row of
+// predictions and variance for each state, no time or observations
+//----------------------------------------------------------
+void EDM::FormatStateOutput() {
+
+    projection = DataFrame< double >( predictions.size(), 2,
+                                      "Predictions Pred_Variance" );
+
+    projection.WriteColumn( 0, predictions );
+    projection.WriteColumn( 1, variance    );
+}
+
 //----------------------------------------------------------
 // Copy strings of time values into timeOut.
 // If prediction times exceed times from the data,
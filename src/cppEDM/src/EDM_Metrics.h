@@ -0,0 +1,90 @@
+#ifndef EDM_METRICS_H
+#define EDM_METRICS_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+#include "Common.h"
+
+//----------------------------------------------------------------
+// Distance metric policies of the embedding distance kernels
+//
+// A policy accumulates the coordinate differences delta_j of two
+// embedding vectors, then maps the accumulation to the distance:
+//   acc = Add( acc, delta_j, j ), acc = 0 initially
+//   distance = Distance( acc )
+// Accumulations are non-decreasing in j, so a partial accumulation
+// bounds the distance from below (partial distance search).
+//
+// Kernels are templates of the policy, instantiated for each metric
+// by Dispatch(), so there is no metric branch per vector pair.
+//----------------------------------------------------------------
+namespace EDM_Metric {
+
+    template< class T >
+    struct Euclidean {
+        T Add( T acc, T delta, size_t ) const { return acc + delta * delta; }
+        T Distance( T acc ) const { return std::sqrt( acc ); }
+    };
+
+    template< class T >
+    struct SquaredEuclidean {
+        T Add( T acc, T delta, size_t ) const { return acc + delta * delta; }
+        T Distance( T acc ) const { return acc; }
+    };
+
+    template< class T >
+    struct Manhattan {
+        T Add( T acc, T delta, size_t ) const { return acc + std::abs( delta ); }
+        T Distance( T acc ) const { return acc; }
+    };
+
+    template< class T >
+    struct Chebyshev {
+        T Add( T acc, T delta, size_t ) const {
+            return std::max( acc, std::abs( delta ) );
+        }
+        T Distance( T acc ) const { return acc; }
+    };
+
+    //------------------------------------------------------------
+    // Euclidean distance of the coordinates divided by the per
+    // embedding column scales: invScale[ j ] = 1 / scale_j
+    //------------------------------------------------------------
+    template< class T >
+    struct WeightedEuclidean {
+        const T *invScale;
+
+        explicit WeightedEuclidean( const T *invScale ) :
+            invScale( invScale ) {}
+
+        T Add( T acc, T delta, size_t j ) const {
+            T d = delta * invScale[ j ];
+            return acc + d * d;
+        }
+        T Distance( T acc ) const { return std::sqrt( acc ); }
+    };
+
+    //------------------------------------------------------------
+    // Call kernel( policy ) with the policy of metric.
+    // Kernel is a functor with a template operator() of the policy.
+    // invScale: WeightedEuclidean 1 / scale of each embedding column
+    //------------------------------------------------------------
+    template< class T, class Kernel >
+    void Dispatch( DistanceMetric metric, const T *invScale, Kernel & kernel ) {
+        switch ( metric ) {
+        case DistanceMetric::Euclidean:
+            kernel( Euclidean< T >() );         break;
+        case DistanceMetric::SquaredEuclidean:
+            kernel( SquaredEuclidean< T >() );  break;
+        case DistanceMetric::Manhattan:
+            kernel( Manhattan< T >() );         break;
+        case DistanceMetric::Chebyshev:
+            kernel( Chebyshev< T >() );         break;
+        case DistanceMetric::WeightedEuclidean:
+            kernel( WeightedEuclidean< T >( invScale ) ); break;
+        }
+    }
+}
+#endif
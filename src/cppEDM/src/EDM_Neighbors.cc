@@ -34,16 +34,18 @@ void EDM::PrepareEmbedding( bool checkDataRows ) {
     if ( parameters.embedded ) {
         // data is a multivariable block, no embedding needed
         // Select the specified columns into embedding
+        DataFrame< double > block;
         if ( parameters.columnNames.size() ) {
-            embedding = data.DataFrameFromColumnNames( parameters.columnNames );
+            block = data.DataFrameFromColumnNames( parameters.columnNames );
         }
         else if ( parameters.columnIndex.size() ) {
-            embedding = data.DataFrameFromColumnIndex( parameters.columnIndex );
+            block = data.DataFrameFromColumnIndex( parameters.columnIndex );
         }
         else {
             throw std::runtime_error( "PrepareEmbedding(): colNames and "
                                       " colIndex are empty.\n" );
         }
+        embedding = EmbeddingView( block );
     }
     else {
         // embedded = false: Create time-delay embedding via EmbedData()
@@ -79,10 +81,13 @@ void EDM::PrepareEmbedding( bool checkDataRows ) {
 // Required that EDM::Distances() has been called.
 //
 // Writes to EDM object:
-//   knn_distances  :  sorted knn distances
-//   knn_neighbors  :  library neighbor rows of knn_distances
-//   ties           :  pred row vector of bool, true if tie
-//   tiePairs       :  pred row vector of < distance, libRow > pairs
+//   knnTable  :  sorted knn distances and library neighbor rows,
+//                Simplex tied library rows in the tie overflow
+//   knnSmap   :  SMap knn found of each pred row
+//
+// parameters.partialDistance : PartialDistanceSearch() of the
+// embedding instead of the Distances() matrix
+// parameters.approxTrees : approximate ForestSearch() of the embedding
 //----------------------------------------------------------------
 void EDM::FindNeighbors() {
 
@@ -95,6 +100,8 @@ void EDM::FindNeighbors() {
         throw( std::runtime_error( errMsg ) );
     }
 
+    states = DataFrame< double >(); // prediction rows, not query states
+
     if ( parameters.embedded and parameters.E != (int) embedding.NColumns() ) {
         std::stringstream errMsg;
         errMsg << "WARNING: FindNeighbors() Multivariate data "
@@ -137,240 +144,1317 @@ void EDM::FindNeighbors() {
                                         parameters.library.end() );
     int max_lib_index = *max_lib_it;
 
-    // allLibRows are the library row indices, 1 row x lib columns
-    std::valarray< size_t > rowLib = allLibRows.Row( 0 );
+    // Allocate the neighbor table in EDM class, with the knn distances
+    // in the precision of the pred : lib distances
+    knnTable = NeighborTable( N_prediction_rows, parameters.knn,
+                              parameters.singlePrecision );
 
-    //-----------------------------------------------------------------
-    // Pair the distances and library row indices for sort on distance.
-    // Filter out library nn that are "invalid".
-    // Output predPairs is a "matrix" of prediction : library rows.
-    // Each predPairs vector member correponds to a prediction row.
-    // Each member is a vector of < distance, libRow (nn) > pairs.
-    //-----------------------------------------------------------------
-    std::vector< std::vector< std::pair< double, size_t > > >
-        predPairs( N_prediction_rows );
+    knnSmap = std::vector< size_t > ( N_prediction_rows, parameters.knn );
 
-    for ( size_t pred_row = 0; pred_row < N_prediction_rows; pred_row++ ) {
+    if ( parameters.partialDistance or parameters.approxTrees ) {
+        // Search the embedding directly, there is no distance matrix
+        SearchEmbedding( parameters.approxTrees ? NeighborSearch::Approximate :
+                                                  NeighborSearch::Partial,
+                         max_lib_index );
+
+        if ( parameters.verbose ) {
+            std::stringstream msg;
+            msg << "FindNeighbors(): " << ( parameters.approxTrees ?
+                                            "Approximate" : "Partial distance" )
+                << " search evaluated "
+                << dimensionsEvaluated << " of " << dimensionsTotal
+                << " dimensions ("
+                << ( dimensionsTotal ?
+                     100. * dimensionsEvaluated / dimensionsTotal : 0. )
+                << "%)." << std::endl;
+            std::cout << msg.str();
+        }
+    }
+    else {
+        // allLibRows are the library row indices, 1 row x lib columns
+        DataFrameSpan< NeighborIndex > rowLib = allLibRows.RowSpan( 0 );
+
+        //-------------------------------------------------------------
+        // For each prediction row pair the distances and library row
+        // indices for sort on distance, filtering out library nn that
+        // are "invalid", then insert the knn nearest into knnTable.
+        // rowPair is the vector of < distance, libRow (nn) > pairs of
+        // the prediction row, reused for every row.
+        //-------------------------------------------------------------
+        std::vector< std::pair< double, size_t > > rowPair;
+        rowPair.reserve( rowLib.size() );
+
+        for ( size_t pred_row = 0; pred_row < N_prediction_rows; pred_row++ ) {
+
+            // Distances of pred_row: double, or float if singlePrecision
+            const double *rowDist      = nullptr;
+            const float  *rowDistFloat = nullptr;
+            if ( parameters.singlePrecision ) {
+                rowDistFloat = allDistancesFloat.RowSpan( pred_row ).data();
+            }
+            else {
+                rowDist = allDistances.RowSpan( pred_row ).data();
+            }
 
-        std::valarray< double > rowDist = allDistances.Row( pred_row );
+            // The actual prediction row specified by user (zero offset)
+            size_t predictionRow = parameters.prediction[ pred_row ];
 
-        size_t predictionRow = parameters.prediction[ pred_row ];
+            rowPair.clear();
 
-        // The library < distance, libRow (nn) > pairs for each pred_row
-        std::vector< std::pair< double, size_t > > rowPairs;
+            // Process all library distance, nn for this pred_row
+            for ( size_t i = 0; i < rowLib.size(); i++ ) {
+                size_t libRow = rowLib[ i ];
 
-        //------------------------------------------------------
-        // Process all library distance, nn for this pred_row
-        //------------------------------------------------------
-        for ( size_t i = 0; i < rowDist.size(); i++ ) {
-            size_t libRow   = rowLib[ i ];
-            int    libRowTp = (int) libRow + parameters.Tp;
+                if ( ExcludeNeighbor( predictionRow, libRow, max_lib_index ) ) {
+                    continue; // keep looking
+                }
 
-            //--------------------------------------------------
-            // Exclude library rows : don't inlcude in rowPairs
-            //--------------------------------------------------
-            // "Leave-one-out"
-            if ( libRow == predictionRow ) {
-                continue; // keep looking
+                // Add this distance, libRow (nn) to the rowPair
+                double distance = rowDist ? rowDist[ i ] : rowDistFloat[ i ];
+                rowPair.push_back( std::make_pair( distance, libRow ) );
             }
 
-            // Reach exceeding grasp : forecast point is outside library
-            if ( libRowTp > max_lib_index ) {
-               continue; // keep looking
+            // sort < distance, libRow > pairs for this pred_row
+            // distance must be .first
+            std::sort( rowPair.begin(), rowPair.end(), DistanceCompare );
+
+            InsertNeighbors( pred_row, rowPair );
+        }
+    }
+
+#ifdef DEBUG_ALL
+    for ( size_t i = 0; i < knnTable.NRows(); i++ ) {
+        size_t predictionRow = parameters.prediction[ i ];
+
+        if ( knnTable.Tie( i ) ) {
+            // Ties are at the knn-th neighbor distance
+            double dist = knnTable.Distance( i, parameters.knn - 1 );
+            std::cout << "Ties at pred " << predictionRow << " ";
+            for ( size_t j = 0; j < knnTable.NTies( i ); j++ ) {
+                size_t prow = knnTable.Ties( i )[ j ];
+                std::cout << "[" << prow << " : " <<  dist << "] ";
+            } std::cout << std::endl;
+        }
+    }
+    PrintNeighbors();
+#endif
+}
+
+//----------------------------------------------------------------
+// True if library row libRow is not a neighbor of predictionRow:
+// the same row ("leave-one-out"), libRow + Tp outside the library,
+// or libRow within the exclusion radius of predictionRow
+//----------------------------------------------------------------
+bool EDM::ExcludeNeighbor( size_t predictionRow,
+                           size_t libRow,
+                           int    max_lib_index ) const {
+
+    // "Leave-one-out"
+    if ( libRow == predictionRow ) {
+        return true;
+    }
+
+    if ( ExcludeTarget( libRow, max_lib_index ) ) {
+        return true;
+    }
+
+    // Exclusion radius: units are data rows, not time
+    if ( parameters.exclusionRadius ) {
+        int delta_i = std::abs( (int) predictionRow - (int) libRow );
+        if ( delta_i <= parameters.exclusionRadius ) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//----------------------------------------------------------------
+// True if the target of library row libRow, Tp ahead, is outside
+// the library: reach exceeding grasp
+//----------------------------------------------------------------
+bool EDM::ExcludeTarget( size_t libRow, int max_lib_index ) const {
+
+    int libRowTp = (int) libRow + parameters.Tp;
+
+    if ( libRowTp > max_lib_index ) {
+        return true;
+    }
+    if ( libRowTp < 0 ) {
+        if ( parameters.embedded ) {
+            return true;
+        }
+        else if ( libRowTp < parameters.tau * ( parameters.E - 1 ) ) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//----------------------------------------------------------------
+// Insert the knn nearest of the sorted < distance, libRow > pairs
+// of prediction row pred_row into knnTable, with the Simplex ties.
+//----------------------------------------------------------------
+void EDM::InsertNeighbors(
+    size_t pred_row,
+    const std::vector< std::pair< double, size_t > > & rowPair ) {
+
+    // The actual prediction row specified by user (zero offset)
+    size_t predictionRow = parameters.prediction[ pred_row ];
+
+    int rowPairSize = (int) rowPair.size();
+
+    NeighborIndex *knnLibRows = knnTable.Neighbors( pred_row );
+
+    int k = 0;
+
+    while ( k < parameters.knn ) {
+
+        // Check for failure to find knn neighbors
+        if ( k >= rowPairSize ) {
+
+            if ( parameters.method == Method::SMap ) {
+                knnSmap[ pred_row ] = k;  // Save this reduced knn
             }
-            if ( libRowTp < 0 ) {
-                if ( parameters.embedded ) {
-                    continue; // keep looking
+
+            if ( parameters.verbose ) {
+                std::stringstream errMsg;
+                if ( k == 0) {
+                    errMsg << "WARNING: FindNeighbors(): No neighbors found"
+                           << " for prediction row " << predictionRow
+                           << std::endl;
                 }
                 else {
-                    if ( libRowTp < parameters.tau * ( parameters.E - 1 ) ) {
-                        continue; // keep looking
-                    }
+                    errMsg << "WARNING: FindNeighbors(): "
+                           << "knn search failed to find " << parameters.knn
+                           << " neighbors in the library at prediction row "
+                           << predictionRow << ". Found "
+                           << k << "." << std::endl;
                 }
+                std::cout << errMsg.str();
             }
 
-            // Exclusion radius: units are data rows, not time
-            if ( parameters.exclusionRadius ) {
-                int delta_i = std::abs( (int) predictionRow - (int) libRow );
-                if ( delta_i <= parameters.exclusionRadius ) {
-                    continue; // keep looking
+            break; // Continue to next predictionRow
+        }
+
+        knnTable.SetDistance( pred_row, k, rowPair[ k ].first ); // distance
+        knnLibRows[ k ] = (NeighborIndex) rowPair[ k ].second;   // libRow
+        k++;
+    }
+
+    //----------------------------------------------------------------
+    // Check for ties.
+    // Store the tied library rows of the row in the knnTable tie
+    // overflow for Simplex.
+    // Note: A tie exists only if the k-th nn has distance equal
+    //       to the k+1 nn. Multiple ties can exist beyond k+1. 
+    //----------------------------------------------------------------
+    if ( parameters.method == Method::Simplex and k > 0 ) {
+
+        // Is there a tie?  A quick check.
+        // Note k was post incremented in loop above
+        bool   knnDistanceTie = false;
+        double tieDistance    = knnTable.Distance( pred_row,
+                                                   parameters.knn - 1 );
+        size_t tieNNindex     = knnLibRows[ parameters.knn - 1 ];
+        size_t rowPairFirstTieIndex = 0;
+
+        // First, find the NN index in rowPair[].second that matches
+        // that of the terminal knn value, store in rowPairFirstTieIndex
+        for ( size_t i = 0; i < rowPair.size(); i++ ) {
+            if ( rowPair[ i ].second == tieNNindex ) {
+                rowPairFirstTieIndex = i;
+                break;
+            }
+        }
+
+        if ( rowPairFirstTieIndex + 1 < rowPair.size() and
+             tieDistance == rowPair[ rowPairFirstTieIndex + 1 ].first ) {
+            knnDistanceTie = true;
+        }
+
+        // If there is a tie, populate the tie overflow for Simplex
+        if ( knnDistanceTie ) {
+            // At least one tie... find the first tie in knn
+            size_t firstTieIndex = 0;
+            for ( size_t i = 0; i < (size_t) parameters.knn; i++ ) {
+                if ( knnTable.Distance( pred_row, i ) == tieDistance ) {
+                    firstTieIndex = i;
+                    break;
                 }
             }
 
-            // Add this distance, libRow (nn) to the rowPairs
-            rowPairs.push_back( std::make_pair( rowDist[ i ], rowLib[ i ] ) );
+            // Save knn firstTieIndex for Simplex
+            knnTable.SetTieFirstIndex( pred_row, firstTieIndex );
+
+            // Start looking at rowPairFirstTieIndex
+            size_t kk = rowPairFirstTieIndex;
+            while( kk < rowPair.size() - 1 and
+                   rowPair[ kk ].first == rowPair[ kk + 1 ].first ) {
+                knnTable.AddTie( rowPair[ kk ].second );
+                kk++;
+            }
+
+            // Add the final tie since the above loop is pairs
+            knnTable.AddTie( rowPair[ kk ].second );
+        } // if ( knnDistanceTie )
+    } // if ( parameters.method == Method::Simplex ) {
+
+    knnTable.EndRow( pred_row );
+}
+
+//---------------------------------------------------------------------
+// Partial distance search of the knn neighbors of each prediction row
+// in the embedding view source, without the pred : lib distance matrix.
+//
+// The metric accumulation of a library row (the squared distance for
+// Euclidean) is taken over the embedding dimensions in order of
+// decreasing library variance, and the row rejected as soon as the
+// partial accumulation exceeds the running knn-th smallest of the
+// prediction row, kept in a max heap. Library rows not rejected were
+// within the knn-th distance when evaluated, so they include every
+// neighbor and tie of the full search; they are sorted and inserted
+// as in FindNeighbors(). Distances may differ from Distances() in the
+// last bit by the summation order, so neighbors at nearly equal
+// distance can differ.
+//
+// Counts the terms accumulated in dimensionsEvaluated, of
+// dimensionsTotal for the full search.
+//---------------------------------------------------------------------
+template< class T, class Metric >
+void EDM::PartialDistanceSearch( const T      * source,   // row 0
+                                 const T      * invScale, // or nullptr
+                                 int            max_lib_index,
+                                 const Metric & metric ) {
+
+    size_t        stride = embedding.Stride();
+    const size_t *offset = embedding.Offsets();
+    size_t        nDim   = embedding.NColumns();
+    size_t        knn    = (size_t) parameters.knn;
+
+    // allLibRows are the library row indices, 1 row x lib columns
+    DataFrameSpan< NeighborIndex > rowLib = allLibRows.RowSpan( 0 );
+
+    //-----------------------------------------------------------------
+    // Embedding columns in order of decreasing library variance, of
+    // the scaled columns for WeightedEuclidean
+    //-----------------------------------------------------------------
+    std::vector< double > variance( nDim, 0 );
+    for ( size_t j = 0; j < nDim; j++ ) {
+        double mean = 0;
+        double m2   = 0;
+        for ( size_t i = 0; i < rowLib.size(); i++ ) {
+            double x     = source[ rowLib[ i ] * stride + offset[ j ] ];
+            double delta = x - mean;
+            mean += delta / ( i + 1 );
+            m2   += delta * ( x - mean );
         }
+        variance[ j ] = invScale ? m2 * invScale[ j ] * invScale[ j ] : m2;
+    }
+
+    std::vector< size_t > order( nDim );
+    std::iota( order.begin(), order.end(), 0 );
+    std::stable_sort( order.begin(), order.end(),
+                      [&variance]( size_t a, size_t b ) {
+                          return variance[ a ] > variance[ b ];
+                      } );
 
-        // Insert into predPairs
-        predPairs[ pred_row ] = rowPairs;
+    std::vector< size_t > searchOffset( nDim );
+    for ( size_t j = 0; j < nDim; j++ ) {
+        searchOffset[ j ] = offset[ order[ j ] ];
     }
+    const size_t *column = order.data(); // metric column of searchOffset
 
-    // Allocate objects in EDM class
-    // JP Put on heap & destructor, or use smart pointers
-    knn_neighbors = DataFrame  < size_t >( N_prediction_rows, parameters.knn );
-    knn_distances = DataFrame  < double >( N_prediction_rows, parameters.knn );
+    dimensionsEvaluated = 0;
+    dimensionsTotal     = 0;
 
-    ties          = std::vector< bool   >( N_prediction_rows, false );
-    tieFirstIndex = std::vector< size_t >( N_prediction_rows, 0     );
-    tiePairs      = std::vector< std::vector< std::pair< double, size_t > > >
-                    ( N_prediction_rows );
+    std::vector< T > heap; // knn smallest accumulations, max heap
+    heap.reserve( knn );
 
-    knnSmap = std::vector< size_t > ( N_prediction_rows, parameters.knn );
+    // < distance, libRow > of library rows not rejected
+    std::vector< std::pair< double, size_t > > rowPair;
 
-    //-------------------------------------------------------------------
-    // For each prediction vector (row in prediction DataFrame) find
-    // library indices that are within knn points
-    //-------------------------------------------------------------------
-    for ( size_t predPair_i = 0; predPair_i < predPairs.size(); predPair_i++ ) {
+    for ( size_t pred_row = 0; pred_row < knnTable.NRows(); pred_row++ ) {
 
-        // The actual prediction row specified by user (zero offset)
-        size_t predictionRow = parameters.prediction[ predPair_i ];
+        size_t   predictionRow = parameters.prediction[ pred_row ];
+        const T *v1            = source + predictionRow * stride;
 
-        // rowPair is a vector of <distance, lib> pairs of length library rows
-        // Get the rowPair for this prediction row
-        std::vector< std::pair<double, size_t> > rowPair = predPairs[predPair_i];
+        T threshold = std::numeric_limits< T >::max(); // knn-th smallest
+        heap.clear();
+        rowPair.clear();
 
-        int rowPairSize = (int) rowPair.size();
+        for ( size_t i = 0; i < rowLib.size(); i++ ) {
+            size_t libRow = rowLib[ i ];
+
+            if ( ExcludeNeighbor( predictionRow, libRow, max_lib_index ) ) {
+                continue;
+            }
+
+            const T *v2 = source + libRow * stride;
+
+            T      acc = 0;
+            size_t d   = 0;
+            while ( d < nDim ) {
+                acc = metric.Add( acc, v2[ searchOffset[ d ] ] -
+                                       v1[ searchOffset[ d ] ], column[ d ] );
+                d++;
+                if ( acc > threshold ) {
+                    break; // rejected
+                }
+            }
+            dimensionsEvaluated += d;
+            dimensionsTotal     += nDim;
+
+            if ( acc > threshold ) {
+                continue;
+            }
+
+            rowPair.push_back( std::make_pair( (double) metric.Distance( acc ),
+                                               libRow ) );
+
+            // Update the running knn-th smallest accumulation;
+            // NaN accumulations are kept in rowPair as the full search does
+            if ( knn and acc <= threshold ) {
+                if ( heap.size() < knn ) {
+                    heap.push_back( acc );
+                    std::push_heap( heap.begin(), heap.end() );
+                    if ( heap.size() == knn ) {
+                        threshold = heap.front();
+                    }
+                }
+                else if ( acc < heap.front() ) {
+                    std::pop_heap( heap.begin(), heap.end() );
+                    heap.back() = acc;
+                    std::push_heap( heap.begin(), heap.end() );
+                    threshold = heap.front();
+                }
+            }
+        }
 
-        // sort < distance, libRow > pairs for this predPair_i
-        // distance must be .first
         std::sort( rowPair.begin(), rowPair.end(), DistanceCompare );
 
-        //----------------------------------------------------------------
-        // Insert knn distance / library row index into knn vectors
-        //----------------------------------------------------------------
-        std::valarray< double > knnDistances( nan("knn"), parameters.knn );
-        std::valarray< size_t > knnLibRows  ( (size_t) 0, parameters.knn );
+        InsertNeighbors( pred_row, rowPair );
+    }
+}
+
+//---------------------------------------------------------------------
+// Neighbors of the prediction rows searched in the embedding, in
+// the precision of the distances, by the distance metric policy:
+//   Partial     : PartialDistanceSearch()
+//   Approximate : ForestSearch() of the forest, built on first use
+//   Exact       : ForestSearch() of all library rows
+//---------------------------------------------------------------------
+void EDM::SearchEmbedding( NeighborSearch search, int max_lib_index ) {
+    if ( parameters.singlePrecision ) {
+        SearchEmbedding( embedding.RowBaseFloat( 0 ), search, max_lib_index );
+    }
+    else {
+        SearchEmbedding( embedding.RowBase( 0 ), search, max_lib_index );
+    }
+}
+
+template< class T >
+void EDM::SearchEmbedding( const T      * source, // row 0
+                           NeighborSearch search,
+                           int            max_lib_index ) {
+
+    std::vector< T > invScale = InverseScales< T >();
+    const T *scale = invScale.size() ? invScale.data() : nullptr;
+
+    if ( search == NeighborSearch::Partial ) {
+        PartialDistanceKernel< T > kernel = {
+            *this, source, scale, max_lib_index };
+
+        EDM_Metric::Dispatch( parameters.metric, scale, kernel );
+        return;
+    }
+
+    if ( search == NeighborSearch::Approximate and not forest.NTrees() ) {
+        BuildForest( source, scale );
+    }
+
+    ForestSearchKernel< T > kernel = {
+        *this, source, max_lib_index, search == NeighborSearch::Exact };
+
+    EDM_Metric::Dispatch( parameters.metric, scale, kernel );
+}
+
+//---------------------------------------------------------------------
+// Projection forest of the parameters.library rows for the
+// approximate search, in the precision of the distances
+//---------------------------------------------------------------------
+void EDM::BuildForest() {
+    if ( parameters.singlePrecision ) {
+        // As Distances(): SMap solves with the double embedding
+        embedding.SinglePrecision( parameters.method == Method::SMap );
+
+        std::vector< float > invScale = InverseScales< float >();
+        BuildForest( embedding.RowBaseFloat( 0 ),
+                     invScale.size() ? invScale.data() : nullptr );
+    }
+    else {
+        std::vector< double > invScale = InverseScales< double >();
+        BuildForest( embedding.RowBase( 0 ),
+                     invScale.size() ? invScale.data() : nullptr );
+    }
+}
+
+template< class T >
+void EDM::BuildForest( const T * source, const T * invScale ) {
+
+    // Leaves of 2 knn library rows, at least 16
+    size_t leafSize = std::max( (size_t) 2 * parameters.knn, (size_t) 16 );
 
-        int k = 0;
+    std::vector< NeighborIndex > libRows( parameters.library.begin(),
+                                          parameters.library.end() );
 
-        while ( k < parameters.knn ) {
+    forest.Build( source, embedding.Stride(), embedding.Offsets(),
+                  embedding.NColumns(), invScale,
+                  libRows.data(), libRows.size(),
+                  parameters.approxTrees, leafSize, parameters.seed );
+}
+
+//---------------------------------------------------------------------
+// Approximate search of the knn neighbors of each prediction row
+// in the projection forest of the library rows.
+//
+// Library rows of the forest leaves are visited best first until
+// approxTrees * leafSize distinct rows are visited, and at least knn
+// are valid neighbors or the forest is exhausted. Distances of the
+// visited rows are computed as in Distances(), then sorted and
+// inserted as in FindNeighbors().
+//
+// exhaustive = true visits all library rows: the exact neighbors,
+// with the distances of the approximate search.
+//
+// Counts the distance terms of the visited rows in
+// dimensionsEvaluated, of dimensionsTotal for the full search.
+//---------------------------------------------------------------------
+template< class T, class Metric >
+void EDM::ForestSearch( const T      * source,  // row 0
+                        int            max_lib_index,
+                        bool           exhaustive,
+                        const Metric & metric ) {
+
+    size_t        stride = embedding.Stride();
+    const size_t *offset = embedding.Offsets();
+    size_t        nDim   = embedding.NColumns();
+    size_t        knn    = (size_t) parameters.knn;
+    size_t        Npred  = knnTable.NRows();
+    size_t        budget = (size_t) parameters.approxTrees * forest.LeafSize();
+
+    // allLibRows are the library row indices, 1 row x lib columns
+    DataFrameSpan< NeighborIndex > rowLib = allLibRows.RowSpan( 0 );
+
+    dimensionsEvaluated = 0;
+    dimensionsTotal     = 0;
+
+    // Prediction row that last visited each embedding row: rows are
+    // in the leaves of every tree
+    std::vector< size_t > visitedBy( embedding.NRows(), Npred );
+
+    // < distance, libRow > of the visited valid library rows
+    std::vector< std::pair< double, size_t > > rowPair;
+
+    for ( size_t pred_row = 0; pred_row < Npred; pred_row++ ) {
+
+        size_t   predictionRow = parameters.prediction[ pred_row ];
+        const T *v1            = source + predictionRow * stride;
+        size_t   visited       = 0;
 
-            // Check for failure to find knn neighbors
-            if ( k >= rowPairSize ) {
+        rowPair.clear();
 
-                if ( parameters.method == Method::SMap ) {
-                    knnSmap[ predPair_i ] = k;  // Save this reduced knn
+        auto visit = [&]( const NeighborIndex * begin,
+                          const NeighborIndex * end ) {
+            for ( const NeighborIndex *row = begin; row != end; ++row ) {
+                size_t libRow = *row;
+
+                if ( visitedBy[ libRow ] == pred_row ) {
+                    continue; // in a leaf of a previous tree
                 }
+                visitedBy[ libRow ] = pred_row;
+                visited++;
 
-                if ( parameters.verbose ) {
-                    std::stringstream errMsg;
-                    if ( k == 0) {
-                        errMsg << "WARNING: FindNeighbors(): No neighbors found"
-                               << " for prediction row " << predictionRow
-                               << std::endl;
-                    }
-                    else {
-                        errMsg << "WARNING: FindNeighbors(): "
-                               << "knn search failed to find " << parameters.knn
-                               << " neighbors in the library at prediction row "
-                               << predictionRow << ". Found "
-                               << k << "." << std::endl;
-                    }
-                    std::cout << errMsg.str();
+                if ( ExcludeNeighbor( predictionRow, libRow,
+                                      max_lib_index ) ) {
+                    continue;
                 }
 
-                break; // Continue to next predictionRow
-            }
+                // Distance as EmbeddingDistances()
+                const T *v2 = source + libRow * stride;
 
-            knnDistances[ k ] = rowPair[ k ].first;  // distance
-            knnLibRows  [ k ] = rowPair[ k ].second; // libRow
-            k++;
-        }
-
-        knn_distances.WriteRow( predPair_i, knnDistances );
-        knn_neighbors.WriteRow( predPair_i, knnLibRows   );
-
-        //----------------------------------------------------------------
-        // Check for ties.
-        // Set EDM class ties[predPair_i] = true; anyTies = true if found.
-        // Store all tied { nn, distance } pairs in EDM :: tiePairs vector.
-        // Note: A tie exists only if the k-th nn has distance equal
-        //       to the k+1 nn. Multiple ties can exist beyond k+1. 
-        //----------------------------------------------------------------
-        if ( parameters.method == Method::Simplex and k > 0 ) {
-
-            // Is there a tie?  A quick check.
-            // Note k was post incremented in loop above
-            bool   knnDistanceTie       = false;
-            double tieDistance          = knnDistances[ parameters.knn - 1 ];
-            size_t tieNNindex           = knnLibRows  [ parameters.knn - 1 ];
-            size_t rowPairFirstTieIndex = 0;
-
-            // First, find the NN index in rowPair[].second that matches
-            // that of the terminal knn value, store in rowPairFirstTieIndex
-            for ( size_t i = 0; i < rowPair.size(); i++ ) {
-                if ( rowPair[ i ].second == tieNNindex ) {
-                    rowPairFirstTieIndex = i;
-                    break;
+                T acc = 0;
+                for ( size_t i = 0; i < nDim; i++ ) {
+                    acc = metric.Add( acc, v2[ offset[ i ] ] -
+                                           v1[ offset[ i ] ], i );
                 }
+                rowPair.push_back(
+                    std::make_pair( (double) metric.Distance( acc ), libRow ) );
             }
+            return visited < budget or rowPair.size() < knn;
+        };
+
+        if ( exhaustive ) {
+            visit( rowLib.data(), rowLib.data() + rowLib.size() );
+        }
+        else {
+            forest.Search( v1, offset, visit );
+        }
 
-            if ( tieDistance == rowPair[ rowPairFirstTieIndex + 1 ].first ) {
-                knnDistanceTie = true;
+        dimensionsEvaluated += rowPair.size() * nDim;
+        dimensionsTotal     += rowLib.size()  * nDim;
+
+        std::sort( rowPair.begin(), rowPair.end(), DistanceCompare );
+
+        InsertNeighbors( pred_row, rowPair );
+    }
+}
+
+//---------------------------------------------------------------------
+// Recall diagnostic of the approximate neighbor search.
+// Required that FindNeighbors() has been called.
+//
+// For a random sample of parameters.recallSample prediction rows the
+// exact and approximate neighbors are searched, and the sample
+// predicted with each by predict(), the Simplex() or SMap() of the
+// subclass. Writes recallValues:
+//   recall    : approximate neighbors within the exact knn-th
+//               distance, of the exact neighbors
+//   rhoExact  : rho of the sample predictions, exact neighbors
+//   rhoApprox : rho of the sample predictions, approximate neighbors
+//
+// knnTable, knnSmap and parameters.prediction are restored; the
+// predictions are overwritten, predict() must follow.
+//---------------------------------------------------------------------
+void EDM::NeighborRecall( std::function< void() > predict ) {
+
+    size_t Npred   = parameters.prediction.size();
+    size_t nSample = std::min( (size_t) parameters.recallSample, Npred );
+
+    if ( not nSample or not parameters.approxTrees ) {
+        return;
+    }
+
+    int max_lib_index = *std::max_element( parameters.library.begin(),
+                                           parameters.library.end() );
+
+    // Random sample of the prediction rows, in order
+    std::vector< size_t > sample( Npred );
+    std::iota( sample.begin(), sample.end(), 0 );
+    std::mt19937 generator( parameters.seed );
+    std::shuffle( sample.begin(), sample.end(), generator );
+    sample.resize( nSample );
+    std::sort( sample.begin(), sample.end() );
+
+    std::vector< size_t > prediction = parameters.prediction;
+    std::vector< size_t > knnSmapAll = knnSmap;
+    NeighborTable         table      = std::move( knnTable );
+    bool                  verbose    = parameters.verbose;
+
+    parameters.prediction.clear();
+    for ( size_t row : sample ) {
+        parameters.prediction.push_back( prediction[ row ] );
+    }
+    parameters.verbose = false; // quiet diagnostic predictions
+
+    // Exact, then approximate neighbors and predictions of the sample
+    NeighborTable           exactTable;
+    std::valarray< double > exactPredictions;
+    std::valarray< double > approxPredictions;
+
+    for ( NeighborSearch search : { NeighborSearch::Exact,
+                                    NeighborSearch::Approximate } ) {
+        knnTable = NeighborTable( nSample, parameters.knn,
+                                  parameters.singlePrecision );
+        knnSmap  = std::vector< size_t >( nSample, parameters.knn );
+
+        SearchEmbedding( search, max_lib_index );
+
+        predict();
+
+        if ( search == NeighborSearch::Exact ) {
+            exactPredictions = predictions;
+            exactTable       = std::move( knnTable );
+        }
+        else {
+            approxPredictions = predictions;
+        }
+    }
+
+    // Approximate neighbors at most the exact knn-th distance
+    size_t nExact = 0;
+    size_t nFound = 0;
+    for ( size_t row = 0; row < nSample; row++ ) {
+        double maxDistance = -std::numeric_limits< double >::max();
+        for ( size_t k = 0; k < exactTable.NColumns(); k++ ) {
+            double distance = exactTable.Distance( row, k );
+            if ( not std::isnan( distance ) ) {
+                maxDistance = std::max( maxDistance, distance );
+                nExact++;
+            }
+        }
+        for ( size_t k = 0; k < knnTable.NColumns(); k++ ) {
+            double distance = knnTable.Distance( row, k );
+            if ( not std::isnan( distance ) and distance <= maxDistance ) {
+                nFound++;
             }
+        }
+    }
+
+    // Observations of the sample rows, as the target of neighbors
+    std::valarray< double > observations( nan( "recall" ), nSample );
+    for ( size_t row = 0; row < nSample; row++ ) {
+        int t = (int) parameters.prediction[ row ] + parameters.Tp -
+                embedShift;
+        if ( t >= 0 and t < (int) target.size() ) {
+            observations[ row ] = target[ t ];
+        }
+    }
+
+    recallValues.rows      = nSample;
+    recallValues.recall    = nExact ? double( nFound ) / nExact : 1;
+    recallValues.rhoExact  = ComputeError( observations,
+                                           exactPredictions  ).rho;
+    recallValues.rhoApprox = ComputeError( observations,
+                                           approxPredictions ).rho;
+
+    parameters.prediction = prediction;
+    parameters.verbose    = verbose;
+    knnTable              = std::move( table );
+    knnSmap               = knnSmapAll;
+
+    std::stringstream msg;
+    msg << "NeighborRecall(): approximate search of " << nSample
+        << " prediction rows recall@" << parameters.knn << " "
+        << recallValues.recall << " rho " << recallValues.rhoApprox
+        << " exact " << recallValues.rhoExact << " change "
+        << recallValues.rhoApprox - recallValues.rhoExact << std::endl;
+    std::cout << msg.str();
+}
+
+//---------------------------------------------------------------------
+// Neighbors of the external query state vectors, rows of queryStates
+// with the embedding columns in embedding column order, in place of
+// Distances() and FindNeighbors() of prediction rows. Required that
+// PrepareEmbedding() has been called.
+//
+// Writes to EDM object:
+//   states     : queryStates, predicted by Simplex() or SMap()
+//   knnTable   : knn neighbors of each state, as FindNeighbors()
+//   knnSmap    : SMap knn found of each state
+//   parameters.prediction : the state rows 0 : M-1
+//
+// States are not data rows: there is no leave-one-out, exclusion
+// radius or time. Library rows are excluded only if the target
+// Tp ahead is outside the library, ExcludeTarget().
+//---------------------------------------------------------------------
+void EDM::StateNeighbors( const DataFrame< double > & queryStates ) {
+
+    if ( not parameters.validated ) {
+        std::string errMsg( "StateNeighbors(): Parameters not validated." );
+        throw( std::runtime_error( errMsg ) );
+    }
+
+    if ( queryStates.NColumns() != embedding.NColumns() ) {
+        std::stringstream errMsg;
+        errMsg << "StateNeighbors(): The number of state columns ("
+               << queryStates.NColumns() << ") does not equal the number "
+               << "of embedding columns (" << embedding.NColumns() << ").\n";
+        throw std::runtime_error( errMsg.str() );
+    }
+
+    if ( not queryStates.NRows() or not parameters.library.size() ) {
+        std::stringstream errMsg;
+        errMsg << "StateNeighbors(): " << queryStates.NRows() << " states, "
+               << parameters.library.size() << " library rows.\n";
+        throw std::runtime_error( errMsg.str() );
+    }
+
+    states = queryStates;
+
+    size_t Nstates = states.NRows();
+
+    // State rows stand for the prediction rows in InsertNeighbors()
+    parameters.prediction.resize( Nstates );
+    std::iota( parameters.prediction.begin(), parameters.prediction.end(), 0 );
+
+    int max_lib_index = (int) *std::max_element( parameters.library.begin(),
+                                                 parameters.library.end() );
+
+    knnTable = NeighborTable( Nstates, parameters.knn,
+                              parameters.singlePrecision );
+
+    knnSmap = std::vector< size_t > ( Nstates, parameters.knn );
+
+    if ( parameters.singlePrecision ) {
+        // As Distances(): SMap solves with the double embedding
+        embedding.SinglePrecision( parameters.method == Method::SMap );
+
+        SearchStates( embedding.RowBaseFloat( 0 ), max_lib_index );
+    }
+    else {
+        SearchStates( embedding.RowBase( 0 ), max_lib_index );
+    }
+}
+
+//---------------------------------------------------------------------
+// StateSearch() of the states in the precision of the embedding
+// source. Each state is copied to a query vector of span elements
+// addressed as an embedding row: element j at Offsets()[ j ].
+//---------------------------------------------------------------------
+template< class T >
+void EDM::SearchStates( const T * source, int max_lib_index ) {
+
+    const size_t *offset = embedding.Offsets();
+    size_t        nDim   = embedding.NColumns();
+    size_t        span   = *std::max_element( offset, offset + nDim ) + 1;
+
+    std::vector< T > queries( states.NRows() * span, 0 );
+    for ( size_t row = 0; row < states.NRows(); row++ ) {
+        for ( size_t j = 0; j < nDim; j++ ) {
+            queries[ row * span + offset[ j ] ] = (T) states( row, j );
+        }
+    }
+
+    std::vector< T > invScale = InverseScales< T >();
+    const T *scale = invScale.size() ? invScale.data() : nullptr;
+
+    if ( parameters.approxTrees and not forest.NTrees() ) {
+        BuildForest( source, scale );
+    }
 
-            // If there is a tie, populate tiePairs for Simplex
-            if ( knnDistanceTie ) {
-                // At least one tie... find the first tie in knn
-                size_t firstTieIndex = 0;
-                for ( size_t i = 0; i < knnDistances.size(); i++ ) {
-                    if ( knnDistances[ i ] == tieDistance ) {
-                        firstTieIndex = i;
-                        break;
+    StateSearchKernel< T > kernel = {
+        *this, source, queries.data(), span, max_lib_index };
+
+    EDM_Metric::Dispatch( parameters.metric, scale, kernel );
+}
+
+//---------------------------------------------------------------------
+// knn neighbors of each query vector of the states: of the forest
+// leaves as ForestSearch() with approxTrees, else of all library rows.
+//
+// States are independent: parameters.nThreads workers take states
+// from an atomic counter, as SMap(). The nearest < distance, libRow >
+// pairs of each state are then inserted into knnTable in state order.
+//---------------------------------------------------------------------
+template< class T, class Metric >
+void EDM::StateSearch( const T      * source,  // row 0
+                       const T      * queries, // span per state
+                       size_t         span,
+                       int            max_lib_index,
+                       const Metric & metric ) {
+
+    size_t        stride  = embedding.Stride();
+    const size_t *offset  = embedding.Offsets();
+    size_t        nDim    = embedding.NColumns();
+    size_t        knn     = (size_t) parameters.knn;
+    size_t        Nstates = knnTable.NRows();
+    size_t        budget  = (size_t) parameters.approxTrees * forest.LeafSize();
+
+    std::vector< NeighborIndex > libRows( parameters.library.begin(),
+                                          parameters.library.end() );
+
+    std::vector< std::vector< std::pair< double, size_t > > >
+        statePairs( Nstates );
+
+    std::atomic< std::size_t >       stateCount( 0 );
+    std::queue< std::exception_ptr > exceptQ;
+    std::mutex                       q_mtx;
+
+    auto worker = [&]() {
+        // State that last visited each embedding row
+        std::vector< size_t > visitedBy( embedding.NRows(), Nstates );
+
+        std::size_t state = std::atomic_fetch_add( &stateCount,
+                                                   std::size_t(1) );
+        while ( state < Nstates ) {
+            try {
+                std::vector< std::pair< double, size_t > > & rowPair =
+                    statePairs[ state ];
+
+                const T *v1      = queries + state * span;
+                size_t   visited = 0;
+
+                auto visit = [&]( const NeighborIndex * begin,
+                                  const NeighborIndex * end ) {
+                    for ( const NeighborIndex *row = begin; row != end;
+                          ++row ) {
+                        size_t libRow = *row;
+
+                        if ( visitedBy[ libRow ] == state ) {
+                            continue; // in a leaf of a previous tree
+                        }
+                        visitedBy[ libRow ] = state;
+                        visited++;
+
+                        if ( ExcludeTarget( libRow, max_lib_index ) ) {
+                            continue;
+                        }
+
+                        // Distance as EmbeddingDistances()
+                        const T *v2 = source + libRow * stride;
+
+                        T acc = 0;
+                        for ( size_t i = 0; i < nDim; i++ ) {
+                            acc = metric.Add( acc, v2[ offset[ i ] ] -
+                                                   v1[ offset[ i ] ], i );
+                        }
+                        rowPair.push_back( std::make_pair(
+                            (double) metric.Distance( acc ), libRow ) );
                     }
+                    return visited < budget or rowPair.size() < knn;
+                };
+
+                if ( forest.NTrees() ) {
+                    forest.Search( v1, offset, visit );
+                }
+                else {
+                    visit( libRows.data(), libRows.data() + libRows.size() );
                 }
 
-                // Save knn firstTieIndex for Simplex
-                tieFirstIndex[ predPair_i ] = firstTieIndex;
+                SortNearest( rowPair, knn );
+            }
+            catch(...) {
+                // push exception pointer onto queue to rethrow,
+                // and stop all workers
+                std::lock_guard<std::mutex> lck( q_mtx );
+                exceptQ.push( std::current_exception() );
+                std::atomic_store( &stateCount, Nstates );
+            }
+
+            state = std::atomic_fetch_add( &stateCount, std::size_t(1) );
+        }
+    };
+
+    unsigned nThreads   = parameters.nThreads;
+    unsigned maxThreads = std::thread::hardware_concurrency();
+    if ( maxThreads and maxThreads < nThreads ) { nThreads = maxThreads; }
+    if ( nThreads > Nstates          ) { nThreads = (unsigned) Nstates; }
+    if ( nThreads < 1                ) { nThreads = 1; }
+
+    if ( nThreads == 1 ) {
+        worker();
+    }
+    else {
+        std::vector< std::thread > threads;
+        for ( unsigned t = 0; t < nThreads; t++ ) {
+            threads.push_back( std::thread( worker ) );
+        }
+        for ( auto &thrd : threads ) {
+            thrd.join();
+        }
+    }
+
+    if ( not exceptQ.empty() ) {
+        std::rethrow_exception( exceptQ.front() );
+    }
+
+    for ( size_t state = 0; state < Nstates; state++ ) {
+        InsertNeighbors( state, statePairs[ state ] );
+    }
+}
+
+//---------------------------------------------------------------------
+// knn neighbors of the prediction rows of cross validation folds:
+// fold f has the prediction rows [ foldStart[ f ], foldStart[ f+1 ] ).
+// Replaces Distances() and FindNeighbors(), PrepareEmbedding() has
+// been called.
+//
+// The fold block is the fold rows widened by foldBuffer rows. Library
+// rows with the embedding vector or target Tp ahead in the block are
+// excluded from the neighbors of each fold row, as well as those of
+// ExcludeNeighbor(). The distances of each prediction row are computed
+// once, for its own fold: there is no distance matrix.
+//---------------------------------------------------------------------
+void EDM::FoldNeighbors( const std::vector< size_t > & foldStart,
+                         int                           foldBuffer ) {
+
+    if ( not parameters.validated ) {
+        std::string errMsg( "FoldNeighbors(): Parameters not validated." );
+        throw( std::runtime_error( errMsg ) );
+    }
+
+    size_t Npred = parameters.prediction.size();
+
+    if ( foldStart.size() < 2 or foldStart.front() != 0 or
+         foldStart.back() != Npred or
+         not std::is_sorted( foldStart.begin(), foldStart.end() ) ) {
+        std::stringstream errMsg;
+        errMsg << "FoldNeighbors(): Invalid folds of " << Npred
+               << " prediction rows.\n";
+        throw std::runtime_error( errMsg.str() );
+    }
+
+    // Library rows are NeighborIndex in knnTable
+    if ( embedding.NRows() > std::numeric_limits< NeighborIndex >::max() ) {
+        std::stringstream errMsg;
+        errMsg << "FoldNeighbors() embedding rows " << embedding.NRows()
+               << " exceed the neighbor index range "
+               << std::numeric_limits< NeighborIndex >::max();
+        throw std::runtime_error( errMsg.str() );
+    }
+
+    states = DataFrame< double >(); // prediction rows, not query states
+
+    int max_lib_index = (int) *std::max_element( parameters.library.begin(),
+                                                 parameters.library.end() );
+
+    knnTable = NeighborTable( Npred, parameters.knn,
+                              parameters.singlePrecision );
+
+    knnSmap = std::vector< size_t > ( Npred, parameters.knn );
+
+    if ( parameters.singlePrecision ) {
+        // As Distances(): SMap solves with the double embedding
+        embedding.SinglePrecision( parameters.method == Method::SMap );
+
+        SearchFolds( embedding.RowBaseFloat( 0 ), foldStart, foldBuffer,
+                     max_lib_index );
+    }
+    else {
+        SearchFolds( embedding.RowBase( 0 ), foldStart, foldBuffer,
+                     max_lib_index );
+    }
+}
+
+//---------------------------------------------------------------------
+// FoldSearch() in the precision of the embedding source
+//---------------------------------------------------------------------
+template< class T >
+void EDM::SearchFolds( const T                     * source,
+                       const std::vector< size_t > & foldStart,
+                       int                           foldBuffer,
+                       int                           max_lib_index ) {
 
-                // List of rowTiePairs for Simplex
-                std::vector< std::pair< double, size_t > > rowTiePairs;
+    std::vector< T > invScale = InverseScales< T >();
+    const T *scale = invScale.size() ? invScale.data() : nullptr;
 
-                // Start looking at rowPairFirstTieIndex
-                size_t kk = rowPairFirstTieIndex;
-                while( kk < rowPair.size() - 1 and
-                       rowPair[ kk ].first == rowPair[ kk + 1 ].first ) {
+    FoldSearchKernel< T > kernel = {
+        *this, source, foldStart, foldBuffer, max_lib_index };
 
-                    // Set ties flag and store tie pairs in tiePairs for Simplex
-                    ties[ predPair_i ] = true;
+    EDM_Metric::Dispatch( parameters.metric, scale, kernel );
+}
 
-                    std::pair< double, size_t > thisPair =
-                        std::make_pair( rowPair[ kk ].first,
-                                        rowPair[ kk ].second );
+//---------------------------------------------------------------------
+// Fold neighbor search: parameters.nThreads workers take folds from
+// an atomic counter, as StateSearch(). Each prediction row scans the
+// library rows once, skipping the rows that reach into its fold block,
+// and keeps the nearest < distance, libRow > pairs. These are inserted
+// into knnTable in prediction row order.
+//---------------------------------------------------------------------
+template< class T, class Metric >
+void EDM::FoldSearch( const T                     * source,
+                      const std::vector< size_t > & foldStart,
+                      int                           foldBuffer,
+                      int                           max_lib_index,
+                      const Metric                & metric ) {
+
+    size_t        stride = embedding.Stride();
+    const size_t *offset = embedding.Offsets();
+    size_t        nDim   = embedding.NColumns();
+    size_t        knn    = (size_t) parameters.knn;
+    size_t        Npred  = knnTable.NRows();
+    size_t        Nfolds = foldStart.size() - 1;
+
+    // Rows of library row libRow: embedding vector and target,
+    // [ libRow + reachLo, libRow + reachHi ], as Parameters::Validate()
+    int embedReach = parameters.embedded ? 0 :
+                     parameters.tau * ( parameters.E - 1 );
+    int reachLo    = std::min( std::min( embedReach, parameters.Tp ), 0 );
+    int reachHi    = std::max( std::max( embedReach, parameters.Tp ), 0 );
 
-                    rowTiePairs.push_back( thisPair );
-                    kk++;
+    std::vector< std::vector< std::pair< double, size_t > > >
+        rowPairs( Npred );
+
+    std::atomic< std::size_t >       foldCount( 0 );
+    std::queue< std::exception_ptr > exceptQ;
+    std::mutex                       q_mtx;
+
+    auto worker = [&]() {
+        // Scan of the library rows, reused for every prediction row
+        std::vector< std::pair< double, size_t > > rowPair;
+        rowPair.reserve( parameters.library.size() );
+
+        std::size_t fold = std::atomic_fetch_add( &foldCount, std::size_t(1) );
+
+        while ( fold < Nfolds ) {
+            try {
+                size_t first = foldStart[ fold ];
+                size_t last  = foldStart[ fold + 1 ]; // one past
+
+                // Fold block of library rows, widened by foldBuffer
+                int blockStart = 0;
+                int blockEnd   = -1;
+                if ( first < last ) {
+                    blockStart = (int) parameters.prediction[ first    ] -
+                                 foldBuffer;
+                    blockEnd   = (int) parameters.prediction[ last - 1 ] +
+                                 foldBuffer;
                 }
 
-                // Add the final tie since the above loop is pairs
-                rowTiePairs.push_back( std::make_pair( rowPair[ kk ].first,
-                                                       rowPair[ kk ].second ) );
+                for ( size_t pred_row = first; pred_row < last; pred_row++ ) {
+                    size_t   predictionRow = parameters.prediction[ pred_row ];
+                    const T *v1            = source + predictionRow * stride;
+
+                    rowPair.clear();
+
+                    for ( size_t libRow : parameters.library ) {
+                        if ( (int) libRow + reachHi >= blockStart and
+                             (int) libRow + reachLo <= blockEnd ) {
+                            continue; // reaches into the fold block
+                        }
+                        if ( ExcludeNeighbor( predictionRow, libRow,
+                                              max_lib_index ) ) {
+                            continue;
+                        }
+
+                        // Distance as EmbeddingDistances()
+                        const T *v2 = source + libRow * stride;
+
+                        T acc = 0;
+                        for ( size_t i = 0; i < nDim; i++ ) {
+                            acc = metric.Add( acc, v2[ offset[ i ] ] -
+                                                   v1[ offset[ i ] ], i );
+                        }
+                        rowPair.push_back( std::make_pair(
+                            (double) metric.Distance( acc ), libRow ) );
+                    }
+
+                    SortNearest( rowPair, knn );
 
-                if ( find( ties.begin(), ties.end(), true ) != ties.end() ) {
-                    anyTies = true;
-                    tiePairs[ predPair_i ] = rowTiePairs;
+                    rowPairs[ pred_row ].assign( rowPair.begin(),
+                                                 rowPair.end() );
                 }
-            } // if ( knnDistanceTie )
-        } // if ( parameters.method == Method::Simplex ) {
-    } // for ( predPair_i = 0; predPair_i < predPairs.size(); predPair_i++ )
+            }
+            catch(...) {
+                // push exception pointer onto queue to rethrow,
+                // and stop all workers
+                std::lock_guard<std::mutex> lck( q_mtx );
+                exceptQ.push( std::current_exception() );
+                std::atomic_store( &foldCount, Nfolds );
+            }
 
-#ifdef DEBUG_ALL
-    for ( size_t i = 0; i < tiePairs.size(); i++ ) {
-        size_t predictionRow = parameters.prediction[ i ];
-        std::vector< std::pair< double, size_t > > rowTiePairs = tiePairs[ i ];
+            fold = std::atomic_fetch_add( &foldCount, std::size_t(1) );
+        }
+    };
 
-        if ( rowTiePairs.size() ) {
-            std::cout << "Ties at pred " << predictionRow << " ";
-            for ( size_t j = 0; j < rowTiePairs.size(); j++ ) {
-                double dist = rowTiePairs[ j ].first;
-                size_t prow = rowTiePairs[ j ].second;
-                std::cout << "[" << prow << " : " <<  dist << "] ";
-            } std::cout << std::endl;
+    unsigned nThreads   = parameters.nThreads;
+    unsigned maxThreads = std::thread::hardware_concurrency();
+    if ( maxThreads and maxThreads < nThreads ) { nThreads = maxThreads; }
+    if ( nThreads > Nfolds           ) { nThreads = (unsigned) Nfolds; }
+    if ( nThreads < 1                ) { nThreads = 1; }
+
+    if ( nThreads == 1 ) {
+        worker();
+    }
+    else {
+        std::vector< std::thread > threads;
+        for ( unsigned t = 0; t < nThreads; t++ ) {
+            threads.push_back( std::thread( worker ) );
+        }
+        for ( auto &thrd : threads ) {
+            thrd.join();
         }
     }
-    PrintNeighbors();
-#endif
+
+    if ( not exceptQ.empty() ) {
+        std::rethrow_exception( exceptQ.front() );
+    }
+
+    for ( size_t pred_row = 0; pred_row < Npred; pred_row++ ) {
+        InsertNeighbors( pred_row, rowPairs[ pred_row ] );
+    }
+}
+
+//---------------------------------------------------------------------
+// knn neighbors of the prediction rows of rolling forecast origins:
+// prediction row pred_row has the library of embedding rows
+// [ libFirst[ pred_row ], libLast[ pred_row ] ]. Replaces Distances()
+// and FindNeighbors(), PrepareEmbedding() has been called.
+//
+// Each library is a row range of the one embedding: a library grown
+// by appended rows, or a sliding window, is a wider or shifted range
+// with no embedding, forest or distance matrix rebuilt. Library rows
+// are excluded as ExcludeNeighbor() with the targets known at the
+// prediction row: libRow + Tp <= predictionRow.
+//---------------------------------------------------------------------
+void EDM::OriginNeighbors( const std::vector< size_t > & libFirst,
+                           const std::vector< size_t > & libLast ) {
+
+    if ( not parameters.validated ) {
+        std::string errMsg( "OriginNeighbors(): Parameters not validated." );
+        throw( std::runtime_error( errMsg ) );
+    }
+
+    size_t Npred = parameters.prediction.size();
+
+    if ( libFirst.size() != Npred or libLast.size() != Npred ) {
+        std::stringstream errMsg;
+        errMsg << "OriginNeighbors(): Library ranges of " << libFirst.size()
+               << " rows, " << Npred << " prediction rows.\n";
+        throw std::runtime_error( errMsg.str() );
+    }
+
+    for ( size_t pred_row = 0; pred_row < Npred; pred_row++ ) {
+        if ( libFirst[ pred_row ] > libLast[ pred_row ] or
+             libLast[ pred_row ] >= embedding.NRows() ) {
+            std::stringstream errMsg;
+            errMsg << "OriginNeighbors(): Invalid library rows "
+                   << libFirst[ pred_row ] << " " << libLast[ pred_row ]
+                   << " of prediction row "
+                   << parameters.prediction[ pred_row ] << ".\n";
+            throw std::runtime_error( errMsg.str() );
+        }
+    }
+
+    // Library rows are NeighborIndex in knnTable
+    if ( embedding.NRows() > std::numeric_limits< NeighborIndex >::max() ) {
+        std::stringstream errMsg;
+        errMsg << "OriginNeighbors() embedding rows " << embedding.NRows()
+               << " exceed the neighbor index range "
+               << std::numeric_limits< NeighborIndex >::max();
+        throw std::runtime_error( errMsg.str() );
+    }
+
+    states = DataFrame< double >(); // prediction rows, not query states
+
+    knnTable = NeighborTable( Npred, parameters.knn,
+                              parameters.singlePrecision );
+
+    knnSmap = std::vector< size_t > ( Npred, parameters.knn );
+
+    if ( parameters.singlePrecision ) {
+        // As Distances(): SMap solves with the double embedding
+        embedding.SinglePrecision( parameters.method == Method::SMap );
+
+        SearchOrigins( embedding.RowBaseFloat( 0 ), libFirst, libLast );
+    }
+    else {
+        SearchOrigins( embedding.RowBase( 0 ), libFirst, libLast );
+    }
+}
+
+//---------------------------------------------------------------------
+// OriginSearch() in the precision of the embedding source
+//---------------------------------------------------------------------
+template< class T >
+void EDM::SearchOrigins( const T                     * source,
+                         const std::vector< size_t > & libFirst,
+                         const std::vector< size_t > & libLast ) {
+
+    std::vector< T > invScale = InverseScales< T >();
+    const T *scale = invScale.size() ? invScale.data() : nullptr;
+
+    OriginSearchKernel< T > kernel = { *this, source, libFirst, libLast };
+
+    EDM_Metric::Dispatch( parameters.metric, scale, kernel );
+}
+
+//---------------------------------------------------------------------
+// Origin neighbor search: parameters.nThreads workers take prediction
+// rows from an atomic counter, as StateSearch(). Each prediction row
+// scans its library range once and keeps the nearest
+// < distance, libRow > pairs, inserted into knnTable in prediction
+// row order.
+//---------------------------------------------------------------------
+template< class T, class Metric >
+void EDM::OriginSearch( const T                     * source,
+                        const std::vector< size_t > & libFirst,
+                        const std::vector< size_t > & libLast,
+                        const Metric                & metric ) {
+
+    size_t        stride = embedding.Stride();
+    const size_t *offset = embedding.Offsets();
+    size_t        nDim   = embedding.NColumns();
+    size_t        knn    = (size_t) parameters.knn;
+    size_t        Npred  = knnTable.NRows();
+
+    std::vector< std::vector< std::pair< double, size_t > > >
+        rowPairs( Npred );
+
+    std::atomic< std::size_t >       rowCount( 0 );
+    std::queue< std::exception_ptr > exceptQ;
+    std::mutex                       q_mtx;
+
+    auto worker = [&]() {
+        // Scan of the library rows, reused for every prediction row
+        std::vector< std::pair< double, size_t > > rowPair;
+
+        std::size_t pred_row = std::atomic_fetch_add( &rowCount,
+                                                      std::size_t(1) );
+        while ( pred_row < Npred ) {
+            try {
+                size_t   predictionRow = parameters.prediction[ pred_row ];
+                const T *v1            = source + predictionRow * stride;
+
+                // Targets known at the prediction row
+                int max_lib_index = (int) predictionRow;
+
+                rowPair.clear();
+
+                for ( size_t libRow = libFirst[ pred_row ];
+                      libRow <= libLast[ pred_row ]; libRow++ ) {
+
+                    if ( ExcludeNeighbor( predictionRow, libRow,
+                                          max_lib_index ) ) {
+                        continue;
+                    }
+
+                    // Distance as EmbeddingDistances()
+                    const T *v2 = source + libRow * stride;
+
+                    T acc = 0;
+                    for ( size_t i = 0; i < nDim; i++ ) {
+                        acc = metric.Add( acc, v2[ offset[ i ] ] -
+                                               v1[ offset[ i ] ], i );
+                    }
+                    rowPair.push_back( std::make_pair(
+                        (double) metric.Distance( acc ), libRow ) );
+                }
+
+                SortNearest( rowPair, knn );
+
+                rowPairs[ pred_row ].assign( rowPair.begin(), rowPair.end() );
+            }
+            catch(...) {
+                // push exception pointer onto queue to rethrow,
+                // and stop all workers
+                std::lock_guard<std::mutex> lck( q_mtx );
+                exceptQ.push( std::current_exception() );
+                std::atomic_store( &rowCount, Npred );
+            }
+
+            pred_row = std::atomic_fetch_add( &rowCount, std::size_t(1) );
+        }
+    };
+
+    unsigned nThreads   = parameters.nThreads;
+    unsigned maxThreads = std::thread::hardware_concurrency();
+    if ( maxThreads and maxThreads < nThreads ) { nThreads = maxThreads; }
+    if ( nThreads > Npred            ) { nThreads = (unsigned) Npred; }
+    if ( nThreads < 1                ) { nThreads = 1; }
+
+    if ( nThreads == 1 ) {
+        worker();
+    }
+    else {
+        std::vector< std::thread > threads;
+        for ( unsigned t = 0; t < nThreads; t++ ) {
+            threads.push_back( std::thread( worker ) );
+        }
+        for ( auto &thrd : threads ) {
+            thrd.join();
+        }
+    }
+
+    if ( not exceptQ.empty() ) {
+        std::rethrow_exception( exceptQ.front() );
+    }
+
+    for ( size_t pred_row = 0; pred_row < Npred; pred_row++ ) {
+        InsertNeighbors( pred_row, rowPairs[ pred_row ] );
+    }
 }
 
 //--------------------------------------------------------------------- 
@@ -416,85 +1500,192 @@ void EDM::Distances () {
     size_t Npred = parameters.prediction.size();
     size_t Nlib  = parameters.library.size();
 
-    // Allocate output distance matrix and libRows list in EDM object
-    allDistances = DataFrame< double >( Npred, Nlib );
-    allLibRows   = DataFrame< size_t >( 1,     Nlib );
-
-    // Initialise D to DistanceMax
-    std::valarray< double > row_init( EDM_Distance::DistanceMax, Nlib );
-    for ( size_t row = 0; row < Npred; row++ ) {
-        allDistances.WriteRow( row, row_init );
+    // Library rows are NeighborIndex in allLibRows and knnTable
+    if ( embedding.NRows() > std::numeric_limits< NeighborIndex >::max() ) {
+        std::stringstream errMsg;
+        errMsg << "Distances() embedding rows " << embedding.NRows()
+               << " exceed the neighbor index range "
+               << std::numeric_limits< NeighborIndex >::max();
+        throw std::runtime_error( errMsg.str() );
     }
 
+    // Allocate libRows list in EDM object
+    allLibRows = DataFrame< NeighborIndex >( 1, Nlib );
+
     // Set lib indices into allLibRows
     for ( size_t col = 0; col < Nlib; col++ ) {
         allLibRows( 0, col ) = parameters.library[ col ];
     }
 
-    // Compute all prediction row : library row distances
-    for ( size_t predRow = 0; predRow < Npred; predRow++ ) {
+    // Allocate output distance matrix in EDM object and compute
+    // all prediction row : library row distances
+    if ( parameters.partialDistance or parameters.approxTrees ) {
+        // FindNeighbors() searches the embedding, no distance matrix
+        if ( parameters.singlePrecision ) {
+            embedding.SinglePrecision( parameters.method == Method::SMap );
+        }
+
+        allDistances      = DataFrame< double >();
+        allDistancesFloat = DataFrame< float  >();
+    }
+    else if ( parameters.singlePrecision ) {
+        // SMap solves with the double embedding, others release it
+        embedding.SinglePrecision( parameters.method == Method::SMap );
+
+        allDistances      = DataFrame< double >();
+        allDistancesFloat = DataFrame< float  >( Npred, Nlib );
+
+        std::vector< float > invScale = InverseScales< float >();
+
+        EmbeddingDistancesKernel< float > kernel = {
+            embedding.RowBaseFloat( 0 ), embedding.Stride(),
+            embedding.Offsets(), embedding.NColumns(),
+            parameters.prediction, parameters.library, allDistancesFloat };
+
+        EDM_Metric::Dispatch( parameters.metric, invScale.data(), kernel );
+    }
+    else {
+        allDistances      = DataFrame< double >( Npred, Nlib );
+        allDistancesFloat = DataFrame< float  >();
+
+        std::vector< double > invScale = InverseScales< double >();
+
+        EmbeddingDistancesKernel< double > kernel = {
+            embedding.RowBase( 0 ), embedding.Stride(),
+            embedding.Offsets(), embedding.NColumns(),
+            parameters.prediction, parameters.library, allDistances };
 
-        size_t predictionRow = parameters.prediction[ predRow ];
+        EDM_Metric::Dispatch( parameters.metric, invScale.data(), kernel );
+    }
+}
+
+//---------------------------------------------------------------------
+// WeightedEuclidean 1 / parameters.metricScales of each embedding
+// column, empty for the other metrics
+//---------------------------------------------------------------------
+template< class T >
+std::vector< T > EDM::InverseScales() const {
+
+    std::vector< T > invScale;
+
+    if ( parameters.metric == DistanceMetric::WeightedEuclidean ) {
+        if ( parameters.metricScales.size() != embedding.NColumns() ) {
+            std::stringstream errMsg;
+            errMsg << "Distances(): WeightedEuclidean has "
+                   << parameters.metricScales.size() << " metricScales for "
+                   << embedding.NColumns() << " embedding columns.\n";
+            throw std::runtime_error( errMsg.str() );
+        }
 
-        // Get E-dimensional vector from this prediction row
-        std::valarray< double > v1 = embedding.Row( predictionRow );
+        for ( double scale : parameters.metricScales ) {
+            invScale.push_back( (T) ( 1 / scale ) );
+        }
+    }
 
-        for ( size_t libRow = 0; libRow < Nlib; libRow++ ) {
+    return invScale;
+}
 
-            size_t libraryRow = parameters.library[ libRow ];
+// Instances of the distance precisions for EDMStream.cc
+template std::vector< double > EDM::InverseScales< double >() const;
+template std::vector< float  > EDM::InverseScales< float  >() const;
+
+//---------------------------------------------------------------------
+// Distances of the prediction : library embedding vectors read in
+// place from the embedding view rows, computed and stored in
+// precision T: float for parameters.singlePrecision, else double,
+// by the distance metric policy Metric (EDM_Metrics.h).
+// Degenerate pred = lib distances are the largest T, as DistanceMax.
+//---------------------------------------------------------------------
+template< class T, class Metric >
+void EmbeddingDistances( const T                     * source, // row 0
+                         size_t                        stride,
+                         const size_t                * offset,
+                         size_t                        nDim,
+                         const std::vector< size_t > & prediction,
+                         const std::vector< size_t > & library,
+                         const Metric                & metric,
+                         DataFrame< T >              & distances )
+{
+    // Initialise D to DistanceMax
+    distances.Elements() = std::numeric_limits< T >::max();
+
+    for ( size_t predRow = 0; predRow < prediction.size(); predRow++ ) {
+
+        size_t predictionRow = prediction[ predRow ];
+
+        // E-dimensional vector of this prediction row, read in place
+        const T *v1 = source + predictionRow * stride;
+
+        DataFrameSpan< T > distanceRow = distances.RowSpan( predRow );
+
+        for ( size_t libRow = 0; libRow < library.size(); libRow++ ) {
+
+            size_t libraryRow = library[ libRow ];
 
             if ( predictionRow == libraryRow ) {
                 continue;  // degenerate pred & lib : default DistanceMax
             }
 
-            // Find distance between vector (v1) and library vector v2
-            std::valarray< double > v2 = embedding.Row( libraryRow );
+            // Distance between v1 and library vector v2,
+            // as Distance( v1, v2, metric )
+            const T *v2 = source + libraryRow * stride;
 
-            allDistances( predRow, libRow ) =
-                Distance( v1, v2, DistanceMetric::Euclidean );
+            T acc = 0;
+            for ( size_t i = 0; i < nDim; i++ ) {
+                acc = metric.Add( acc, v2[ offset[ i ] ] - v1[ offset[ i ] ],
+                                  i );
+            }
+            distanceRow[ libRow ] = metric.Distance( acc );
         }
     }
 }
 
+//---------------------------------------------------------------------
+// Distance of v1 and v2 by the metric policy
+//---------------------------------------------------------------------
+struct VectorDistanceKernel {
+    const std::valarray< double > & v1;
+    const std::valarray< double > & v2;
+    double                          distance;
+
+    template< class Metric >
+    void operator()( const Metric & metric ) {
+        double acc = 0;
+        for ( size_t i = 0; i < v1.size(); i++ ) {
+            acc = metric.Add( acc, v2[ i ] - v1[ i ], i );
+        }
+        distance = metric.Distance( acc );
+    }
+};
+
 //----------------------------------------------------------------
-// 
+// scales: WeightedEuclidean scale of each element
 //----------------------------------------------------------------
 double Distance( const std::valarray< double > & v1,
                  const std::valarray< double > & v2,
-                 DistanceMetric metric )
+                 DistanceMetric                  metric,
+                 const std::vector< double >   & scales )
 {
-    double distance = 0;
-
     // For efficiency sake, we forego the usual validation of v1 & v2.
 
-    if ( metric == DistanceMetric::Euclidean ) {
-        double sum   = 0;
-        double delta = 0;
-        for ( size_t i = 0; i < v1.size(); i++ ) {
-            delta = v2[i] - v1[i];
-            sum  += delta * delta; // avoid call to pow()
+    std::vector< double > invScale;
+    if ( metric == DistanceMetric::WeightedEuclidean ) {
+        if ( scales.size() != v1.size() ) {
+            std::stringstream errMsg;
+            errMsg << "Distance() WeightedEuclidean has " << scales.size()
+                   << " scales for vectors of " << v1.size() << ".\n";
+            throw std::runtime_error( errMsg.str() );
         }
-        distance = sqrt( sum );
-
-        // Note: this implicit implementation is slower
-        // std::valarray<double> delta = v2 - v1;
-        // distance = sqrt( (delta * delta).sum() );
-    }
-    else if ( metric == DistanceMetric::Manhattan ) {
-        double sum = 0;
-        for ( size_t i = 0; i < v1.size(); i++ ) {
-            sum += fabs( v2[i] - v1[i] );
+        for ( double scale : scales ) {
+            invScale.push_back( 1 / scale );
         }
-        distance = sum;
-    }
-    else {
-        std::stringstream errMsg;
-        errMsg << "Distance() Invalid DistanceMetric: "
-               << static_cast<size_t>( metric );
-        throw std::runtime_error( errMsg.str() );
     }
 
-    return distance;
+    VectorDistanceKernel kernel = { v1, v2, 0 };
+
+    EDM_Metric::Dispatch( metric, invScale.data(), kernel );
+
+    return kernel.distance;
 }
 
 #ifdef DEBUG_ALL
@@ -528,14 +1719,14 @@ void EDM::PrintNeighbors()
 {
     std::cout << "EDM::FindNeighbors(): neighbors:distances" << std::endl;
     size_t predictionRow;
-    for ( size_t i = 0; i < knn_neighbors.NRows(); i++ ) {
+    for ( size_t i = 0; i < knnTable.NRows(); i++ ) {
         predictionRow = parameters.prediction[ i ];
         std::cout << "pred " << predictionRow << " | ";
-        for ( size_t j = 0; j < knn_neighbors.NColumns(); j++ ) {
-            std::cout << knn_neighbors( i, j ) << " ";
+        for ( size_t j = 0; j < knnTable.NColumns(); j++ ) {
+            std::cout << knnTable.Neighbors( i )[ j ] << " ";
         } std::cout << "   : ";
-        for ( size_t j = 0; j < knn_neighbors.NColumns(); j++ ) {
-            std::cout << knn_distances( i, j ) << " ";
+        for ( size_t j = 0; j < knnTable.NColumns(); j++ ) {
+            std::cout << knnTable.Distance( i, j ) << " ";
         } std::cout << std::endl;
     }
 }
@@ -1,7 +1,14 @@
 #ifndef EDM_NEIGHBORS_H
 #define EDM_NEIGHBORS_H
 
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+#include <queue>
+#include <thread>
+
 #include "EDM.h"
+#include "EDM_Metrics.h"
 
 namespace EDM_Distance {
     // Define the initial maximum distance for neigbors
@@ -12,8 +19,106 @@ namespace EDM_Distance {
 // Prototypes
 double Distance( const std::valarray<double> &v1,
                  const std::valarray<double> &v2,
-                 DistanceMetric metric );
+                 DistanceMetric metric = DistanceMetric::Euclidean,
+                 const std::vector<double> &scales = std::vector<double>() );
+
+template< class T, class Metric >
+void EmbeddingDistances( const T                     * source,
+                         size_t                        stride,
+                         const size_t                * offset,
+                         size_t                        nDim,
+                         const std::vector< size_t > & prediction,
+                         const std::vector< size_t > & library,
+                         const Metric                & metric,
+                         DataFrame< T >              & distances );
+
+//----------------------------------------------------------------
+// EmbeddingDistances(), EDM::PartialDistanceSearch(),
+// EDM::ForestSearch(), EDM::StateSearch(), EDM::FoldSearch() and
+// EDM::OriginSearch() arguments,
+// called by EDM_Metric::Dispatch() with the metric policy
+//----------------------------------------------------------------
+template< class T >
+struct EmbeddingDistancesKernel {
+    const T                     * source;
+    size_t                        stride;
+    const size_t                * offset;
+    size_t                        nDim;
+    const std::vector< size_t > & prediction;
+    const std::vector< size_t > & library;
+    DataFrame< T >              & distances;
+
+    template< class Metric >
+    void operator()( const Metric & metric ) {
+        EmbeddingDistances( source, stride, offset, nDim,
+                            prediction, library, metric, distances );
+    }
+};
+
+template< class T >
+struct PartialDistanceKernel {
+    EDM     & edm;
+    const T * source;
+    const T * invScale;
+    int       max_lib_index;
+
+    template< class Metric >
+    void operator()( const Metric & metric ) {
+        edm.PartialDistanceSearch( source, invScale, max_lib_index, metric );
+    }
+};
+
+template< class T >
+struct StateSearchKernel {
+    EDM     & edm;
+    const T * source;
+    const T * queries;
+    size_t    span;
+    int       max_lib_index;
+
+    template< class Metric >
+    void operator()( const Metric & metric ) {
+        edm.StateSearch( source, queries, span, max_lib_index, metric );
+    }
+};
+
+template< class T >
+struct FoldSearchKernel {
+    EDM                         & edm;
+    const T                     * source;
+    const std::vector< size_t > & foldStart;
+    int                           foldBuffer;
+    int                           max_lib_index;
+
+    template< class Metric >
+    void operator()( const Metric & metric ) {
+        edm.FoldSearch( source, foldStart, foldBuffer, max_lib_index, metric );
+    }
+};
+
+template< class T >
+struct OriginSearchKernel {
+    EDM                         & edm;
+    const T                     * source;
+    const std::vector< size_t > & libFirst;
+    const std::vector< size_t > & libLast;
+
+    template< class Metric >
+    void operator()( const Metric & metric ) {
+        edm.OriginSearch( source, libFirst, libLast, metric );
+    }
+};
+
+template< class T >
+struct ForestSearchKernel {
+    EDM     & edm;
+    const T * source;
+    int       max_lib_index;
+    bool      exhaustive;
 
-bool DistanceCompare( const std::pair<double, size_t> &x,
-                      const std::pair<double, size_t> &y );
+    template< class Metric >
+    void operator()( const Metric & metric ) {
+        edm.ForestSearch( source, max_lib_index, exhaustive, metric );
+    }
+};
 #endif
@@ -0,0 +1,205 @@
+#ifndef EDM_SMAPKERNELS_H
+#define EDM_SMAPKERNELS_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+#include "NeighborTable.h"
+
+//----------------------------------------------------------------
+// SMap solver constants and compile-time sized normal equations
+// kernels for the Cholesky solver, included only by SMap.cc
+//----------------------------------------------------------------
+namespace EDM_SMap {
+    // min |R_ii| / max |R_ii| : same as the SVD rcond
+    const double rcondQR       = 1.E-9;
+    // ( min L_ii / max L_ii )^2 of the normal equations A'A,
+    // which has the square of the condition number of A
+    const double rcondCholesky = 1.E-12;
+
+    // Singular values below rcondSVD * s_max are zero, as dgelss
+    const double rcondSVD      = 1.E-9;
+    // One-sided Jacobi SVD of the ridge path: column pairs with
+    // | w_p'w_q | <= jacobiTolerance || w_p || || w_q || are orthogonal
+    const double jacobiTolerance = 1.E-15;
+    const size_t maxJacobiSweeps = 30;
+
+    // Largest system N = E + 1 with a specialized kernel: E = 16
+    const size_t maxKernelN    = 17;
+
+    //------------------------------------------------------------
+    // Number of leading neighbors kept by weight truncation.
+    // Neighbors are sorted by distance so the weights w are
+    // non-increasing. Keeps w_k >= cutoff * w_0, and the fewest
+    // leading neighbors with at least fraction of the weight sum,
+    // but no fewer than min( knn, N ) so the system stays determined.
+    //------------------------------------------------------------
+    inline size_t TruncateWeights( const double *w,
+                                   size_t        knn,
+                                   size_t        N,
+                                   double        cutoff,
+                                   double        fraction ) {
+        size_t keep = knn;
+
+        if ( cutoff > 0 ) {
+            double wMin = cutoff * w[ 0 ];
+            keep = 1;
+            while ( keep < knn and w[ keep ] >= wMin ) {
+                keep++;
+            }
+        }
+
+        if ( fraction < 1 ) {
+            double wSum = 0;
+            for ( size_t k = 0; k < knn; k++ ) {
+                wSum += w[ k ];
+            }
+            double wKeep = fraction * wSum;
+            double wCum  = 0;
+            size_t k     = 0;
+            while ( k < keep and wCum < wKeep ) {
+                wCum += w[ k++ ];
+            }
+            keep = k;
+        }
+
+        return std::max( keep, std::min( knn, N ) );
+    }
+
+    //------------------------------------------------------------
+    // Weighted least squares of target onto [ 1, embedding ] rows
+    // of the knn neighbors by the normal equations, N = E + 1.
+    //
+    // The lower triangle of G = A'A + ridge I and y = A'b are
+    // accumulated in one pass over the neighbors, reading the
+    // embedding rows in place, with A row k = w_k [ 1, x_k ] and
+    // b_k = w_k target_k. All loop bounds are compile time constants
+    // so the compiler unrolls the accumulation and the Cholesky
+    // factorization on stack arrays.
+    //
+    // Returns false, leaving C untouched, if knn < N without ridge,
+    // or if G is not positive definite or ill-conditioned; the
+    // caller then solves the system by SVD.
+    //------------------------------------------------------------
+    template< size_t N >
+    bool NormalEquationsKernel( size_t               knn,
+                                const double        *w,         // knn weights
+                                const NeighborIndex *neighbors, // knn lib rows
+                                const double        *embedding, // view row 0
+                                size_t               stride,    // row stride
+                                const size_t        *offset,    // view columns
+                                const double        *target,    // unweighted
+                                double               ridge,
+                                double              *C ) {      // N coeffs
+        if ( knn < N and ridge == 0 ) {
+            return false;
+        }
+
+        double G[ N ][ N ] = {}; // lower triangle: G[ i ][ j ], j <= i
+        double y[ N ]      = {};
+        double a[ N ];
+
+        for ( size_t k = 0; k < knn; k++ ) {
+            const double *x = embedding + neighbors[ k ] * stride;
+
+            a[ 0 ] = w[ k ];
+            for ( size_t j = 1; j < N; j++ ) {
+                a[ j ] = w[ k ] * x[ offset[ j - 1 ] ];
+            }
+            double b = w[ k ] * target[ k ];
+
+            for ( size_t i = 0; i < N; i++ ) {
+                for ( size_t j = 0; j <= i; j++ ) {
+                    G[ i ][ j ] += a[ i ] * a[ j ];
+                }
+                y[ i ] += a[ i ] * b;
+            }
+        }
+
+        // Cholesky G = L L', L in the lower triangle of G
+        double lMin = 0;
+        double lMax = 0;
+        for ( size_t j = 0; j < N; j++ ) {
+            double d = G[ j ][ j ] + ridge;
+            for ( size_t k = 0; k < j; k++ ) {
+                d -= G[ j ][ k ] * G[ j ][ k ];
+            }
+            if ( not ( d > 0 ) ) {
+                return false; // not positive definite
+            }
+            double l_jj = std::sqrt( d );
+            G[ j ][ j ] = l_jj;
+
+            for ( size_t i = j + 1; i < N; i++ ) {
+                double sum = G[ i ][ j ];
+                for ( size_t k = 0; k < j; k++ ) {
+                    sum -= G[ i ][ k ] * G[ j ][ k ];
+                }
+                G[ i ][ j ] = sum / l_jj;
+            }
+
+            lMin = j ? std::fmin( lMin, l_jj ) : l_jj;
+            lMax = j ? std::fmax( lMax, l_jj ) : l_jj;
+        }
+
+        double lRatio = lMin / lMax;
+        if ( lRatio * lRatio < rcondCholesky ) {
+            return false;
+        }
+
+        // Forward substitution L z = y
+        for ( size_t j = 0; j < N; j++ ) {
+            double sum = y[ j ];
+            for ( size_t k = 0; k < j; k++ ) {
+                sum -= G[ j ][ k ] * y[ k ];
+            }
+            y[ j ] = sum / G[ j ][ j ];
+        }
+
+        // Back substitution L' x = z
+        for ( size_t j = N; j-- > 0; ) {
+            double sum = y[ j ];
+            for ( size_t k = j + 1; k < N; k++ ) {
+                sum -= G[ k ][ j ] * y[ k ];
+            }
+            y[ j ] = sum / G[ j ][ j ];
+        }
+
+        for ( size_t j = 0; j < N; j++ ) {
+            C[ j ] = y[ j ];
+        }
+        return true;
+    }
+
+    //------------------------------------------------------------
+    // Dispatch N = E + 1 in [ 2, maxKernelN ] to its kernel.
+    // Callers use the generic WorkspaceCholesky() for larger N.
+    //------------------------------------------------------------
+    inline bool NormalEquations( size_t               N,
+                                 size_t               knn,
+                                 const double        *w,
+                                 const NeighborIndex *neighbors,
+                                 const double        *embedding,
+                                 size_t               stride,
+                                 const size_t        *offset,
+                                 const double        *target,
+                                 double               ridge,
+                                 double              *C ) {
+#define EDM_SMAP_KERNEL( n ) \
+        case n: return NormalEquationsKernel< n >( knn, w, neighbors, \
+                                                   embedding, stride, \
+                                                   offset, target, ridge, C );
+        switch ( N ) {
+            EDM_SMAP_KERNEL(  2 ) EDM_SMAP_KERNEL(  3 ) EDM_SMAP_KERNEL(  4 )
+            EDM_SMAP_KERNEL(  5 ) EDM_SMAP_KERNEL(  6 ) EDM_SMAP_KERNEL(  7 )
+            EDM_SMAP_KERNEL(  8 ) EDM_SMAP_KERNEL(  9 ) EDM_SMAP_KERNEL( 10 )
+            EDM_SMAP_KERNEL( 11 ) EDM_SMAP_KERNEL( 12 ) EDM_SMAP_KERNEL( 13 )
+            EDM_SMAP_KERNEL( 14 ) EDM_SMAP_KERNEL( 15 ) EDM_SMAP_KERNEL( 16 )
+            EDM_SMAP_KERNEL( 17 )
+        default: return false;
+        }
+#undef EDM_SMAP_KERNEL
+    }
+}
+#endif
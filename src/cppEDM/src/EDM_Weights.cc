@@ -0,0 +1,212 @@
+
+#include <cmath>
+#include <algorithm>
+
+#include "EDM_Weights.h"
+
+// Vector kernels require GCC/clang function target attributes on x86
+#if ( defined(__GNUC__) || defined(__clang__) ) && \
+    ( defined(__x86_64__) || defined(__i386__) )
+#define EDM_WEIGHTS_X86 1
+#if defined(__GNUC__) && !defined(__clang__)
+// GCC < 13 false positive on _mm512_undefined_pd() in avx512fintrin.h
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+#include <immintrin.h>
+#endif
+
+namespace EDM_Weights_Const {
+    // Input clamp: exp( 709.8 ) overflows, exp( -746 ) underflows to 0
+    const double xMax    =  709.8;
+    const double xMin    = -746.0;
+    const double log2e   =  1.4426950408889634074;
+    // Cody-Waite split of ln(2): n * ln2Hi is exact for |n| < 2^11
+    const double ln2Hi   =  0.693145751953125;
+    const double ln2Lo   =  1.42860682030941723212E-6;
+    // 1.5 * 2^52 : adding to an integral double exposes the integer bits
+    const double magic   =  6755399441055744.0;
+
+    // Taylor coefficients 1/k! k = 13 ... 2 for Horner evaluation
+    const double poly[] = { 1.6059043836821614599E-10,
+                            2.0876756987868098979E-9,
+                            2.5052108385441718775E-8,
+                            2.7557319223985890653E-7,
+                            2.7557319223985890653E-6,
+                            2.4801587301587301587E-5,
+                            1.9841269841269841270E-4,
+                            1.3888888888888888889E-3,
+                            8.3333333333333333333E-3,
+                            4.1666666666666666667E-2,
+                            1.6666666666666666667E-1,
+                            0.5 };
+    const size_t nPoly = sizeof( poly ) / sizeof( poly[0] );
+}
+
+//----------------------------------------------------------------
+// Scalar libm path
+//----------------------------------------------------------------
+static void ExpLibm( double *x, size_t N ) {
+    for ( size_t i = 0; i < N; i++ ) {
+        x[ i ] = std::exp( x[ i ] );
+    }
+}
+
+#ifdef EDM_WEIGHTS_X86
+//----------------------------------------------------------------
+// AVX2/FMA kernel: 4 doubles per iteration
+// 2^n is applied as 2^n1 * 2^n2, n1 + n2 = n, so that each factor
+// is a normal double over the full clamped input range.
+//----------------------------------------------------------------
+__attribute__(( target( "avx2,fma" ) ))
+static inline __m256d Exp4( __m256d x ) {
+    using namespace EDM_Weights_Const;
+
+    __m256d xc = _mm256_min_pd( _mm256_max_pd( x, _mm256_set1_pd( xMin ) ),
+                                _mm256_set1_pd( xMax ) );
+
+    __m256d n = _mm256_round_pd( _mm256_mul_pd( xc, _mm256_set1_pd( log2e ) ),
+                                 _MM_FROUND_TO_NEAREST_INT |_MM_FROUND_NO_EXC );
+
+    __m256d r = _mm256_fnmadd_pd( n, _mm256_set1_pd( ln2Hi ), xc );
+    r         = _mm256_fnmadd_pd( n, _mm256_set1_pd( ln2Lo ), r  );
+
+    __m256d p = _mm256_set1_pd( poly[ 0 ] );
+    for ( size_t k = 1; k < nPoly; k++ ) {
+        p = _mm256_fmadd_pd( p, r, _mm256_set1_pd( poly[ k ] ) );
+    }
+    p = _mm256_fmadd_pd( p, r, _mm256_set1_pd( 1. ) );
+    p = _mm256_fmadd_pd( p, r, _mm256_set1_pd( 1. ) );
+
+    // Split n = n1 + n2, then biased exponent bits ( ni + 1023 ) << 52
+    __m256d n1 = _mm256_round_pd( _mm256_mul_pd( n, _mm256_set1_pd( 0.5 ) ),
+                                  _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC );
+    __m256d n2 = _mm256_sub_pd( n, n1 );
+
+    __m256d vMagic = _mm256_set1_pd( magic );
+    __m256i bias   = _mm256_add_epi64( _mm256_castpd_si256( vMagic ),
+                                       _mm256_set1_epi64x( -1023 ) );
+    __m256i e1 = _mm256_sub_epi64(
+        _mm256_castpd_si256( _mm256_add_pd( n1, vMagic ) ), bias );
+    __m256i e2 = _mm256_sub_epi64(
+        _mm256_castpd_si256( _mm256_add_pd( n2, vMagic ) ), bias );
+
+    __m256d s1 = _mm256_castsi256_pd( _mm256_slli_epi64( e1, 52 ) );
+    __m256d s2 = _mm256_castsi256_pd( _mm256_slli_epi64( e2, 52 ) );
+
+    __m256d y = _mm256_mul_pd( _mm256_mul_pd( p, s1 ), s2 );
+
+    // nan in : nan out (the clamp discards nan)
+    __m256d isNan = _mm256_cmp_pd( x, x, _CMP_UNORD_Q );
+    return _mm256_blendv_pd( y, x, isNan );
+}
+
+__attribute__(( target( "avx2,fma" ) ))
+static void ExpAVX2( double *x, size_t N ) {
+    size_t i = 0;
+    for ( ; i + 4 <= N; i += 4 ) {
+        _mm256_storeu_pd( x + i, Exp4( _mm256_loadu_pd( x + i ) ) );
+    }
+    if ( i < N ) {
+        // Tail through the same kernel so results do not depend on N
+        double tail[ 4 ] = { 0, 0, 0, 0 };
+        std::copy( x + i, x + N, tail );
+        _mm256_storeu_pd( tail, Exp4( _mm256_loadu_pd( tail ) ) );
+        std::copy( tail, tail + ( N - i ), x + i );
+    }
+}
+
+//----------------------------------------------------------------
+// AVX-512F kernel: 8 doubles per iteration
+// scalef applies 2^n with a single rounding over the full range.
+//----------------------------------------------------------------
+__attribute__(( target( "avx512f" ) ))
+static inline __m512d Exp8( __m512d x ) {
+    using namespace EDM_Weights_Const;
+
+    __m512d xc = _mm512_min_pd( _mm512_max_pd( x, _mm512_set1_pd( xMin ) ),
+                                _mm512_set1_pd( xMax ) );
+
+    __m512d n = _mm512_roundscale_pd( _mm512_mul_pd( xc,
+                                                     _mm512_set1_pd( log2e ) ),
+                                      _MM_FROUND_TO_NEAREST_INT |
+                                      _MM_FROUND_NO_EXC );
+
+    __m512d r = _mm512_fnmadd_pd( n, _mm512_set1_pd( ln2Hi ), xc );
+    r         = _mm512_fnmadd_pd( n, _mm512_set1_pd( ln2Lo ), r  );
+
+    __m512d p = _mm512_set1_pd( poly[ 0 ] );
+    for ( size_t k = 1; k < nPoly; k++ ) {
+        p = _mm512_fmadd_pd( p, r, _mm512_set1_pd( poly[ k ] ) );
+    }
+    p = _mm512_fmadd_pd( p, r, _mm512_set1_pd( 1. ) );
+    p = _mm512_fmadd_pd( p, r, _mm512_set1_pd( 1. ) );
+
+    __m512d y = _mm512_scalef_pd( p, n );
+
+    // nan in : nan out (the clamp discards nan)
+    __mmask8 isNan = _mm512_cmp_pd_mask( x, x, _CMP_UNORD_Q );
+    return _mm512_mask_blend_pd( isNan, y, x );
+}
+
+__attribute__(( target( "avx512f" ) ))
+static void ExpAVX512( double *x, size_t N ) {
+    size_t i = 0;
+    for ( ; i + 8 <= N; i += 8 ) {
+        _mm512_storeu_pd( x + i, Exp8( _mm512_loadu_pd( x + i ) ) );
+    }
+    if ( i < N ) {
+        __mmask8 mask = (__mmask8) ( ( 1u << ( N - i ) ) - 1 );
+        __m512d  v    = _mm512_maskz_loadu_pd( mask, x + i );
+        _mm512_mask_storeu_pd( x + i, mask, Exp8( v ) );
+    }
+}
+#endif // EDM_WEIGHTS_X86
+
+//----------------------------------------------------------------
+// Runtime dispatch, resolved once
+//----------------------------------------------------------------
+typedef void (*ExpKernel)( double *, size_t );
+
+struct ExpDispatch {
+    ExpKernel   kernel;
+    const char *name;
+
+    ExpDispatch() : kernel( &ExpLibm ), name( "libm" ) {
+#ifdef EDM_WEIGHTS_X86
+        __builtin_cpu_init();
+        if ( __builtin_cpu_supports( "avx512f" ) ) {
+            kernel = &ExpAVX512;
+            name   = "avx512";
+        }
+        else if ( __builtin_cpu_supports( "avx2" ) and
+                  __builtin_cpu_supports( "fma"  ) ) {
+            kernel = &ExpAVX2;
+            name   = "avx2";
+        }
+#endif
+    }
+};
+
+static const ExpDispatch & GetExpDispatch() {
+    static const ExpDispatch dispatch; // C++11 thread safe initialisation
+    return dispatch;
+}
+
+//----------------------------------------------------------------
+// x[i] = exp( x[i] )
+//----------------------------------------------------------------
+void ExpWeights( double *x, size_t N, bool exact ) {
+    if ( exact ) {
+        ExpLibm( x, N );
+    }
+    else {
+        GetExpDispatch().kernel( x, N );
+    }
+}
+
+//----------------------------------------------------------------
+//
+//----------------------------------------------------------------
+const char *ExpWeightsKernel() {
+    return GetExpDispatch().name;
+}
@@ -0,0 +1,32 @@
+#ifndef EDM_WEIGHTS_H
+#define EDM_WEIGHTS_H
+
+#include <cstddef>
+
+//----------------------------------------------------------------
+// Batch exponential for Simplex and SMap neighbor weights.
+//
+// ExpWeights() replaces x[i] with exp( x[i] ) for i in [0, N).
+//
+// On x86 with GCC or clang an AVX-512 or AVX2/FMA kernel is
+// selected at runtime from the CPU features. Otherwise, or if
+// exact = true, the scalar libm std::exp() is used.
+//
+// The vector kernels use Cody-Waite range reduction to
+// r in [-ln(2)/2, ln(2)/2] and a degree 13 Taylor polynomial.
+// For results in the normal double range the relative error with
+// respect to libm exp() is bounded by MaxRelativeError (2 ulp);
+// the observed maximum over [-708, 709] is 1 ulp.
+// Overflow to inf, underflow to 0, and nan propagation match libm.
+// Results in the subnormal range (x < -708.4) have the reduced
+// precision of subnormal numbers.
+//----------------------------------------------------------------
+namespace EDM_Weights {
+    const double MaxRelativeError = 4.5E-16;
+}
+
+void ExpWeights( double *x, size_t N, bool exact = false );
+
+// Kernel selected at runtime: "avx512", "avx2" or "libm"
+const char *ExpWeightsKernel();
+#endif
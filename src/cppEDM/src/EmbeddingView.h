@@ -0,0 +1,258 @@
+#ifndef EMBEDDINGVIEW_H
+#define EMBEDDINGVIEW_H
+
+#include <algorithm>
+
+#include "DataFrame.h"
+#include "ModelFile.h"
+
+//----------------------------------------------------------------
+// EmbeddingView class
+// Embedding vectors addressed in place in a row major block of the
+// data columns, without a materialized embedding DataFrame.
+//
+// Element ( row, j ) of the embedding is at
+//   source[ row * stride + offset[ j ] ]
+// where stride is the number of source columns.
+//
+// A time delay embedding of the source column c at lag e is the
+// column shifted by e * tau rows.
+// For a single series (stride = 1) the E embedding columns are
+// E shifted views of one contiguous column, so the N x E copy of
+// MakeBlock() is not made. An embedded = true block is a view with
+// offset[ j ] = j.
+//
+// Embedding row i is the same row as in MakeBlock(): the first
+// tau * (E-1) rows are the partial data rows, removed as there.
+//
+// SinglePrecision() adds a float copy of the source for the single
+// precision distances, addressed as the double source with
+// RowBaseFloat(). The double source can then be released.
+//
+// Append() adds rows of the source for the streaming EDMStream.
+//----------------------------------------------------------------
+class EmbeddingView {
+
+    std::valarray< double >    source;  // row major data columns block
+    std::valarray< float >     sourceFloat; // SinglePrecision() source
+    size_t                     n_rows;  // embedding rows
+    size_t                     stride;  // source columns
+    std::vector< size_t >      offset;  // embedding column : source offset
+    std::vector< std::string > columnNames;
+
+public:
+    EmbeddingView() : n_rows( 0 ), stride( 0 ) {}
+
+    //-----------------------------------------------------------------
+    // embedded = true : the block columns are the embedding
+    //-----------------------------------------------------------------
+    explicit EmbeddingView( DataFrame< double > & block ) :
+        source( std::move( block.Elements() ) ),
+        n_rows( block.NRows() ), stride( block.NColumns() ),
+        offset( block.NColumns() ), columnNames( block.ColumnNames() )
+    {
+        for ( size_t j = 0; j < offset.size(); j++ ) {
+            offset[ j ] = j;
+        }
+    }
+
+    //-----------------------------------------------------------------
+    // Time delay embedding of the block columns to dimension E with
+    // lag tau : MakeBlock() column order and names X(t-0) X(t-1)...
+    //-----------------------------------------------------------------
+    EmbeddingView( DataFrame< double >      & block,
+                   int                        E,
+                   int                        tau,
+                   std::vector< std::string > colNames ) :
+        n_rows( 0 ), stride( block.NColumns() )
+    {
+        if ( colNames.size() != block.NColumns() ) {
+            std::stringstream errMsg;
+            errMsg << "EmbeddingView(): The number of columns in the "
+                   << "dataFrame (" << block.NColumns() << ") is not equal "
+                   << "to the number of columns specified ("
+                   << colNames.size() << ").\n";
+            throw std::runtime_error( errMsg.str() );
+        }
+
+        if ( E < 1 ) {
+            std::stringstream errMsg;
+            errMsg << "EmbeddingView(): E = " << E << " is invalid.\n" ;
+            throw std::runtime_error( errMsg.str() );
+        }
+
+        size_t NPartial = abs( tau ) * ( E - 1 ); // partial data rows
+
+        if ( NPartial > block.NRows() ) {
+            std::stringstream errMsg;
+            errMsg << "EmbeddingView(): Number of data rows "
+                   << block.NRows() << " is not sufficient for "
+                   << "tau*(E-1) = " << NPartial << ".\n";
+            throw std::runtime_error( errMsg.str() );
+        }
+
+        n_rows = block.NRows() - NPartial;
+
+        for ( size_t col = 0; col < stride; col++ ) {
+            for ( int e = 0; e < E; e++ ) {
+                // Source row of embedding row 0 at lag e. For tau < 0
+                // embedding row 0 is source row NPartial, lag e is
+                // e |tau| rows back; for tau > 0 e tau rows ahead.
+                size_t sourceRow = tau < 0 ? NPartial - e * abs( tau ) :
+                                             e * tau;
+                offset.push_back( sourceRow * stride + col );
+
+                std::stringstream ss;
+                if ( tau < 0 ) {
+                    ss << colNames[ col ] << "(t-" << e << ")";
+                }
+                else {
+                    ss << colNames[ col ] << "(t+" << e << ")";
+                }
+                columnNames.push_back( ss.str() );
+            }
+        }
+
+        source = std::move( block.Elements() );
+    }
+
+    size_t NRows()    const { return n_rows;        }
+    size_t NColumns() const { return offset.size(); }
+    size_t Stride()   const { return stride;        }
+
+    const std::vector< std::string > & ColumnNames() const {
+        return columnNames;
+    }
+
+    //-----------------------------------------------------------------
+    // Embedding row r column j is RowBase( r )[ Offsets()[ j ] ]
+    //-----------------------------------------------------------------
+    const double *RowBase( size_t row ) const {
+        return &source[ 0 ] + row * stride;
+    }
+    const size_t *Offsets() const { return offset.data(); }
+
+    //-----------------------------------------------------------------
+    // Single precision source: RowBaseFloat( r )[ Offsets()[ j ] ].
+    // keepDouble = false releases the double source: then only
+    // NRows(), NColumns(), ColumnNames() and RowBaseFloat() are valid.
+    //-----------------------------------------------------------------
+    void SinglePrecision( bool keepDouble ) {
+        if ( source.size() and sourceFloat.size() != source.size() ) {
+            sourceFloat.resize( source.size() );
+            for ( size_t i = 0; i < source.size(); i++ ) {
+                sourceFloat[ i ] = (float) source[ i ];
+            }
+        }
+        if ( not keepDouble ) {
+            source = std::valarray< double >();
+        }
+    }
+
+    const float *RowBaseFloat( size_t row ) const {
+        return &sourceFloat[ 0 ] + row * stride;
+    }
+
+    //-----------------------------------------------------------------
+    // Append a source row of the stride block columns: the next
+    // embedding row. The sources grow by doubling, rows beyond the
+    // embedding are unused.
+    //-----------------------------------------------------------------
+    void Append( const double * row ) {
+        size_t partial = offset.size() ? // partial data rows of source
+            *std::max_element( offset.begin(), offset.end() ) / stride : 0;
+        size_t used = ( n_rows + partial ) * stride;
+
+        if ( source.size() or not sourceFloat.size() ) {
+            Reserve( source, used + stride );
+            std::copy( row, row + stride, &source[ used ] );
+        }
+        if ( sourceFloat.size() ) {
+            Reserve( sourceFloat, used + stride );
+            for ( size_t j = 0; j < stride; j++ ) {
+                sourceFloat[ used + j ] = (float) row[ j ];
+            }
+        }
+        n_rows++;
+    }
+
+    double operator()( size_t row, size_t column ) const {
+        return source[ row * stride + offset[ column ] ];
+    }
+
+    std::valarray< double > Row( size_t row ) const {
+        std::valarray< double > rowVector( offset.size() );
+        const double *base = RowBase( row );
+        for ( size_t j = 0; j < offset.size(); j++ ) {
+            rowVector[ j ] = base[ offset[ j ] ];
+        }
+        return rowVector;
+    }
+
+    //-----------------------------------------------------------------
+    // Model file sections, see ModelFile.h
+    //-----------------------------------------------------------------
+    void Save( ModelFileWriter & file ) const {
+        file.Scalar< uint64_t >( n_rows );
+        file.Scalar< uint64_t >( stride );
+        file.Array( offset );
+        file.Strings( columnNames );
+        file.Array( source.size() ? &source[ 0 ] : nullptr, source.size() );
+        file.Array( sourceFloat.size() ? &sourceFloat[ 0 ] : nullptr,
+                    sourceFloat.size() );
+    }
+
+    void Load( ModelFileReader & file ) {
+        n_rows      = file.Scalar< uint64_t >();
+        stride      = file.Scalar< uint64_t >();
+        offset      = file.Vector< size_t >();
+        columnNames = file.Strings();
+
+        size_t        n;
+        const double *sourceFile = file.Array< double >( n );
+        source = std::valarray< double >( sourceFile, n );
+        const float  *floatFile  = file.Array< float >( n );
+        sourceFloat = std::valarray< float >( floatFile, n );
+
+        // Embedding rows within the sources
+        size_t nSource = std::max( source.size(), sourceFloat.size() );
+        bool   valid   = ( source.size() == 0 or source.size() == nSource ) and
+                         ( sourceFloat.size() == 0 or
+                           sourceFloat.size() == nSource );
+        for ( size_t j = 0; valid and n_rows and j < offset.size(); j++ ) {
+            valid = offset[ j ] + ( n_rows - 1 ) * stride < nSource;
+        }
+        if ( not valid ) {
+            throw std::runtime_error( "EmbeddingView::Load(): "
+                                      "invalid embedding.\n" );
+        }
+    }
+
+private:
+    template< class T >
+    static void Reserve( std::valarray< T > & elements, size_t n ) {
+        if ( n > elements.size() ) {
+            std::valarray< T > grown( std::max( n, 2 * elements.size() ) );
+            std::copy( std::begin( elements ), std::end( elements ),
+                       std::begin( grown ) );
+            elements.swap( grown );
+        }
+    }
+
+public:
+    //-----------------------------------------------------------------
+    // Materialized embedding DataFrame, as MakeBlock()
+    //-----------------------------------------------------------------
+    DataFrame< double > Materialize() const {
+        DataFrame< double > block( n_rows, offset.size(), columnNames );
+        for ( size_t row = 0; row < n_rows; row++ ) {
+            DataFrameSpan< double > blockRow = block.RowSpan( row );
+            const double           *base     = RowBase( row );
+            for ( size_t j = 0; j < offset.size(); j++ ) {
+                blockRow[ j ] = base[ offset[ j ] ];
+            }
+        }
+        return block;
+    }
+};
+#endif
@@ -73,7 +73,10 @@ void SMapThread( EDM_Eval::WorkQueue   &workQ,
                  std::string            colNames,
                  std::string            targetName,
                  bool                   embedded,
-                 bool                   verbose );
+                 bool                   verbose,
+                 std::string            solverName,
+                 double                 ridge,
+                 std::string            ridgePath );
 
 //----------------------------------------------------------------
 // EmbedDimension() : Evaluate Simplex rho vs. dimension E
@@ -217,7 +220,8 @@ void EmbedThread( EDM_Eval::WorkQueue & workQ,
         // Simplex() -> Embed() -> DeletePartialDataRows()
         // In a multthreaded application we need to pass a unique copy of
         // the data so that DeletePartialDataRows() is not recursively
-        // applied to the same data frame.
+        // applied to the same data frame. The copy shares the elements
+        // of data until modified (copy-on-write).
         DataFrame< double > localData( data );
 
         try {
@@ -402,7 +406,8 @@ void PredictIntervalThread( EDM_Eval::WorkQueue &workQ,
 
         // In a multthreaded application we need to pass a unique copy of
         // the data so that DeletePartialDataRows() is not recursively
-        // applied to the same data frame.
+        // applied to the same data frame. The copy shares the elements
+        // of data until modified (copy-on-write).
         DataFrame< double > localData( data );
 
         try {
@@ -468,7 +473,10 @@ DataFrame< double > PredictNonlinear( std::string pathIn,
                                       std::string targetName,
                                       bool        embedded,
                                       bool        verbose,
-                                      unsigned    nThreads ) {
+                                      unsigned    nThreads,
+                                      std::string solverName,
+                                      double      ridge,
+                                      std::string ridgePath ) {
 
     // Create DataFrame (constructor loads data)
     DataFrame< double > dataFrameIn( pathIn, dataFile );
@@ -487,7 +495,10 @@ DataFrame< double > PredictNonlinear( std::string pathIn,
                                                       targetName,
                                                       embedded,
                                                       verbose,
-                                                      nThreads );
+                                                      nThreads,
+                                                      solverName,
+                                                      ridge,
+                                                      ridgePath );
     return Theta_rho;
 }
 
@@ -509,7 +520,10 @@ DataFrame< double > PredictNonlinear( DataFrame< double > & data,
                                       std::string           targetName,
                                       bool                  embedded,
                                       bool                  verbose,
-                                      unsigned              nThreads ) {
+                                      unsigned              nThreads,
+                                      std::string           solverName,
+                                      double                ridge,
+                                      std::string           ridgePath ) {
 
     std::vector<double> ThetaValues( { 0.01, 0.1, 0.3, 0.5, 0.75, 1,
                                        1.5, 2, 3, 4, 5, 6, 7, 8, 9 } );
@@ -533,8 +547,14 @@ DataFrame< double > PredictNonlinear( DataFrame< double > & data,
         }
     }
 
-    // Container for results
-    DataFrame< double > Theta_rho( ThetaValues.size(), 2, "Theta rho" );
+    // Container for results. With a ridgePath each theta has a row
+    // for each ridge lambda.
+    size_t nRidge = SplitString( ridgePath, " \t,\n" ).size();
+
+    DataFrame< double > Theta_rho = nRidge ?
+        DataFrame< double >( ThetaValues.size() * nRidge, 3,
+                             "Theta Ridge rho" ) :
+        DataFrame< double >( ThetaValues.size(), 2, "Theta rho" );
 
     // Build work queue
     EDM_Eval::WorkQueue workQ( ThetaValues.size() );
@@ -565,7 +585,10 @@ DataFrame< double > PredictNonlinear( DataFrame< double > & data,
                                         colNames,
                                         targetName,
                                         embedded,
-                                        verbose ) );
+                                        verbose,
+                                        solverName,
+                                        ridge,
+                                        ridgePath ) );
     }
 
     // join threads
@@ -610,7 +633,10 @@ void SMapThread( EDM_Eval::WorkQueue   &workQ,
                  std::string            colNames,
                  std::string            targetName,
                  bool                   embedded,
-                 bool                   verbose )
+                 bool                   verbose,
+                 std::string            solverName,
+                 double                 ridge,
+                 std::string            ridgePath )
 {
     std::size_t i =
         std::atomic_fetch_add( &EDM_Eval::smap_count_i, std::size_t(1) );
@@ -621,43 +647,92 @@ void SMapThread( EDM_Eval::WorkQueue   &workQ,
 
         // In a multthreaded application we need to pass a unique copy of
         // the data so that DeletePartialDataRows() is not recursively
-        // applied to the same data frame.
+        // applied to the same data frame. The copy shares the elements
+        // of data until modified (copy-on-write).
         DataFrame< double > localData( data );
 
         try {
-            SMapValues S = SMap( std::ref( localData ),
-                                 "",
-                                 "",        // predictFile
-                                 lib,
-                                 pred,
-                                 E,
-                                 Tp,
-                                 knn,
-                                 tau,
-                                 theta,
-                                 0,         // exclusionRadius
-                                 colNames,
-                                 targetName,
-                                 "",        // smapFile
-                                 "",        // derivatives
-                                 embedded,
-                                 false,     // const_predict
-                                 verbose );
-
-            DataFrame< double > predictions  = S.predictions;
-            DataFrame< double > coefficients = S.coefficients;
-
-            VectorError ve = ComputeError(
-                predictions.VectorColumnName( "Observations" ),
-                predictions.VectorColumnName( "Predictions"  ) );
-
-            Theta_rho.WriteRow( i, std::valarray<double>({ theta, ve.rho }));
-
-            if ( verbose ) {
-                std::lock_guard<std::mutex> lck( EDM_Eval::mtx );
-                std::cout << "Theta " << theta
-                          << "  rho " << ve.rho << "  RMSE " << ve.RMSE
-                          << "  MAE " << ve.MAE << std::endl << std::endl;
+            if ( ridgePath.size() ) {
+                // One SVD per prediction row for all ridge lambdas
+                SMapRidgePathValues R = SMapRidgePath( std::ref( localData ),
+                                                       lib,
+                                                       pred,
+                                                       E,
+                                                       Tp,
+                                                       knn,
+                                                       tau,
+                                                       theta,
+                                                       0, // exclusionRadius
+                                                       colNames,
+                                                       targetName,
+                                                       ridgePath,
+                                                       embedded,
+                                                       false, // const_predict
+                                                       verbose );
+
+                size_t nRidge = R.ridge.size();
+
+                for ( size_t l = 0; l < nRidge; l++ ) {
+                    DataFrame< double > & predictions =
+                        R.values[ l ].predictions;
+
+                    VectorError ve = ComputeError(
+                        predictions.VectorColumnName( "Observations" ),
+                        predictions.VectorColumnName( "Predictions"  ) );
+
+                    Theta_rho.WriteRow( i * nRidge + l,
+                        std::valarray<double>({ theta, R.ridge[ l ],
+                                                ve.rho }) );
+
+                    if ( verbose ) {
+                        std::lock_guard<std::mutex> lck( EDM_Eval::mtx );
+                        std::cout << "Theta " << theta
+                                  << "  Ridge " << R.ridge[ l ]
+                                  << "  rho " << ve.rho
+                                  << "  RMSE " << ve.RMSE
+                                  << "  MAE " << ve.MAE << std::endl;
+                    }
+                }
+            }
+            else {
+                SMapValues S = SMap( std::ref( localData ),
+                                     "",
+                                     "",        // predictFile
+                                     lib,
+                                     pred,
+                                     E,
+                                     Tp,
+                                     knn,
+                                     tau,
+                                     theta,
+                                     0,         // exclusionRadius
+                                     colNames,
+                                     targetName,
+                                     "",        // smapFile
+                                     "",        // derivatives
+                                     embedded,
+                                     false,     // const_predict
+                                     verbose,
+                                     false,     // exactExp
+                                     solverName,
+                                     ridge );
+
+                DataFrame< double > predictions  = S.predictions;
+                DataFrame< double > coefficients = S.coefficients;
+
+                VectorError ve = ComputeError(
+                    predictions.VectorColumnName( "Observations" ),
+                    predictions.VectorColumnName( "Predictions"  ) );
+
+                Theta_rho.WriteRow( i,
+                                    std::valarray<double>({ theta, ve.rho }));
+
+                if ( verbose ) {
+                    std::lock_guard<std::mutex> lck( EDM_Eval::mtx );
+                    std::cout << "Theta " << theta
+                              << "  rho " << ve.rho << "  RMSE " << ve.RMSE
+                              << "  MAE " << ve.MAE << std::endl << std::endl;
+                }
             }
         }
         catch(...) {
@@ -0,0 +1,144 @@
+
+#include <iterator>
+
+#include "ModelFile.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    const char     ModelFileMagic[ 8 ] = { 'c','p','p','E','D','M','m','f' };
+    const uint32_t ModelFileByteOrder  = 0x01020304;
+}
+
+//----------------------------------------------------------------
+// Writer: header
+//----------------------------------------------------------------
+ModelFileWriter::ModelFileWriter( std::string path, uint64_t hash ) :
+    out( path, std::ios::out | std::ios::binary | std::ios::trunc ),
+    path( path ) {
+
+    if ( not out.is_open() ) {
+        std::stringstream errMsg;
+        errMsg << "ModelFileWriter(): Failed to open " << path << "\n";
+        throw std::runtime_error( errMsg.str() );
+    }
+
+    uint32_t header[ 4 ] = { ModelFileVersion, ModelFileByteOrder,
+                             (uint32_t) sizeof( size_t ), 0 };
+
+    out.write( ModelFileMagic, sizeof( ModelFileMagic ) );
+    out.write( reinterpret_cast< const char * >( header ), sizeof( header ) );
+    out.write( reinterpret_cast< const char * >( &hash ),  sizeof( hash ) );
+}
+
+void ModelFileWriter::Close() {
+    out.close();
+    if ( out.fail() ) {
+        std::stringstream errMsg;
+        errMsg << "ModelFileWriter::Close(): Failed to write " << path << "\n";
+        throw std::runtime_error( errMsg.str() );
+    }
+}
+
+//----------------------------------------------------------------
+// Reader: map the file and validate the header
+//----------------------------------------------------------------
+ModelFileReader::ModelFileReader( std::string path ) :
+    base( nullptr ), size( 0 ), position( 0 ), path( path ),
+    mapped( false ), hash( 0 ) {
+
+#ifndef _WIN32
+    int fd = open( path.c_str(), O_RDONLY );
+    if ( fd >= 0 ) {
+        struct stat st;
+        if ( fstat( fd, &st ) == 0 and st.st_size > 0 ) {
+            void *map = mmap( nullptr, st.st_size, PROT_READ, MAP_SHARED,
+                              fd, 0 );
+            if ( map != MAP_FAILED ) {
+                base   = static_cast< const char * >( map );
+                size   = st.st_size;
+                mapped = true;
+            }
+        }
+        close( fd ); // the map holds the file
+    }
+#endif
+
+    if ( not mapped ) {
+        std::ifstream in( path, std::ios::in | std::ios::binary );
+        if ( not in.is_open() ) {
+            std::stringstream errMsg;
+            errMsg << "ModelFileReader(): Failed to open " << path << "\n";
+            throw std::runtime_error( errMsg.str() );
+        }
+        buffer.assign( std::istreambuf_iterator< char >( in ),
+                       std::istreambuf_iterator< char >() );
+        base = buffer.data();
+        size = buffer.size();
+    }
+
+    try {
+        ReadHeader();
+    }
+    catch ( ... ) {
+        Unmap(); // no destructor call of a throwing constructor
+        throw;
+    }
+}
+
+ModelFileReader::~ModelFileReader() { Unmap(); }
+
+void ModelFileReader::Unmap() {
+#ifndef _WIN32
+    if ( mapped ) {
+        munmap( const_cast< char * >( base ), size );
+        mapped = false;
+    }
+#endif
+}
+
+//----------------------------------------------------------------
+// Validate the header, read the hash
+//----------------------------------------------------------------
+void ModelFileReader::ReadHeader() {
+
+    const size_t headerSize = sizeof( ModelFileMagic ) +
+                              4 * sizeof( uint32_t ) + sizeof( uint64_t );
+
+    if ( size < headerSize or
+         std::memcmp( base, ModelFileMagic, sizeof( ModelFileMagic ) ) ) {
+        std::stringstream errMsg;
+        errMsg << "ModelFileReader(): " << path << " is not a model file.\n";
+        throw std::runtime_error( errMsg.str() );
+    }
+    position = sizeof( ModelFileMagic );
+
+    const uint32_t *header = Bytes< uint32_t >( 4 * sizeof( uint32_t ) );
+    if ( header[ 0 ] != ModelFileVersion ) {
+        std::stringstream errMsg;
+        errMsg << "ModelFileReader(): " << path << " model file version "
+               << header[ 0 ] << " is not supported, expected "
+               << ModelFileVersion << ".\n";
+        throw std::runtime_error( errMsg.str() );
+    }
+    if ( header[ 1 ] != ModelFileByteOrder or
+         header[ 2 ] != sizeof( size_t ) ) {
+        std::stringstream errMsg;
+        errMsg << "ModelFileReader(): " << path << " was written on a "
+               << "platform of different byte order or size_t.\n";
+        throw std::runtime_error( errMsg.str() );
+    }
+
+    hash = *Bytes< uint64_t >( sizeof( uint64_t ) );
+}
+
+void ModelFileReader::Truncated() const {
+    std::stringstream errMsg;
+    errMsg << "ModelFileReader(): " << path << " is truncated.\n";
+    throw std::runtime_error( errMsg.str() );
+}
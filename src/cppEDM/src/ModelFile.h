@@ -0,0 +1,165 @@
+#ifndef MODELFILE_H
+#define MODELFILE_H
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+//----------------------------------------------------------------
+// Binary model file of a prepared EDMModel
+//
+// Header:
+//   char     magic[ 8 ]   "cppEDMmf"
+//   uint32_t version      ModelFileVersion
+//   uint32_t byteOrder    0x01020304 as written
+//   uint32_t sizeofSize   sizeof( size_t )
+//   uint32_t reserved
+//   uint64_t hash         ContentHash of the data and parameters
+// followed by sections, each a uint64_t element count and the
+// elements, zero padded to 8 bytes. Sections are aligned in the
+// file: the reader addresses the arrays in place in a read-only
+// memory map of the file, pages shared by all processes that map it.
+//
+// Files are native: a file of a different byte order or size_t
+// is rejected, not converted.
+//----------------------------------------------------------------
+const uint32_t ModelFileVersion = 1;
+
+//----------------------------------------------------------------
+// FNV-1a 64 bit hash of bytes, continued from hash
+//----------------------------------------------------------------
+inline uint64_t ContentHash( const void * bytes, size_t n,
+                             uint64_t hash = 14695981039346656037ULL ) {
+    const unsigned char *b = static_cast< const unsigned char * >( bytes );
+    for ( size_t i = 0; i < n; i++ ) {
+        hash = ( hash ^ b[ i ] ) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+//----------------------------------------------------------------
+// ModelFileWriter
+//----------------------------------------------------------------
+class ModelFileWriter {
+
+    std::ofstream out;
+    std::string   path;
+
+public:
+    ModelFileWriter( std::string path, uint64_t hash );
+
+    template< class T >
+    void Array( const T * elements, size_t n ) {
+        uint64_t count = n;
+        out.write( reinterpret_cast< const char * >( &count ),
+                   sizeof( count ) );
+        out.write( reinterpret_cast< const char * >( elements ),
+                   n * sizeof( T ) );
+
+        static const char zeros[ 8 ] = { 0 };
+        size_t pad = ( 8 - ( n * sizeof( T ) ) % 8 ) % 8;
+        out.write( zeros, pad );
+    }
+
+    template< class T >
+    void Array( const std::vector< T > & elements ) {
+        Array( elements.data(), elements.size() );
+    }
+
+    template< class T >
+    void Scalar( T value ) { Array( &value, 1 ); }
+
+    void String ( const std::string & str ) {
+        Array( str.data(), str.size() );
+    }
+    void Strings( const std::vector< std::string > & strs ) {
+        Scalar< uint64_t >( strs.size() );
+        for ( auto & str : strs ) { String( str ); }
+    }
+
+    void Close(); // throws if a write failed
+};
+
+//----------------------------------------------------------------
+// ModelFileReader
+// Read-only memory map of the file; the file is read into memory
+// where mmap() is not available. Array() returns pointers into the
+// map, valid for the life of the reader.
+//----------------------------------------------------------------
+class ModelFileReader {
+
+    const char        *base;
+    size_t             size;
+    size_t             position;
+    std::string        path;
+    std::vector< char > buffer; // no mmap()
+    bool               mapped;
+    uint64_t           hash;
+
+    ModelFileReader( const ModelFileReader & );             // not copyable
+    ModelFileReader & operator=( const ModelFileReader & );
+
+public:
+    explicit ModelFileReader( std::string path );
+    ~ModelFileReader();
+
+    uint64_t Hash() const { return hash; }
+
+    template< class T >
+    const T *Array( size_t & n ) {
+        uint64_t count = *Bytes< uint64_t >( sizeof( uint64_t ) );
+        if ( count > ( size - position ) / sizeof( T ) ) {
+            Truncated();
+        }
+        n = count;
+        const T *elements = Bytes< T >( n * sizeof( T ) );
+        position += ( 8 - ( n * sizeof( T ) ) % 8 ) % 8;
+        return elements;
+    }
+
+    template< class T >
+    std::vector< T > Vector() {
+        size_t   n;
+        const T *elements = Array< T >( n );
+        return std::vector< T >( elements, elements + n );
+    }
+
+    template< class T >
+    T Scalar() {
+        size_t   n;
+        const T *value = Array< T >( n );
+        if ( n != 1 ) { Truncated(); }
+        return *value;
+    }
+
+    std::string String() {
+        size_t      n;
+        const char *str = Array< char >( n );
+        return std::string( str, n );
+    }
+    std::vector< std::string > Strings() {
+        std::vector< std::string > strs( Scalar< uint64_t >() );
+        for ( auto & str : strs ) { str = String(); }
+        return strs;
+    }
+
+private:
+    template< class T >
+    const T *Bytes( size_t n ) {
+        if ( n > size - position ) {
+            Truncated();
+        }
+        const T *bytes = reinterpret_cast< const T * >( base + position );
+        position += n;
+        return bytes;
+    }
+
+    void ReadHeader();
+    void Unmap();
+    void Truncated() const;
+};
+#endif
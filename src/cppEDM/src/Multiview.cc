@@ -87,6 +87,9 @@ void MultiviewClass::Project( unsigned nThreads ) {
 
     SetupParameters();  // Requires valid embedding
 
+    // Materialized embedding: combo columns are selected by name/index
+    embeddingBlock = embedding.Materialize();
+
     // Set embedded true for subset columns in Simplex()
     parameters.embedded = true;
 
@@ -125,7 +128,8 @@ void MultiviewClass::Multiview ( unsigned nThreads ) {
         for ( std::string colName : embedding.ColumnNames() ) {
             if ( colName.find( parameters.targetName ) != std::string::npos ) {
                 // combos are not zero offset... + 1
-                size_t colIndex = embedding.ColumnNameToIndex()[ colName ] + 1;
+                size_t colIndex =
+                    embeddingBlock.ColumnNameToIndex()[ colName ] + 1;
                 targetColIndices.push_back( colIndex );
             }
         }
@@ -519,14 +523,14 @@ void EvalComboThread( MultiviewClass                       & MV,
 
         // Find target column in embedding
         size_t targetColumn =
-            MV.embedding.ColumnNameToIndex()[ threadTarget.str() ];
+            MV.embeddingBlock.ColumnNameToIndex()[ threadTarget.str() ];
 
         // Add target column to comboCols for DataFrame subset
         comboCols.push_back( targetColumn );
 
         // Select combo columns from the data : columns and target
         DataFrame< double > comboData =
-            MV.embedding.DataFrameFromColumnIndex( comboCols );
+            MV.embeddingBlock.DataFrameFromColumnIndex( comboCols );
 
         // Must use thread local Parameters since columns have been embedded
         // and are different than base Parameters. x_t -> x_t(t-0)...
@@ -554,7 +558,7 @@ void EvalComboThread( MultiviewClass                       & MV,
             std::lock_guard<std::mutex> lck( EDM_Multiview::mtx );
             std::cout << ve.rho << std::endl;
             std::cout << "-------------- embedding -------------------\n";
-            std::cout << S.embedding;
+            std::cout << S.embedding.Materialize();
             std::cout << "-------------- comboData -------------------\n";
             std::cout << comboData;
         }
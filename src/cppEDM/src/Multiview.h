@@ -19,6 +19,8 @@ public:
     std::string          predictOutputFileIn; // copy from parameters
     std::vector<size_t>  predictionIn;        // copy from parameters
 
+    DataFrame< double >  embeddingBlock;      // combo column subsets
+
     struct MultiviewValues MVvalues; // output structure
     
     // Constructor
@@ -0,0 +1,122 @@
+#ifndef NEIGHBORTABLE_H
+#define NEIGHBORTABLE_H
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Library row index of a neighbor: embeddings are limited to 2^32 rows
+using NeighborIndex = uint32_t;
+
+//----------------------------------------------------------------
+// NeighborTable class
+// The knn nearest library neighbors of each prediction row,
+// sorted by distance, packed row major with stride knn:
+//   Neighbors( row )[ k ] : library row of neighbor k
+//   Distance( row, k )    : distance of neighbor k
+// Distances are float if the pred : lib distances were computed in
+// singlePrecision, else double. Neighbors beyond those found have
+// NaN distance and library row 0.
+//
+// Simplex ties of the knn-th neighbor distance are in a flat CSR
+// overflow: the tied library rows of prediction row, from the knn-th
+// neighbor on, are
+//   Ties( row )[ 0, NTies( row ) )
+// with TieFirstIndex( row ) the first knn neighbor of that distance.
+//
+// Rows are written in order: Neighbors(), SetDistance(), then any
+// AddTie() of the row, then EndRow().
+//----------------------------------------------------------------
+class NeighborTable {
+
+    size_t                       n_rows;
+    size_t                       knn;
+    bool                         singlePrecision;
+    std::vector< NeighborIndex > neighbors;      // n_rows x knn
+    std::vector< double >        distances;      // n_rows x knn, or
+    std::vector< float >         distancesFloat; // singlePrecision
+    std::vector< size_t >        tieOffset;      // n_rows + 1 into ties
+    std::vector< NeighborIndex > tieFirstIndex;  // n_rows
+    std::vector< NeighborIndex > ties;           // CSR tied library rows
+
+public:
+    NeighborTable() : n_rows( 0 ), knn( 0 ), singlePrecision( false ) {}
+
+    NeighborTable( size_t rows, size_t k, bool single ) :
+        n_rows( rows ), knn( k ), singlePrecision( single ),
+        neighbors( rows * k, 0 ),
+        tieOffset( rows + 1, 0 ), tieFirstIndex( rows, 0 )
+    {
+        if ( singlePrecision ) {
+            distancesFloat.assign( rows * k, nanf( "knn" ) );
+        }
+        else {
+            distances.assign( rows * k, nan( "knn" ) );
+        }
+    }
+
+    size_t NRows()    const { return n_rows; }
+    size_t NColumns() const { return knn;    }
+
+    const NeighborIndex *Neighbors( size_t row ) const {
+        return neighbors.data() + row * knn;
+    }
+    NeighborIndex *Neighbors( size_t row ) {
+        return neighbors.data() + row * knn;
+    }
+
+    double Distance( size_t row, size_t k ) const {
+        return singlePrecision ? distancesFloat[ row * knn + k ] :
+                                 distances     [ row * knn + k ];
+    }
+
+    void SetDistance( size_t row, size_t k, double distance ) {
+        if ( singlePrecision ) {
+            distancesFloat[ row * knn + k ] = (float) distance;
+        }
+        else {
+            distances[ row * knn + k ] = distance;
+        }
+    }
+
+    //-----------------------------------------------------------------
+    // The knn distances of row as double: in place, or if
+    // singlePrecision widened into buffer of knn elements
+    //-----------------------------------------------------------------
+    const double *Distances( size_t row, double *buffer ) const {
+        if ( not singlePrecision ) {
+            return distances.data() + row * knn;
+        }
+        const float *rowFloat = distancesFloat.data() + row * knn;
+        for ( size_t k = 0; k < knn; k++ ) {
+            buffer[ k ] = rowFloat[ k ];
+        }
+        return buffer;
+    }
+
+    //-----------------------------------------------------------------
+    // Tie overflow
+    //-----------------------------------------------------------------
+    bool   AnyTies() const { return ties.size() > 0; }
+    bool   Tie   ( size_t row ) const { return NTies( row ) > 0; }
+    size_t NTies ( size_t row ) const {
+        return tieOffset[ row + 1 ] - tieOffset[ row ];
+    }
+    const NeighborIndex *Ties( size_t row ) const {
+        return ties.data() + tieOffset[ row ];
+    }
+    size_t TieFirstIndex( size_t row ) const {
+        return tieFirstIndex[ row ];
+    }
+
+    void SetTieFirstIndex( size_t row, size_t firstIndex ) {
+        tieFirstIndex[ row ] = (NeighborIndex) firstIndex;
+    }
+    void AddTie( size_t libRow ) {
+        ties.push_back( (NeighborIndex) libRow );
+    }
+    void EndRow( size_t row ) {
+        tieOffset[ row + 1 ] = ties.size();
+    }
+};
+#endif
@@ -0,0 +1,297 @@
+
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <queue>
+
+#include "API.h"
+
+//----------------------------------------------------------------
+// run( i ) of each series i of a panel in nThreads threads taking
+// series from an atomic counter. The first exception of a series
+// is rethrown with the series number (1-offset).
+//----------------------------------------------------------------
+template< class Run >
+static void PanelRun( std::string call, size_t nSeries, unsigned nThreads,
+                      Run & run ) {
+
+    std::atomic< std::size_t >       seriesCount( 0 );
+    std::queue< std::exception_ptr > exceptQ;
+    std::mutex                       q_mtx;
+
+    auto worker = [&]() {
+        std::size_t i = std::atomic_fetch_add( &seriesCount, std::size_t(1) );
+
+        while ( i < nSeries ) {
+            try {
+                run( i );
+            }
+            catch ( std::exception & e ) {
+                // push exception pointer onto queue to rethrow, and
+                // stop all workers
+                std::stringstream errMsg;
+                errMsg << call << "(): series " << i + 1 << ": " << e.what();
+
+                std::lock_guard<std::mutex> lck( q_mtx );
+                exceptQ.push( std::make_exception_ptr(
+                                  std::runtime_error( errMsg.str() ) ) );
+                std::atomic_store( &seriesCount, nSeries );
+            }
+            catch(...) {
+                std::lock_guard<std::mutex> lck( q_mtx );
+                exceptQ.push( std::current_exception() );
+                std::atomic_store( &seriesCount, nSeries );
+            }
+
+            i = std::atomic_fetch_add( &seriesCount, std::size_t(1) );
+        }
+    };
+
+    unsigned maxThreads = std::thread::hardware_concurrency();
+    if ( maxThreads and maxThreads < nThreads ) { nThreads = maxThreads; }
+    if ( nThreads > nSeries ) { nThreads = (unsigned) nSeries; }
+    if ( nThreads < 1       ) { nThreads = 1; }
+
+    if ( nThreads == 1 ) {
+        worker();
+    }
+    else {
+        // thread container
+        std::vector< std::thread > threads;
+        for ( unsigned t = 0; t < nThreads; t++ ) {
+            threads.push_back( std::thread( worker ) );
+        }
+
+        // join threads
+        for ( auto &thrd : threads ) {
+            thrd.join();
+        }
+    }
+
+    // If a series threw exception, get from queue and rethrow
+    if ( not exceptQ.empty() ) {
+        std::rethrow_exception( exceptQ.front() );
+    }
+}
+
+//----------------------------------------------------------------
+// Outputs of the series concatenated in panel order, with the
+// series number (1-offset) in column 0 "series"
+//----------------------------------------------------------------
+static DataFrame< double > PanelCombine(
+    std::string                                call,
+    const std::vector< DataFrame< double > > & frames ) {
+
+    if ( frames.empty() ) {
+        return DataFrame< double >();
+    }
+
+    const DataFrame< double > & first = frames[ 0 ];
+
+    size_t nRows = 0;
+    for ( auto & frame : frames ) {
+        if ( frame.NColumns() != first.NColumns() or
+             frame.Time().empty() != first.Time().empty() ) {
+            std::stringstream errMsg;
+            errMsg << call << "(): series outputs differ in columns or time.\n";
+            throw std::runtime_error( errMsg.str() );
+        }
+        nRows += frame.NRows();
+    }
+
+    std::vector< std::string > columnNames( 1, "series" );
+    columnNames.insert( columnNames.end(), first.ColumnNames().begin(),
+                        first.ColumnNames().end() );
+
+    DataFrame< double > combined( nRows, first.NColumns() + 1, columnNames );
+
+    if ( first.Time().size() ) {
+        combined.TimeName() = first.TimeName();
+        combined.Time().reserve( nRows );
+    }
+
+    size_t row = 0;
+    for ( size_t s = 0; s < frames.size(); s++ ) {
+        const DataFrame< double > & frame = frames[ s ];
+
+        for ( size_t i = 0; i < frame.NRows(); i++ ) {
+            DataFrameSpan< double >       out = combined.RowSpan( row++ );
+            DataFrameSpan< const double > in  = frame.RowSpan( i );
+
+            out[ 0 ] = (double) ( s + 1 );
+            std::copy( in.data(), in.data() + in.size(), out.data() + 1 );
+        }
+
+        if ( first.Time().size() ) {
+            combined.Time().insert( combined.Time().end(),
+                                    frame.Time().begin(), frame.Time().end() );
+        }
+    }
+
+    return combined;
+}
+
+//----------------------------------------------------------------
+// Series of a long format data frame: the rows of each value of
+// seriesColumn, in order of first appearance, with all columns
+//----------------------------------------------------------------
+std::vector< DataFrame< double > > PanelSeries(
+    const DataFrame< double > & dataFrameIn,
+    std::string                 seriesColumn ) {
+
+    DataFrameSpan< const double > series =
+        dataFrameIn.ColumnSpanName( seriesColumn );
+
+    std::map< double, size_t >           seriesIndex;
+    std::vector< std::vector< size_t > > seriesRows;
+
+    for ( size_t row = 0; row < series.size(); row++ ) {
+        auto index = seriesIndex.insert(
+            std::make_pair( series[ row ], seriesRows.size() ) );
+        if ( index.second ) {
+            seriesRows.push_back( std::vector< size_t >() );
+        }
+        seriesRows[ index.first->second ].push_back( row );
+    }
+
+    std::vector< DataFrame< double > > panel;
+    panel.reserve( seriesRows.size() );
+    for ( auto & rows : seriesRows ) {
+        panel.push_back( dataFrameIn.DataFrameFromRowIndex( rows ) );
+    }
+
+    return panel;
+}
+
+//----------------------------------------------------------------
+// Simplex of each series of the panel with the same parameters
+//----------------------------------------------------------------
+PanelValues SimplexPanel( std::vector< DataFrame< double > > & panel,
+                          std::string lib,
+                          std::string pred,
+                          int         E,
+                          int         Tp,
+                          int         knn,
+                          int         tau,
+                          int         exclusionRadius,
+                          std::string colNames,
+                          std::string targetName,
+                          bool        embedded,
+                          bool        const_predict,
+                          bool        verbose,
+                          bool        exactExp,
+                          bool        singlePrecision,
+                          std::string metric,
+                          std::string metricScales,
+                          unsigned    nThreads ) {
+
+    std::vector< DataFrame< double > > projections( panel.size() );
+
+    auto run = [&]( size_t i ) {
+        // Simplex() deletes the partial data rows of its data: a copy,
+        // sharing the elements of the series (copy-on-write)
+        DataFrame< double > data( panel[ i ] );
+
+        projections[ i ] = Simplex( std::ref( data ),
+                                    "",              // pathOut
+                                    "",              // predictFile
+                                    lib,
+                                    pred,
+                                    E,
+                                    Tp,
+                                    knn,
+                                    tau,
+                                    exclusionRadius,
+                                    colNames,
+                                    targetName,
+                                    embedded,
+                                    const_predict,
+                                    verbose,
+                                    exactExp,
+                                    singlePrecision,
+                                    false,           // partialDistance
+                                    metric,
+                                    metricScales );
+    };
+
+    PanelRun( "SimplexPanel", panel.size(), nThreads, run );
+
+    PanelValues values = PanelValues();
+    values.predictions = PanelCombine( "SimplexPanel", projections );
+
+    return values;
+}
+
+//----------------------------------------------------------------
+// SMap of each series of the panel with the same parameters.
+// Each series is solved in one thread: series are the parallel work.
+//----------------------------------------------------------------
+PanelValues SMapPanel( std::vector< DataFrame< double > > & panel,
+                       std::string lib,
+                       std::string pred,
+                       int         E,
+                       int         Tp,
+                       int         knn,
+                       int         tau,
+                       double      theta,
+                       int         exclusionRadius,
+                       std::string columns,
+                       std::string target,
+                       bool        embedded,
+                       bool        const_predict,
+                       bool        verbose,
+                       bool        exactExp,
+                       std::string solverName,
+                       double      ridge,
+                       bool        singlePrecision,
+                       std::string metric,
+                       std::string metricScales,
+                       unsigned    nThreads ) {
+
+    std::vector< DataFrame< double > > projections ( panel.size() );
+    std::vector< DataFrame< double > > coefficients( panel.size() );
+
+    auto run = [&]( size_t i ) {
+        DataFrame< double > data( panel[ i ] ); // as SimplexPanel()
+
+        SMapValues values = SMap( std::ref( data ),
+                                  "",              // pathOut
+                                  "",              // predictFile
+                                  lib,
+                                  pred,
+                                  E,
+                                  Tp,
+                                  knn,
+                                  tau,
+                                  theta,
+                                  exclusionRadius,
+                                  columns,
+                                  target,
+                                  "",              // smapFile
+                                  "",              // derivatives
+                                  embedded,
+                                  const_predict,
+                                  verbose,
+                                  exactExp,
+                                  solverName,
+                                  ridge,
+                                  0,               // weightCutoff
+                                  1,               // weightFraction
+                                  1,               // nThreads
+                                  singlePrecision,
+                                  false,           // partialDistance
+                                  metric,
+                                  metricScales );
+
+        projections [ i ] = values.predictions;
+        coefficients[ i ] = values.coefficients;
+    };
+
+    PanelRun( "SMapPanel", panel.size(), nThreads, run );
+
+    PanelValues values  = PanelValues();
+    values.predictions  = PanelCombine( "SMapPanel", projections  );
+    values.coefficients = PanelCombine( "SMapPanel", coefficients );
+
+    return values;
+}
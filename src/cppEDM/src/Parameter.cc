@@ -42,7 +42,26 @@ Parameters::Parameters(
     bool        randomLib,
     bool        replacement,
     unsigned    seed,
-    bool        includeData
+    bool        includeData,
+
+    bool        exactExp,
+
+    std::string solver_str,
+    double      ridge,
+
+    double      weightCutoff,
+    double      weightFraction,
+
+    unsigned    nThreads,
+
+    bool        singlePrecision,
+    bool        partialDistance,
+
+    std::string metric_str,
+    std::string metricScales_str,
+
+    int         approxTrees,
+    int         recallSample
     ) :
     // Variable initialization from Parameters arguments
     method           ( method ),
@@ -84,6 +103,27 @@ Parameters::Parameters(
     seed             ( seed ),
     includeData      ( includeData ),
 
+    exactExp         ( exactExp ),
+
+    solver_str       ( solver_str ),
+    solver           ( SMapSolver::SVD ),
+    ridge            ( ridge ),
+
+    weightCutoff     ( weightCutoff ),
+    weightFraction   ( weightFraction ),
+
+    nThreads         ( nThreads ),
+
+    singlePrecision  ( singlePrecision ),
+    partialDistance  ( partialDistance ),
+
+    metric_str       ( metric_str ),
+    metric           ( DistanceMetric::Euclidean ),
+    metricScales_str ( metricScales_str ),
+
+    approxTrees      ( approxTrees ),
+    recallSample     ( recallSample ),
+
     // Set validated flag and instantiate Version
     validated        ( false ),
     version          ( 1, 7, 5, "2021-01-13" )
@@ -593,6 +633,146 @@ void Parameters::Validate() {
         }
     }
 
+    //--------------------------------------------------------------
+    // SMap solver and ridge regularization
+    //--------------------------------------------------------------
+    std::string solverName = ToLower( solver_str );
+    if      ( solverName == "svd"      ) { solver = SMapSolver::SVD;      }
+    else if ( solverName == "qr"       ) { solver = SMapSolver::QR;       }
+    else if ( solverName == "cholesky" ) { solver = SMapSolver::Cholesky; }
+    else {
+        std::stringstream errMsg;
+        errMsg << "Parameters::Validate(): SMap solver " << solver_str
+               << " is not SVD, QR or Cholesky.\n";
+        throw std::runtime_error( errMsg.str() );
+    }
+
+    if ( ridge < 0 ) {
+        std::string errMsg( "Parameters::Validate(): "
+                            "ridge must be non-negative.\n" );
+        throw std::runtime_error( errMsg );
+    }
+    if ( ridge > 0 and solver != SMapSolver::Cholesky ) {
+        std::string errMsg( "Parameters::Validate(): "
+                            "ridge requires the Cholesky solver.\n" );
+        throw std::runtime_error( errMsg );
+    }
+
+    //--------------------------------------------------------------
+    // SMap weight truncation
+    //--------------------------------------------------------------
+    if ( not ( weightCutoff >= 0 and weightCutoff < 1 ) ) {
+        std::string errMsg( "Parameters::Validate(): "
+                            "weightCutoff must be in [0, 1).\n" );
+        throw std::runtime_error( errMsg );
+    }
+    if ( not ( weightFraction > 0 and weightFraction <= 1 ) ) {
+        std::string errMsg( "Parameters::Validate(): "
+                            "weightFraction must be in (0, 1].\n" );
+        throw std::runtime_error( errMsg );
+    }
+
+    //--------------------------------------------------------------
+    // Partial distance search: CCM subsets the full distance matrix
+    //--------------------------------------------------------------
+    if ( partialDistance and method == Method::CCM ) {
+        std::string errMsg( "Parameters::Validate(): "
+                            "partialDistance is not available for CCM.\n" );
+        throw std::runtime_error( errMsg );
+    }
+
+    //--------------------------------------------------------------
+    // Neighbor distance metric
+    //--------------------------------------------------------------
+    std::string metricName = ToLower( metric_str );
+    if      ( metricName == "euclidean" ) {
+        metric = DistanceMetric::Euclidean;
+    }
+    else if ( metricName == "squaredeuclidean" ) {
+        metric = DistanceMetric::SquaredEuclidean;
+    }
+    else if ( metricName == "manhattan" ) {
+        metric = DistanceMetric::Manhattan;
+    }
+    else if ( metricName == "chebyshev" ) {
+        metric = DistanceMetric::Chebyshev;
+    }
+    else if ( metricName == "weightedeuclidean" ) {
+        metric = DistanceMetric::WeightedEuclidean;
+    }
+    else {
+        std::stringstream errMsg;
+        errMsg << "Parameters::Validate(): metric " << metric_str
+               << " is not Euclidean, SquaredEuclidean, Manhattan, "
+               << "Chebyshev or WeightedEuclidean.\n";
+        throw std::runtime_error( errMsg.str() );
+    }
+
+    // WeightedEuclidean scales, one for each embedding column
+    metricScales.clear();
+    if ( metricScales_str.size() ) {
+        std::vector<std::string> scale_vec = SplitString( metricScales_str,
+                                                          " \t," );
+        for ( auto si = scale_vec.begin(); si != scale_vec.end(); ++si ) {
+            double scale = 0;
+            try {
+                scale = std::stod( *si );
+            }
+            catch ( const std::exception & ) {
+                std::stringstream errMsg;
+                errMsg << "Parameters::Validate(): metricScales "
+                       << *si << " is not a number.\n";
+                throw std::runtime_error( errMsg.str() );
+            }
+            if ( not ( scale > 0 ) ) {
+                std::stringstream errMsg;
+                errMsg << "Parameters::Validate(): metricScales "
+                       << *si << " must be positive.\n";
+                throw std::runtime_error( errMsg.str() );
+            }
+            metricScales.push_back( scale );
+        }
+    }
+
+    if ( metric == DistanceMetric::WeightedEuclidean and
+         not metricScales.size() ) {
+        std::string errMsg( "Parameters::Validate(): "
+                            "WeightedEuclidean requires metricScales.\n" );
+        throw std::runtime_error( errMsg );
+    }
+    if ( metricScales.size() and
+         metric != DistanceMetric::WeightedEuclidean ) {
+        std::string errMsg( "Parameters::Validate(): "
+                            "metricScales requires WeightedEuclidean.\n" );
+        throw std::runtime_error( errMsg );
+    }
+
+    //--------------------------------------------------------------
+    // Approximate neighbor search and its recall diagnostic
+    //--------------------------------------------------------------
+    if ( approxTrees < 0 or recallSample < 0 ) {
+        std::string errMsg( "Parameters::Validate(): "
+                            "approxTrees and recallSample must be "
+                            "non-negative.\n" );
+        throw std::runtime_error( errMsg );
+    }
+    if ( approxTrees and method == Method::CCM ) {
+        std::string errMsg( "Parameters::Validate(): "
+                            "approxTrees is not available for CCM.\n" );
+        throw std::runtime_error( errMsg );
+    }
+    if ( approxTrees and partialDistance ) {
+        std::string errMsg( "Parameters::Validate(): "
+                            "approxTrees and partialDistance are "
+                            "exclusive.\n" );
+        throw std::runtime_error( errMsg );
+    }
+    if ( recallSample and not approxTrees ) {
+        std::string errMsg( "Parameters::Validate(): "
+                            "recallSample requires approxTrees.\n" );
+        throw std::runtime_error( errMsg );
+    }
+
 #ifdef DEBUG_ALL
     PrintIndices( library, prediction );
 #endif
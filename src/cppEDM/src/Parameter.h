@@ -61,6 +61,28 @@ public: // No need for protected or private
     unsigned    seed;             // CCM random selection RNG seed
     bool        includeData;      // CCM include all simplex projection results
 
+    bool        exactExp;         // libm exp() for Simplex/SMap weights
+
+    std::string solver_str;       // SMap solver name: SVD, QR, Cholesky
+    SMapSolver  solver;           // SMap linear system solver
+    double      ridge;            // SMap Cholesky ridge regularization
+
+    double      weightCutoff;     // SMap drop weights < cutoff * max weight
+    double      weightFraction;   // SMap keep this fraction of weight sum
+
+    unsigned    nThreads;         // SMap prediction row threads
+
+    bool        singlePrecision;  // float embedding and distances
+    bool        partialDistance;  // knn partial distance search
+
+    std::string    metric_str;    // neighbor distance metric name
+    DistanceMetric metric;        // neighbor distance metric
+    std::string    metricScales_str;
+    std::vector< double > metricScales; // WeightedEuclidean column scales
+
+    int         approxTrees;      // approximate knn projection trees
+    int         recallSample;     // approximate knn recall sample rows
+
     bool        validated;
 
     Version version; // Version object, instantiated in constructor
@@ -105,7 +127,26 @@ public: // No need for protected or private
         bool        randomLib         = true,
         bool        replacement       = false,
         unsigned    seed              = 0,  // 0: Generate random seed in CCM
-        bool        includeData       = false
+        bool        includeData       = false,
+
+        bool        exactExp          = false,
+
+        std::string solver_str        = "SVD",
+        double      ridge             = 0,
+
+        double      weightCutoff      = 0,
+        double      weightFraction    = 1,
+
+        unsigned    nThreads          = 1,
+
+        bool        singlePrecision   = false,
+        bool        partialDistance   = false,
+
+        std::string metric_str        = "Euclidean",
+        std::string metricScales_str  = "",
+
+        int         approxTrees       = 0,
+        int         recallSample      = 0
     );
 
     ~Parameters();
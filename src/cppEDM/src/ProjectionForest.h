@@ -0,0 +1,348 @@
+#ifndef PROJECTIONFOREST_H
+#define PROJECTIONFOREST_H
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "ModelFile.h"
+#include "NeighborTable.h"
+
+//----------------------------------------------------------------
+// ProjectionForest class
+// Random projection trees of the library embedding vectors for the
+// approximate knn search.
+//
+// Each tree splits the library rows of a node by the hyperplane
+// bisecting two random rows of the node, until a node holds at most
+// leafSize rows. A split of node with normal w and offset b sends
+// vector x to the left child if margin = w . x + b > 0.
+//
+// Search() visits the leaves of all trees best first by the smallest
+// margin on the path to the leaf, calling visit( begin, end ) with
+// the library rows of each leaf until visit returns false. More trees
+// visit more of the true neighbors: the accuracy knob.
+//
+// Vectors are addressed as in EmbeddingView: element j of the vector
+// at x is x[ offset[ j ] ]. Scales divide the coordinates before the
+// split (WeightedEuclidean), folded into the stored normals.
+//----------------------------------------------------------------
+class ProjectionForest {
+
+    struct Node {
+        bool   leaf;
+        size_t begin;  // leaf library rows [ begin, end ) of items
+        size_t end;
+        size_t normal; // split normal at normals[ normal ]
+        double offset; // split offset
+        size_t left;   // split children
+        size_t right;
+    };
+
+    size_t                       nDim;
+    size_t                       leafSize;
+    std::vector< Node >          nodes;
+    std::vector< size_t >        roots;   // root node of each tree
+    std::vector< double >        normals; // nDim per split node
+    std::vector< NeighborIndex > items;   // library rows of each tree
+
+    // Insert(): end of the room of each leaf in items, and the
+    // split hyperplane generator continued from Build()
+    std::vector< size_t >        limit;
+    std::mt19937                 generator;
+
+    template< class T >
+    double Margin( const Node & node, const T * x,
+                   const size_t * offset ) const {
+        const double *w = normals.data() + node.normal;
+        double margin = node.offset;
+        for ( size_t j = 0; j < nDim; j++ ) {
+            margin += w[ j ] * x[ offset[ j ] ];
+        }
+        return margin;
+    }
+
+    //-----------------------------------------------------------------
+    // Split leaf n of more than leafSize rows into two leaves of its
+    // rows, in place in items. False if n remains a leaf.
+    //-----------------------------------------------------------------
+    template< class T >
+    bool Split( size_t          n,
+                const T       * source,
+                size_t          stride,
+                const size_t  * offset,
+                const T       * invScale ) {
+
+        size_t first = nodes[ n ].begin;
+        size_t last  = nodes[ n ].end;
+        if ( last - first <= leafSize ) {
+            return false; // leaf
+        }
+
+        std::uniform_int_distribution< size_t > pick( first, last - 1 );
+
+        size_t normal = normals.size();
+        normals.resize( normal + nDim );
+        double *w = normals.data() + normal;
+
+        Node   node = nodes[ n ];
+        size_t mid  = first;
+
+        // Hyperplane bisecting two random rows, retried if all
+        // rows fall on one side (repeated vectors)
+        for ( int attempt = 0; attempt < 3; attempt++ ) {
+            size_t a = pick( generator );
+            size_t b = pick( generator );
+            if ( a == b ) {
+                b = a + 1 < last ? a + 1 : first;
+            }
+            const T *xa = source + items[ a ] * stride;
+            const T *xb = source + items[ b ] * stride;
+
+            // Squared inverse scales fold into the normal
+            node.offset = 0;
+            for ( size_t j = 0; j < nDim; j++ ) {
+                double scale2 = invScale ?
+                    (double) invScale[ j ] * invScale[ j ] : 1;
+                double va = xa[ offset[ j ] ];
+                double vb = xb[ offset[ j ] ];
+                w[ j ]       = ( va - vb ) * scale2;
+                node.offset -= w[ j ] * ( va + vb ) / 2;
+            }
+
+            node.normal = normal;
+            auto it = std::partition(
+                items.begin() + first, items.begin() + last,
+                [&]( NeighborIndex row ) {
+                    return Margin( node, source + row * stride,
+                                   offset ) > 0;
+                } );
+            mid = it - items.begin();
+
+            if ( mid != first and mid != last ) {
+                break;
+            }
+        }
+
+        if ( mid == first or mid == last ) {
+            // No separating hyperplane: halve the node, the
+            // search visits both halves at margin 0
+            std::fill( w, w + nDim, 0. );
+            node.offset = 0;
+            mid = first + ( last - first ) / 2;
+        }
+
+        node.leaf  = false;
+        node.left  = nodes.size();
+        node.right = nodes.size() + 1;
+        nodes[ n ] = node;
+
+        nodes.push_back( Node{ true, first, mid,  0, 0, 0, 0 } );
+        nodes.push_back( Node{ true, mid,   last, 0, 0, 0, 0 } );
+        return true;
+    }
+
+public:
+    ProjectionForest() : nDim( 0 ), leafSize( 0 ) {}
+
+    size_t NTrees()   const { return roots.size(); }
+    size_t LeafSize() const { return leafSize;     }
+
+    //-----------------------------------------------------------------
+    // Build nTrees trees of the nLib library rows libRows, with
+    // source row r at source + r * stride. invScale: 1 / scale of
+    // each column, or nullptr.
+    //-----------------------------------------------------------------
+    template< class T >
+    void Build( const T             * source,
+                size_t                stride,
+                const size_t        * offset,
+                size_t                nDimensions,
+                const T             * invScale,
+                const NeighborIndex * libRows,
+                size_t                nLib,
+                size_t                nTrees,
+                size_t                leafRows,
+                unsigned              seed ) {
+
+        nDim     = nDimensions;
+        leafSize = std::max( leafRows, (size_t) 1 );
+        nodes.clear();
+        roots.clear();
+        normals.clear();
+        items.clear();
+        items.reserve( nTrees * nLib );
+        generator.seed( seed );
+
+        std::vector< size_t > split; // nodes to split
+
+        for ( size_t tree = 0; tree < nTrees; tree++ ) {
+
+            size_t begin = items.size();
+            items.insert( items.end(), libRows, libRows + nLib );
+
+            roots.push_back( nodes.size() );
+            nodes.push_back( Node{ true, begin, items.size(), 0, 0, 0, 0 } );
+            split.push_back( roots.back() );
+
+            while ( split.size() ) {
+                size_t n = split.back();
+                split.pop_back();
+
+                if ( Split( n, source, stride, offset, invScale ) ) {
+                    split.push_back( nodes[ n ].left  );
+                    split.push_back( nodes[ n ].right );
+                }
+            }
+        }
+
+        limit.assign( nodes.size(), 0 );
+        for ( size_t n = 0; n < nodes.size(); n++ ) {
+            limit[ n ] = nodes[ n ].end;
+        }
+    }
+
+    //-----------------------------------------------------------------
+    // Insert library row into the leaf of each tree, addressed as in
+    // Build(). A leaf is moved to the end of items with room to grow
+    // when full, and split when it holds 2 leafSize rows: the cost is
+    // that of a Search() path, not of the rows indexed.
+    //-----------------------------------------------------------------
+    template< class T >
+    void Insert( NeighborIndex   row,
+                 const T       * source,
+                 size_t          stride,
+                 const size_t  * offset,
+                 const T       * invScale ) {
+
+        const T *x = source + row * stride;
+
+        for ( size_t root : roots ) {
+            size_t n = root;
+            while ( not nodes[ n ].leaf ) {
+                n = Margin( nodes[ n ], x, offset ) > 0 ? nodes[ n ].left :
+                                                          nodes[ n ].right;
+            }
+
+            Node & leaf = nodes[ n ];
+            if ( leaf.end == limit[ n ] ) {
+                // Full: move the leaf rows to the end of items
+                size_t count = leaf.end - leaf.begin;
+                size_t begin = items.size();
+                items.resize( begin + 2 * count + 1 );
+                std::copy( items.begin() + leaf.begin,
+                           items.begin() + leaf.end, items.begin() + begin );
+                leaf.begin = begin;
+                leaf.end   = begin + count;
+                limit[ n ] = items.size();
+            }
+            items[ leaf.end++ ] = row;
+
+            if ( leaf.end - leaf.begin >= 2 * leafSize and
+                 Split( n, source, stride, offset, invScale ) ) {
+                // Children partition the leaf, the right has its room
+                limit.resize( nodes.size(), 0 );
+                limit[ nodes[ n ].left  ] = nodes[ nodes[ n ].left  ].end;
+                limit[ nodes[ n ].right ] = limit[ n ];
+            }
+        }
+    }
+
+    //-----------------------------------------------------------------
+    // Model file sections, see ModelFile.h
+    //-----------------------------------------------------------------
+    void Save( ModelFileWriter & file ) const {
+        file.Scalar< uint64_t >( nDim );
+        file.Scalar< uint64_t >( leafSize );
+        file.Array( nodes );
+        file.Array( roots );
+        file.Array( normals );
+        file.Array( items );
+    }
+
+    void Load( ModelFileReader & file ) {
+        nDim     = file.Scalar< uint64_t >();
+        leafSize = file.Scalar< uint64_t >();
+        nodes    = file.Vector< Node >();
+        roots    = file.Vector< size_t >();
+        normals  = file.Vector< double >();
+        items    = file.Vector< NeighborIndex >();
+
+        // Node ranges within the forest arrays
+        bool valid = true;
+        for ( const Node & node : nodes ) {
+            if ( node.leaf ) {
+                valid = valid and node.begin <= node.end and
+                        node.end <= items.size();
+            }
+            else {
+                valid = valid and node.left < nodes.size() and
+                        node.right < nodes.size() and
+                        node.normal + nDim <= normals.size();
+            }
+        }
+        for ( size_t root : roots ) {
+            valid = valid and root < nodes.size();
+        }
+        if ( not valid ) {
+            throw std::runtime_error( "ProjectionForest::Load(): "
+                                      "invalid forest.\n" );
+        }
+
+        limit.assign( nodes.size(), 0 );
+        for ( size_t n = 0; n < nodes.size(); n++ ) {
+            limit[ n ] = nodes[ n ].end;
+        }
+        generator.seed( (unsigned) nodes.size() );
+    }
+
+    // Largest library row of the leaves + 1, 0 if empty
+    size_t RowsIndexed() const {
+        return items.size() ?
+            (size_t) *std::max_element( items.begin(), items.end() ) + 1 : 0;
+    }
+
+    //-----------------------------------------------------------------
+    // Visit the leaves of all trees for the vector x, best first:
+    // visit( const NeighborIndex *begin, const NeighborIndex *end )
+    // returns false to stop the search.
+    //-----------------------------------------------------------------
+    template< class T, class Visit >
+    void Search( const T * x, const size_t * offset, Visit & visit ) const {
+
+        // < priority, node >: the smallest margin on the path
+        std::priority_queue< std::pair< double, size_t > > queue;
+
+        for ( size_t root : roots ) {
+            queue.push( std::make_pair( std::numeric_limits<double>::max(),
+                                        root ) );
+        }
+
+        while ( queue.size() ) {
+            std::pair< double, size_t > top = queue.top();
+            queue.pop();
+
+            const Node & node = nodes[ top.second ];
+
+            if ( node.leaf ) {
+                if ( not visit( items.data() + node.begin,
+                                items.data() + node.end ) ) {
+                    return;
+                }
+                continue;
+            }
+
+            double margin = Margin( node, x, offset );
+            queue.push( std::make_pair( std::min( top.first,  margin ),
+                                        node.left ) );
+            queue.push( std::make_pair( std::min( top.first, -margin ),
+                                        node.right ) );
+        }
+    }
+};
+#endif
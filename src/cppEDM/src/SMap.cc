@@ -1,5 +1,9 @@
 
+#include <thread>
+
 #include "SMap.h"
+#include "EDM_Weights.h"
+#include "EDM_SMapKernels.h"
 
 // NOTE: Contains SMapClass method implementations, AND:
 //       General SVD functions: SVD, Lapack_SVD, dgelss_
@@ -24,6 +28,10 @@ void SMapClass::Project ( Solver solver ) {
 
     FindNeighbors();
 
+    if ( parameters.recallSample ) {
+        NeighborRecall( [this, solver]() { SMap( solver ); } ); // approxTrees
+    }
+
     SMap( solver );
 
     FormatOutput();  // Common formatting
@@ -31,14 +39,150 @@ void SMapClass::Project ( Solver solver ) {
     WriteOutput();   // SMap specific formatting & output
 }
 
+//----------------------------------------------------------------
+// ProjectMultiTarget : SMap of each target in targetNames
+// Each target is predicted from the same embedding and neighbors
+// as parameters.target, and the weighted system of each prediction
+// row is factored once with the targets as right hand side columns.
+// Output for each target is in multiValues, output files are not
+// written.
+//----------------------------------------------------------------
+void SMapClass::ProjectMultiTarget ( Solver                     solver,
+                                     std::vector< std::string > targetNames_ ) {
+
+    if ( targetNames_.empty() ) {
+        throw std::runtime_error( "SMapClass::ProjectMultiTarget(): "
+                                  "no targets.\n" );
+    }
+
+    GetTargets( targetNames_ );
+
+    std::string targetName = parameters.targetName;
+
+    PrepareEmbedding();
+
+    Distances(); // all pred : lib vector distances into allDistances
+
+    FindNeighbors();
+
+    SMap( solver );
+
+    // Format each target as Project(): FormatOutput(), WriteOutput()
+    std::string predictOutputFile  = parameters.predictOutputFile;
+    std::string SmapOutputFile     = parameters.SmapOutputFile;
+    parameters.predictOutputFile   = "";
+    parameters.SmapOutputFile      = "";
+
+    size_t Npred = knnTable.NRows();
+
+    multiValues.clear();
+    for ( size_t t = 0; t < targets.size(); t++ ) {
+        target       = targets[ t ];
+        predictions  = multiPredictions [ t ];
+        variance     = multiVariance    [ t ];
+        coefficients = multiCoefficients[ t ];
+
+        parameters.targetName = targetNames[ t ];
+
+        const_predictions = std::valarray< double >( 0., Npred );
+        if ( parameters.const_predict ) {
+            std::slice pred_slice =
+                std::slice( parameters.prediction[ 0 ],
+                            parameters.prediction.size(), 1 );
+
+            const_predictions = target[ pred_slice ];
+        }
+
+        FormatOutput();
+        WriteOutput();
+
+        SMapValues values = SMapValues();
+        values.predictions  = projection;
+        values.coefficients = coefficients;
+        values.truncation   = truncation;
+        multiValues.push_back( values );
+    }
+
+    parameters.targetName        = targetName;
+    parameters.predictOutputFile = predictOutputFile;
+    parameters.SmapOutputFile    = SmapOutputFile;
+}
+
+//----------------------------------------------------------------
+// ProjectRidgePath : SMap for each ridge regularization lambda
+// The weighted system of each prediction row is decomposed once by
+// WorkspaceRidgePath(), the solutions for all lambdas are diagonal
+// rescalings of the SVD. Output for each lambda is in multiValues,
+// output files are not written.
+//----------------------------------------------------------------
+void SMapClass::ProjectRidgePath ( Solver                solver,
+                                   std::vector< double > ridgePath_ ) {
+
+    if ( ridgePath_.empty() ) {
+        throw std::runtime_error( "SMapClass::ProjectRidgePath(): "
+                                  "no ridge values.\n" );
+    }
+    for ( auto lambda : ridgePath_ ) {
+        if ( not ( lambda >= 0 ) ) {
+            std::stringstream errMsg;
+            errMsg << "SMapClass::ProjectRidgePath(): ridge " << lambda
+                   << " must be non-negative.\n";
+            throw std::runtime_error( errMsg.str() );
+        }
+    }
+    if ( solver != &SVD ) {
+        throw std::runtime_error( "SMapClass::ProjectRidgePath(): "
+                                  "external solvers are not supported.\n" );
+    }
+
+    ridgePath = ridgePath_;
+
+    PrepareEmbedding();
+
+    Distances(); // all pred : lib vector distances into allDistances
+
+    FindNeighbors();
+
+    SMap( solver );
+
+    // Format each lambda as Project(): FormatOutput(), WriteOutput()
+    std::string predictOutputFile  = parameters.predictOutputFile;
+    std::string SmapOutputFile     = parameters.SmapOutputFile;
+    parameters.predictOutputFile   = "";
+    parameters.SmapOutputFile      = "";
+
+    multiValues.clear();
+    for ( size_t l = 0; l < ridgePath.size(); l++ ) {
+        predictions  = multiPredictions [ l ];
+        variance     = multiVariance    [ l ];
+        coefficients = multiCoefficients[ l ];
+
+        FormatOutput();
+        WriteOutput();
+
+        SMapValues values = SMapValues();
+        values.predictions  = projection;
+        values.coefficients = coefficients;
+        values.truncation   = truncation;
+        multiValues.push_back( values );
+    }
+
+    parameters.predictOutputFile = predictOutputFile;
+    parameters.SmapOutputFile    = SmapOutputFile;
+}
+
 //----------------------------------------------------------------
 // SMap algorithm
+// Solves for target, or for each of targets if set by
+// ProjectMultiTarget(), and for each lambda of ridgePath if set
+// by ProjectRidgePath(), into multiPredictions, multiVariance and
+// multiCoefficients: solution r * nRidge + l for target r, lambda l.
 //----------------------------------------------------------------
 void SMapClass::SMap ( Solver solver ) {
 
     // Allocate output vectors to populate EDM class projections DataFrame.
     // Must be after FindNeighbors()
-    size_t Npred = knn_neighbors.NRows();
+    size_t Npred = knnTable.NRows();
 
     predictions       = std::valarray< double > ( 0., Npred );
     const_predictions = std::valarray< double > ( 0., Npred );
@@ -49,100 +193,441 @@ void SMapClass::SMap ( Solver solver ) {
     coefficients = DataFrame< double >( Npred + abs( parameters.Tp ),
                                         parameters.E + 1 );
 
-    // Process each prediction row in neighbors : distances
-    for ( size_t row = 0; row < Npred; row++ ) {
+    SMapRowSetup setup;
 
-        size_t knn = knnSmap[ row ]; // knn is variable...
+    size_t N_col = parameters.E + 1; // intercept and E coefficients
 
-        // Average distance for knn
-        double Dsum = 0;
-        for ( size_t i = 0; i < knn_distances.Row( row ).size(); i++ ) {
-            if ( std::isnan( knn_distances( row, i ) ) ) {
-                break; // Presume first nan is contiguous at end
+    // Right hand side targets
+    if ( targets.empty() ) {
+        setup.rhsTarget.push_back( &target );
+    }
+    else {
+        for ( size_t t = 0; t < targets.size(); t++ ) {
+            setup.rhsTarget.push_back( &targets[ t ] );
+        }
+    }
+
+    size_t nrhs      = setup.rhsTarget.size();
+    size_t nRidge    = std::max( ridgePath.size(), size_t( 1 ) );
+    size_t nSolution = nrhs * nRidge;
+
+    setup.Npred     = Npred;
+    setup.N_col     = N_col;
+    setup.nrhs      = nrhs;
+    setup.nRidge    = nRidge;
+    setup.nSolution = nSolution;
+
+    // Solution outputs. Coefficients rows are written through row
+    // major pointers taken here, before the row workers, so that each
+    // solution DataFrame owns its (copy-on-write) elements
+    if ( nSolution == 1 and ridgePath.empty() ) {
+        setup.solPredictions .push_back( &predictions  );
+        setup.solVariance    .push_back( &variance     );
+        setup.solCoefficients.push_back( coefficients.RowSpan( 0 ).data() );
+    }
+    else {
+        multiPredictions .assign( nSolution, predictions  );
+        multiVariance    .assign( nSolution, variance     );
+        multiCoefficients.assign( nSolution, coefficients );
+
+        for ( size_t i = 0; i < nSolution; i++ ) {
+            setup.solPredictions .push_back( &multiPredictions [ i ] );
+            setup.solVariance    .push_back( &multiVariance    [ i ] );
+            setup.solCoefficients.push_back(
+                multiCoefficients[ i ].RowSpan( 0 ).data() );
+        }
+    }
+
+    // The default solver solves in the workspace buffers with the
+    // parameters.solver method: SVD (LAPACK dgelss), QR or Cholesky.
+    // External solvers are passed row major A and B by value as before.
+    setup.solver         = solver;
+    setup.workspaceSolve = ( solver == &SVD );
+    setup.solve          = &WorkspaceSVD;
+
+    switch ( parameters.solver ) {
+    case SMapSolver::SVD:      setup.solve = &WorkspaceSVD;      break;
+    case SMapSolver::QR:       setup.solve = &WorkspaceQR;       break;
+    case SMapSolver::Cholesky: setup.solve = &WorkspaceCholesky; break;
+    }
+
+    // Cholesky with E <= 16 : compile-time sized normal equations
+    // kernels read the embedding in place, A is only built for SVD.
+    // Multiple targets use WorkspaceCholesky() on all nrhs at once.
+    setup.kernelSolve = setup.workspaceSolve and nrhs == 1 and
+                        ridgePath.empty() and
+                        parameters.solver == SMapSolver::Cholesky and
+                        N_col <= EDM_SMap::maxKernelN;
+
+    setup.embeddingData    = setup.kernelSolve ? embedding.RowBase( 0 ) :
+                                                 nullptr;
+    setup.embeddingStride  = embedding.Stride();
+    setup.embeddingOffsets = embedding.Offsets();
+
+    // Weight truncation drops the negligible exponential weights of
+    // distant neighbors before A and B are built. Not applied if
+    // theta = 0 where all weights are 1.
+    setup.truncate = parameters.theta > 0 and
+                     ( parameters.weightCutoff > 0 or
+                       parameters.weightFraction < 1 );
+
+    knnEffective.clear();
+    truncationBound = std::valarray< double >();
+
+    // max || [ 1, x ] ||^2 over embedding rows for truncationBound
+    setup.maxNorm2 = 0;
+
+    if ( setup.truncate ) {
+        knnEffective    = std::vector< size_t >( Npred, 0 );
+        truncationBound = std::valarray< double >( 0., Npred );
+
+        for ( size_t i = 0; i < embedding.NRows(); i++ ) {
+            double norm2 = 1;
+            for ( size_t j = 0; j < embedding.NColumns(); j++ ) {
+                norm2 += embedding( i, j ) * embedding( i, j );
             }
-            Dsum += knn_distances( row, i );
+            setup.maxNorm2 = std::max( setup.maxNorm2, norm2 );
         }
-        double Davg = Dsum / knn;
+    }
+
+    setup.targetLibRowOffset = parameters.Tp - embedShift;
+
+    //------------------------------------------------------------------
+    // Prediction rows are independent: nThreads workers take rows from
+    // an atomic counter, each with its own workspace. Each row writes
+    // only its own element or row of the outputs, so the results do
+    // not depend on the number of threads. External solvers are not
+    // assumed thread safe and are called from one thread.
+    //------------------------------------------------------------------
+    unsigned nThreads   = parameters.nThreads;
+    unsigned maxThreads = std::thread::hardware_concurrency();
+    if ( maxThreads and maxThreads < nThreads ) { nThreads = maxThreads; }
+    if ( nThreads > Npred            ) { nThreads = (unsigned) Npred; }
+    if ( not setup.workspaceSolve    ) { nThreads = 1; }
+    if ( nThreads < 1                ) { nThreads = 1; }
+
+    if ( threadWorkspaces.size() < nThreads - 1 ) {
+        threadWorkspaces.resize( nThreads - 1 );
+    }
+
+    std::vector< SMapWorkspace * > workspaces( 1, &workspace );
+    for ( unsigned t = 1; t < nThreads; t++ ) {
+        workspaces.push_back( &threadWorkspaces[ t - 1 ] );
+    }
 
-        // Weight vector w
-        std::valarray< double > w = std::valarray< double >( knn );
-        if ( parameters.theta > 0 ) {
-            double Dscale = parameters.theta / Davg;
+    for ( auto ws : workspaces ) {
+        ws->ridge     = parameters.ridge;
+        ws->nFallback = 0;
+
+        // Weights are computed for all knn before the workspace is
+        // shaped to the truncated knn
+        if ( ws->w.size() < knnTable.NColumns() ) {
+            ws->w.resize( knnTable.NColumns() );
+        }
+    }
+
+    std::atomic< std::size_t >       rowCount( 0 );
+    std::queue< std::exception_ptr > exceptQ;
+    std::mutex                       q_mtx;
+
+    if ( nThreads == 1 ) {
+        SMapRows( workspace, setup, rowCount, exceptQ, q_mtx );
+    }
+    else {
+        // thread container
+        std::vector< std::thread > threads;
+        for ( unsigned t = 0; t < nThreads; t++ ) {
+            threads.push_back( std::thread( &SMapClass::SMapRows,
+                                            this,
+                                            std::ref( *workspaces[ t ] ),
+                                            std::cref( setup ),
+                                            std::ref( rowCount ),
+                                            std::ref( exceptQ ),
+                                            std::ref( q_mtx ) ) );
+        }
+
+        // join threads
+        for ( auto &thrd : threads ) {
+            thrd.join();
+        }
+
+        for ( unsigned t = 1; t < nThreads; t++ ) {
+            workspace.nFallback += workspaces[ t ]->nFallback;
+        }
+    }
+
+    // If a row threw exception, get from queue and rethrow
+    if ( not exceptQ.empty() ) {
+        std::rethrow_exception( exceptQ.front() );
+    }
+
+    if ( parameters.verbose and workspace.nFallback ) {
+        std::stringstream msg;
+        msg << "SMapClass::SMap(): " << workspace.nFallback << " of "
+            << Npred << " ill-conditioned systems solved by SVD."
+            << std::endl;
+        std::cout << msg.str();
+    }
+
+    if ( parameters.verbose and setup.truncate and Npred ) {
+        double knnSum = 0;
+        for ( auto k : knnEffective ) {
+            knnSum += k;
+        }
+        std::stringstream msg;
+        msg << "SMapClass::SMap(): weight truncation mean knn "
+            << knnSum / Npred << " of " << knnTable.NColumns()
+            << ", max bound " << truncationBound.max() << std::endl;
+        std::cout << msg.str();
+    }
+
+    // non "predictions" X(t+1) = X(t) if const_predict specified
+    const_predictions = std::valarray< double >( 0., Npred );
+    if ( parameters.const_predict ) {
+        std::slice pred_slice =
+            std::slice( parameters.prediction[ 0 ],
+                        parameters.prediction.size(), 1 );
+
+        const_predictions = target[ pred_slice ];
+    }
+}
+
+//----------------------------------------------------------------
+// SMap() row worker: solve rows taken from the shared counter
+// in the thread's own workspace ws
+//----------------------------------------------------------------
+void SMapClass::SMapRows( SMapWorkspace                    & ws,
+                          const SMapRowSetup               & setup,
+                          std::atomic< std::size_t >       & rowCount,
+                          std::queue< std::exception_ptr > & exceptQ,
+                          std::mutex                       & q_mtx ) {
+
+    std::vector< std::valarray< double > > C_external( setup.nrhs );
+
+    std::size_t row = std::atomic_fetch_add( &rowCount, std::size_t(1) );
+
+    while ( row < setup.Npred ) {
+        try {
+            SMapRow( row, ws, setup, C_external );
+        }
+        catch(...) {
+            // push exception pointer onto queue for SMap() to rethrow,
+            // and stop all workers
+            std::lock_guard<std::mutex> lck( q_mtx );
+            exceptQ.push( std::current_exception() );
+            std::atomic_store( &rowCount, setup.Npred );
+        }
+
+        row = std::atomic_fetch_add( &rowCount, std::size_t(1) );
+    }
+}
+
+//----------------------------------------------------------------
+// SMap() prediction row: weights, local linear system and solution
+//----------------------------------------------------------------
+void SMapClass::SMapRow( size_t                                   row,
+                         SMapWorkspace                          & ws,
+                         const SMapRowSetup                     & setup,
+                         std::vector< std::valarray< double > > & C_external ) {
+
+    size_t N_col     = setup.N_col;
+    size_t nrhs      = setup.nrhs;
+    size_t nRidge    = setup.nRidge;
+    size_t nSolution = setup.nSolution;
+
+    size_t knn = knnSmap[ row ]; // knn is variable...
+
+    double *w = ws.w.data();
+
+    // Neighbor rows of the knnTable, read only by the row workers.
+    // Float distances are widened into w, then weighted in place.
+    const NeighborTable & neighbors   = knnTable;
+    const double        * distanceRow = neighbors.Distances( row, w );
+    const NeighborIndex * neighborRow = neighbors.Neighbors( row );
+
+    // Average distance for knn
+    double Dsum = 0;
+    for ( size_t i = 0; i < neighbors.NColumns(); i++ ) {
+        if ( std::isnan( distanceRow[ i ] ) ) {
+            break; // Presume first nan is contiguous at end
+        }
+        Dsum += distanceRow[ i ];
+    }
+    double Davg = Dsum / knn;
+
+    // Weight vector w
+    if ( parameters.theta > 0 ) {
+        double Dscale = parameters.theta / Davg;
+        for ( size_t k = 0; k < knn; k++ ) {
+            w[ k ] = -Dscale * distanceRow[ k ];
+        }
+        ExpWeights( w, knn, parameters.exactExp );
+    }
+    else {
+        std::fill( w, w + knn, 1. );
+    }
+
+    if ( setup.truncate ) {
+        size_t knnAll = knn;
+
+        knn = EDM_SMap::TruncateWeights( w, knnAll, N_col,
+                                         parameters.weightCutoff,
+                                         parameters.weightFraction );
+
+        // The dropped rows perturb the weighted normal equations
+        // G = sum w_k^2 a_k a_k', a_k = [ 1, x_k ], by dG with
+        // || dG || <= maxNorm2 sum_dropped w_k^2, while
+        // || G || >= trace( G ) / N_col
+        double droppedSum = 0;
+        for ( size_t k = knn; k < knnAll; k++ ) {
+            droppedSum += w[ k ] * w[ k ];
+        }
+
+        double traceG = 0;
+        if ( droppedSum > 0 ) {
             for ( size_t k = 0; k < knn; k++ ) {
-                w[ k ] = std::exp( -Dscale * knn_distances( row, k ) );
+                size_t libRowBase = neighborRow[ k ];
+                double norm2      = 1;
+                for ( size_t j = 1; j < N_col; j++ ) {
+                    double x = embedding( libRowBase, j - 1 );
+                    norm2 += x * x;
+                }
+                traceG += w[ k ] * w[ k ] * norm2;
             }
+            truncationBound[ row ] =
+                N_col * setup.maxNorm2 * droppedSum / traceG;
         }
-        else {
-            w = std::valarray< double >( 1, knn );
+
+        knnEffective[ row ] = knn;
+    }
+
+    ws.Shape( (int) knn, (int) N_col, (int) nrhs );
+
+    size_t ldb = std::max( knn, N_col ); // B column stride
+
+    double *A          = ws.A.data();
+    double *B          = ws.B.data();
+    double *B_noWeight = ws.B_noWeight.data(); // knn x nrhs
+
+    // Library targets for this row (observation)
+    for ( size_t r = 0; r < nrhs; r++ ) {
+        const std::valarray< double > & rhs = *setup.rhsTarget[ r ];
+        for ( size_t k = 0; k < knn; k++ ) {
+            int libRow = neighborRow[ k ] + setup.targetLibRowOffset;
+            B_noWeight[ r * knn + k ] = rhs[ libRow ]; // for "variance"
         }
+    }
 
-        // Allocate work space for solver, and target (B_noWeight)
-        DataFrame< double > A = DataFrame< double >( knn, parameters.E + 1 );
-        std::valarray< double > B          = std::valarray< double >( knn );
-        std::valarray< double > B_noWeight = std::valarray< double >( knn );
+    // Estimate linear mapping of predictions A onto target B
+    // Solution C of target r is in B[ r * ldb : r * ldb + N_col ],
+    // or of solution i in ws.X[ i * N_col ] for a ridgePath
+    bool external = false;
 
-        // Populate matrix A (exp weighted future prediction), and
-        // vector B (target BC's) for this row (observation).
-        int    libRow;
-        size_t libRowBase;
-        int    targetLibRowOffset = parameters.Tp - embedShift;
+    bool solved = setup.kernelSolve and
+        EDM_SMap::NormalEquations( N_col, knn, w, neighborRow,
+                                   setup.embeddingData, setup.embeddingStride,
+                                   setup.embeddingOffsets,
+                                   B_noWeight, parameters.ridge, B );
+
+    if ( not solved ) {
+        // Populate column major matrix A (exp weighted future
+        // prediction), and B (target BC's) columns
+        const size_t *offset = embedding.Offsets();
 
         for ( size_t k = 0; k < knn; k++ ) {
-            libRowBase = knn_neighbors( row, k );
-            libRow     = libRowBase + targetLibRowOffset;
-            
-            B[ k ] = target[ libRow ];
+            // Library row embedding vector in place
+            const double *x = embedding.RowBase( neighborRow[ k ] );
+
+            // Weight target/boundary condition vector for solver
+            for ( size_t r = 0; r < nrhs; r++ ) {
+                B[ r * ldb + k ] = w[ k ] * B_noWeight[ r * knn + k ];
+            }
 
             //---------------------------------------------------------------
             // Linear system coefficient matrix
             //---------------------------------------------------------------
-            // NOTE: The matrix A has a (weighted) constant (1) first column
-            //       to enable a linear intercept/bias term.
+            // NOTE: The matrix A has a (weighted) constant (1) first
+            //       column to enable a linear intercept/bias term.
             // NOTE: The embedding does not have a time vector, and only
             //       has columns from the embedding.  So the coefficient
             //       matrix A has E+1 columns, while the embedding has E.
             //---------------------------------------------------------------
-            A( k, 0 ) = w[ k ]; // Intercept bias terms in column 0 (weighted)
+            A[ k ] = w[ k ]; // Intercept bias terms in column 0 (weighted)
 
-            for ( int j = 1; j < parameters.E + 1; j++ ) {
-                A( k, j ) = w[ k ] * embedding( libRowBase, j - 1 );
+            for ( size_t j = 1; j < N_col; j++ ) {
+                A[ j * knn + k ] = w[ k ] * x[ offset[ j - 1 ] ];
             }
         }
 
-        B_noWeight = B; // Copy target vector for "variance" estimate
+        if ( setup.kernelSolve ) {
+            ws.nFallback++; // ill-conditioned for the kernel
+            WorkspaceSVD( ws );
+        }
+        else if ( ridgePath.size() ) {
+            WorkspaceRidgePath( ws, ridgePath );
+        }
+        else if ( setup.workspaceSolve ) {
+            setup.solve( ws );
+        }
+        else {
+            external = true;
 
-        B = w * B;      // Weight target/boundary condition vector for solver
+            DataFrame< double > A_( knn, N_col );
+            for ( size_t k = 0; k < knn; k++ ) {
+                for ( size_t j = 0; j < N_col; j++ ) {
+                    A_( k, j ) = A[ j * knn + k ];
+                }
+            }
 
-        // Estimate linear mapping of predictions A onto target B
-        std::valarray < double > C = solver( A, B );
+            for ( size_t r = 0; r < nrhs; r++ ) {
+                std::valarray< double > B_( B + r * ldb, knn );
 
-        // Prediction is local linear projection
-        double prediction = C[ 0 ]; // C[ 0 ] is the bias term
+                C_external[ r ] = setup.solver( A_, B_ );
 
-        for ( int e = 1; e < parameters.E + 1; e++ ) {
-            prediction = prediction +
-                         C[ e ] * embedding( parameters.prediction[ row ], e-1 );
+                if ( C_external[ r ].size() != N_col ) {
+                    std::stringstream errMsg;
+                    errMsg << "SMapClass::SMap(): solver returned "
+                           << C_external[ r ].size() << " coefficients, "
+                           << N_col << " expected.\n";
+                    throw std::runtime_error( errMsg.str() );
+                }
+            }
         }
+    }
 
-        predictions[ row ] = prediction;
-        coefficients.WriteRow( row, C );
+    for ( size_t i = 0; i < nSolution; i++ ) {
+        size_t        r = i / nRidge; // target of solution i
+        const double *C = ridgePath.size() ? &ws.X[ i * N_col ]    :
+                          external         ? &C_external[ r ][ 0 ] :
+                                             B + r * ldb;
 
-        // "Variance" estimate assuming weights are probabilities
-        std::valarray< double > deltaSqr =
-            std::pow( B_noWeight - predictions[ row ], 2);
+        // Prediction is local linear projection
+        double prediction = C[ 0 ]; // C[ 0 ] is the bias term
 
-        variance[ row ] = ( w * deltaSqr ).sum() / w.sum();
+        // Prediction row embedding vector, or the StateNeighbors() state
+        for ( size_t e = 1; e < N_col; e++ ) {
+            double x = states.NRows() ? states( row, e-1 ) :
+                       embedding( parameters.prediction[ row ], e-1 );
+            prediction = prediction + C[ e ] * x;
+        }
 
-    } // for ( row = 0; row < Npred; row++ )
+        ( *setup.solPredictions[ i ] )[ row ] = prediction;
 
-    // non "predictions" X(t+1) = X(t) if const_predict specified
-    const_predictions = std::valarray< double >( 0., Npred );
-    if ( parameters.const_predict ) {
-        std::slice pred_slice =
-            std::slice( parameters.prediction[ 0 ],
-                        parameters.prediction.size(), 1 );
+        double *coef = setup.solCoefficients[ i ] + row * N_col;
+        for ( size_t j = 0; j < N_col; j++ ) {
+            coef[ j ] = C[ j ];
+        }
 
-        const_predictions = target[ pred_slice ];
+        // "Variance" estimate assuming weights are probabilities
+        const double *libTarget   = B_noWeight + r * knn;
+        double        deltaSqrSum = 0;
+        double        weightSum   = 0;
+        for ( size_t k = 0; k < knn; k++ ) {
+            double delta = libTarget[ k ] - prediction;
+            deltaSqrSum += w[ k ] * ( delta * delta );
+            weightSum   += w[ k ];
+        }
+        ( *setup.solVariance[ i ] )[ row ] = deltaSqrSum / weightSum;
     }
 }
 
@@ -159,7 +644,65 @@ void SMapClass::WriteOutput () {
     }
     // else { throw ? }  JP
 
-    // coefficients column names
+    coefficients.ColumnNames() = CoefficientNames();
+
+    // coefficients has Npred + Tp rows, but coef were written in first Npred
+    // Create coefficient column vector with Tp nan rows at the
+    // beginning/end of coefficients as in FormatOutput()
+    std::valarray< double > coefColumnVec( NAN, coefficients.NRows() );
+
+    // Copy/shift coefficients vectors
+    std::slice slice_in = std::slice( 0, knnTable.NRows(), 1 );
+    std::slice slice_out;
+    if ( parameters.Tp > -1 ) {
+        slice_out = std::slice( parameters.Tp, knnTable.NRows(), 1 );
+    }
+    else {
+        slice_out = std::slice( 0, knnTable.NRows() + parameters.Tp, 1 );
+    }
+    for ( size_t col = 0; col < coefficients.NColumns(); col++ ) {
+        coefColumnVec[ slice_out ] = coefficients.Column( col )[ slice_in ];
+        coefficients.WriteColumn( col, coefColumnVec );
+    }
+
+    // Weight truncation knn and bound with the coefficients rows
+    truncation = DataFrame< double >();
+    if ( knnEffective.size() ) {
+        truncation = DataFrame< double >( coefficients.NRows(), 2,
+                                          "knn_effective error_bound" );
+        truncation.Time()     = coefficients.Time();
+        truncation.TimeName() = coefficients.TimeName();
+
+        std::valarray< double > knnVec( knnEffective.size() );
+        for ( size_t row = 0; row < knnEffective.size(); row++ ) {
+            knnVec[ row ] = knnEffective[ row ];
+        }
+
+        std::slice slice_row = std::slice( 0, slice_out.size(), 1 );
+
+        coefColumnVec = NAN;
+        coefColumnVec[ slice_out ] = knnVec[ slice_row ];
+        truncation.WriteColumn( 0, coefColumnVec );
+
+        coefColumnVec[ slice_out ] = truncationBound[ slice_row ];
+        truncation.WriteColumn( 1, coefColumnVec );
+    }
+
+    if ( parameters.predictOutputFile.size() ) {
+        projection.WriteData( parameters.pathOut,
+                              parameters.predictOutputFile );
+    }
+    if ( parameters.SmapOutputFile.size() ) {
+        coefficients.WriteData( parameters.pathOut, parameters.SmapOutputFile );
+    }
+}
+
+//----------------------------------------------------------------
+// coefficients column names: C0 and the embedding column partial
+// derivatives of the target, or C0, C1, ...
+//----------------------------------------------------------------
+std::vector< std::string > SMapClass::CoefficientNames () const {
+
     std::vector<std::string> coefNames;
     if ( parameters.columnNames.size() and parameters.targetName.size() ) {
         coefNames.push_back( "C0" );
@@ -187,33 +730,34 @@ void SMapClass::WriteOutput () {
             coefNames.push_back( coefName.str() );
         }
     }
-    coefficients.ColumnNames() = coefNames;
+    return coefNames;
+}
 
-    // coefficients has Npred + Tp rows, but coef were written in first Npred
-    // Create coefficient column vector with Tp nan rows at the
-    // beginning/end of coefficients as in FormatOutput()
-    std::valarray< double > coefColumnVec( NAN, coefficients.NRows() );
+//----------------------------------------------------------------
+// Coefficients and truncation of the StateNeighbors() states: the
+// first Npred rows, without the Tp shift and time of WriteOutput()
+//----------------------------------------------------------------
+void SMapClass::FormatStateCoefficients () {
 
-    // Copy/shift coefficients vectors
-    std::slice slice_in = std::slice( 0, knn_neighbors.NRows(), 1 );
-    std::slice slice_out;
-    if ( parameters.Tp > -1 ) {
-        slice_out = std::slice( parameters.Tp, knn_neighbors.NRows(), 1 );
-    }
-    else {
-        slice_out = std::slice( 0, knn_neighbors.NRows() + parameters.Tp, 1 );
-    }
-    for ( size_t col = 0; col < coefficients.NColumns(); col++ ) {
-        coefColumnVec[ slice_out ] = coefficients.Column( col )[ slice_in ];
-        coefficients.WriteColumn( col, coefColumnVec );
-    }
+    size_t Nstates = knnTable.NRows();
 
-    if ( parameters.predictOutputFile.size() ) {
-        projection.WriteData( parameters.pathOut,
-                              parameters.predictOutputFile );
+    DataFrame< double > stateCoefficients( Nstates, coefficients.NColumns(),
+                                           CoefficientNames() );
+    for ( size_t row = 0; row < Nstates; row++ ) {
+        for ( size_t col = 0; col < coefficients.NColumns(); col++ ) {
+            stateCoefficients( row, col ) = coefficients( row, col );
+        }
     }
-    if ( parameters.SmapOutputFile.size() ) {
-        coefficients.WriteData( parameters.pathOut, parameters.SmapOutputFile );
+    coefficients = stateCoefficients;
+
+    truncation = DataFrame< double >();
+    if ( knnEffective.size() ) {
+        truncation = DataFrame< double >( Nstates, 2,
+                                          "knn_effective error_bound" );
+        for ( size_t row = 0; row < Nstates; row++ ) {
+            truncation( row, 0 ) = knnEffective[ row ];
+            truncation( row, 1 ) = truncationBound[ row ];
+        }
     }
 }
 
@@ -247,6 +791,39 @@ std::valarray < double > SVD( DataFrame    < double > A,
     return C;
 }
 
+//----------------------------------------------------------------
+// Set workspace system shape. Buffers grow but are not released,
+// LAPACK work sizes are re-queried if the shape changed.
+//----------------------------------------------------------------
+void SMapWorkspace::Shape( int m_, int n_, int nrhs_ ) {
+    if ( m_ == m and n_ == n and nrhs_ == nrhs ) {
+        return;
+    }
+    m    = m_;
+    n    = n_;
+    nrhs = nrhs_;
+
+    size_t nA = (size_t) m * n;
+    size_t nB = (size_t) std::max( m, n ) * nrhs;
+    size_t nS = (size_t) std::min( m, n );
+
+    if ( A.size() < nA          ) { A.resize( nA );          }
+    if ( B.size() < nB          ) { B.resize( nB );          }
+    if ( S.size() < nS          ) { S.resize( nS );          }
+    if ( w.size() < (size_t) m  ) { w.resize( m );           }
+    if ( B_noWeight.size() < (size_t) m * nrhs ) {
+        B_noWeight.resize( (size_t) m * nrhs );
+    }
+
+    if ( Afactor.size() < nA                  ) { Afactor.resize( nA ); }
+    if ( tau.size()     < (size_t) n          ) { tau.resize( n );      }
+    if ( G.size()       < (size_t) n * n      ) { G.resize( n * n );    }
+    if ( AtB.size()     < (size_t) n * nrhs   ) { AtB.resize( n * nrhs ); }
+    if ( V.size()       < (size_t) n * n      ) { V.resize( n * n );    }
+
+    lworkSVD = 0;
+}
+
 //-------------------------------------------------------------------------
 // subroutine dgelss() : LAPACK function call in Lapack_SVD()
 //-----------------------------------------------------------------------
@@ -372,3 +949,443 @@ std::valarray< double > Lapack_SVD( int     m, // rows in matrix
 
     return C;
 }
+
+//-----------------------------------------------------------------------
+// LAPACK dgelss_() on workspace buffers. Same rcond as SVD().
+// The optimal LWORK is queried once per workspace shape and passed
+// exactly, so dgelss takes the same path as Lapack_SVD().
+//-----------------------------------------------------------------------
+void WorkspaceSVD( SMapWorkspace & workspace ) {
+
+    int    m     = workspace.m;
+    int    n     = workspace.n;
+    int    nrhs  = workspace.nrhs;
+    int    lda   = std::max( 1, m );
+    int    ldb   = std::max( 1, std::max( m, n ) );
+    double rcond = 1.E-9;
+    int    info  = 0;
+    int    rank  = 0;
+
+    if ( workspace.lworkSVD == 0 ) {
+        double workSize = 0;
+        int    lwork    = -1; // To query optimal work size
+
+        dgelss_( &m, &n, &nrhs, workspace.A.data(), &lda,
+                 workspace.B.data(), &ldb, workspace.S.data(), &rcond,
+                 &rank, &workSize, &lwork, &info );
+
+        if ( info ) {
+            throw std::runtime_error( "WorkspaceSVD(): "
+                                      "dgelss failed on query.\n" );
+        }
+
+        workspace.lworkSVD = (int) workSize;
+
+        if ( workspace.work.size() < (size_t) workspace.lworkSVD ) {
+            workspace.work.resize( workspace.lworkSVD );
+        }
+    }
+
+    dgelss_( &m, &n, &nrhs, workspace.A.data(), &lda,
+             workspace.B.data(), &ldb, workspace.S.data(), &rcond,
+             &rank, workspace.work.data(), &workspace.lworkSVD, &info );
+
+    if ( info ) {
+        throw std::runtime_error( "WorkspaceSVD(): dgelss failed.\n" );
+    }
+}
+
+//-----------------------------------------------------------------------
+// QR and normal equations (Cholesky) workspace solvers
+//
+// Both are cheaper than dgelss for the tall, narrow knn x (E+1)
+// SMap systems. The condition of each system is estimated
+// from the diagonal of the triangular factor: ill-conditioned or
+// rank deficient systems, and knn < E+1 without ridge, are solved
+// by WorkspaceSVD() instead and counted in workspace.nFallback.
+//
+// The factorizations are written here rather than calling LAPACK
+// dgels/dpotrf, which take Fortran character arguments. For these
+// small systems dgels runs the same unblocked Householder QR.
+// The rcond thresholds are in EDM_SMapKernels.h.
+//-----------------------------------------------------------------------
+
+//-----------------------------------------------------------------------
+// Householder QR in place of column major A (M x N), M >= N
+// Reflectors H_j = I - tau_j v_j v_j', v_j[ j ] = 1, with v_j below
+// the diagonal of column j, R on and above the diagonal
+//-----------------------------------------------------------------------
+static void HouseholderQR( double *A, size_t M, size_t N, double *tau ) {
+
+    for ( size_t j = 0; j < N; j++ ) {
+        double *a_j = A + j * M;
+
+        double xnorm2 = 0;
+        for ( size_t i = j + 1; i < M; i++ ) {
+            xnorm2 += a_j[ i ] * a_j[ i ];
+        }
+
+        if ( xnorm2 == 0 ) {
+            tau[ j ] = 0; // column already upper triangular
+            continue;
+        }
+
+        double alpha = a_j[ j ];
+        double beta  = -std::copysign( std::sqrt( alpha * alpha + xnorm2 ),
+                                       alpha );
+        double scale = 1 / ( alpha - beta );
+
+        tau[ j ] = ( beta - alpha ) / beta;
+        a_j[ j ] = beta;
+        for ( size_t i = j + 1; i < M; i++ ) {
+            a_j[ i ] *= scale;
+        }
+
+        // Apply H_j to the trailing columns
+        for ( size_t k = j + 1; k < N; k++ ) {
+            double *a_k = A + k * M;
+            double  sum = a_k[ j ];
+            for ( size_t i = j + 1; i < M; i++ ) {
+                sum += a_j[ i ] * a_k[ i ];
+            }
+            sum *= tau[ j ];
+            a_k[ j ] -= sum;
+            for ( size_t i = j + 1; i < M; i++ ) {
+                a_k[ i ] -= sum * a_j[ i ];
+            }
+        }
+    }
+}
+
+//-----------------------------------------------------------------------
+// b = Q' b with the reflectors of HouseholderQR()
+//-----------------------------------------------------------------------
+static void HouseholderQtb( const double *A, size_t M, size_t N,
+                            const double *tau, double *b ) {
+
+    for ( size_t j = 0; j < N; j++ ) {
+        if ( tau[ j ] == 0 ) { continue; }
+        const double *a_j = A + j * M;
+        double sum = b[ j ];
+        for ( size_t i = j + 1; i < M; i++ ) {
+            sum += a_j[ i ] * b[ i ];
+        }
+        sum *= tau[ j ];
+        b[ j ] -= sum;
+        for ( size_t i = j + 1; i < M; i++ ) {
+            b[ i ] -= sum * a_j[ i ];
+        }
+    }
+}
+
+//-----------------------------------------------------------------------
+// Householder QR of A, Q'B, back substitution of R x = Q'B
+// A is factored in workspace.Afactor so that A and B are intact
+// for the SVD fallback until the condition check passes.
+//-----------------------------------------------------------------------
+void WorkspaceQR( SMapWorkspace & workspace ) {
+
+    size_t M    = workspace.m;
+    size_t N    = workspace.n;
+    size_t NRHS = workspace.nrhs;
+    size_t ldb  = std::max( M, N );
+
+    if ( M < N ) {
+        workspace.nFallback++;
+        WorkspaceSVD( workspace ); // underdetermined: minimum norm
+        return;
+    }
+
+    double *A   = workspace.Afactor.data();
+    double *tau = workspace.tau.data();
+
+    std::copy( workspace.A.data(), workspace.A.data() + M * N, A );
+
+    HouseholderQR( A, M, N, tau );
+
+    // Condition estimate from the diagonal of R
+    double rMin = std::fabs( A[ 0 ] );
+    double rMax = rMin;
+    for ( size_t j = 1; j < N; j++ ) {
+        double r_jj = std::fabs( A[ j * M + j ] );
+        rMin = std::min( rMin, r_jj );
+        rMax = std::max( rMax, r_jj );
+    }
+    if ( not ( rMin > EDM_SMap::rcondQR * rMax ) ) {
+        workspace.nFallback++;
+        WorkspaceSVD( workspace );
+        return;
+    }
+
+    for ( size_t r = 0; r < NRHS; r++ ) {
+        double *b = workspace.B.data() + r * ldb;
+
+        HouseholderQtb( A, M, N, tau, b ); // b = Q' b
+
+        // Back substitution R x = b, x in b[ 0 : N ]
+        for ( size_t j = N; j-- > 0; ) {
+            double sum = b[ j ];
+            for ( size_t k = j + 1; k < N; k++ ) {
+                sum -= A[ k * M + j ] * b[ k ];
+            }
+            b[ j ] = sum / A[ j * M + j ];
+        }
+    }
+}
+
+//-----------------------------------------------------------------------
+// Normal equations ( A'A + ridge I ) x = A'B by Cholesky A'A = L L'
+// The ridge is applied to all E+1 coefficients of the weighted system.
+//-----------------------------------------------------------------------
+void WorkspaceCholesky( SMapWorkspace & workspace ) {
+
+    size_t M     = workspace.m;
+    size_t N     = workspace.n;
+    size_t NRHS  = workspace.nrhs;
+    size_t ldb   = std::max( M, N );
+    double ridge = workspace.ridge;
+
+    if ( M < N and ridge == 0 ) {
+        workspace.nFallback++;
+        WorkspaceSVD( workspace ); // underdetermined: minimum norm
+        return;
+    }
+
+    const double *A = workspace.A.data();
+    double       *G = workspace.G.data(); // column major, lower triangle
+
+    // Lower triangle of A'A + ridge I
+    for ( size_t j = 0; j < N; j++ ) {
+        const double *a_j = A + j * M;
+        for ( size_t i = j; i < N; i++ ) {
+            const double *a_i = A + i * M;
+            double sum = 0;
+            for ( size_t k = 0; k < M; k++ ) {
+                sum += a_i[ k ] * a_j[ k ];
+            }
+            G[ j * N + i ] = sum;
+        }
+        G[ j * N + j ] += ridge;
+    }
+
+    // Cholesky factor L in the lower triangle of G
+    double lMin = 0;
+    double lMax = 0;
+    for ( size_t j = 0; j < N; j++ ) {
+        double d = G[ j * N + j ];
+        for ( size_t k = 0; k < j; k++ ) {
+            d -= G[ k * N + j ] * G[ k * N + j ];
+        }
+        if ( not ( d > 0 ) ) {
+            workspace.nFallback++; // not positive definite
+            WorkspaceSVD( workspace );
+            return;
+        }
+        double l_jj = std::sqrt( d );
+        G[ j * N + j ] = l_jj;
+
+        for ( size_t i = j + 1; i < N; i++ ) {
+            double sum = G[ j * N + i ];
+            for ( size_t k = 0; k < j; k++ ) {
+                sum -= G[ k * N + i ] * G[ k * N + j ];
+            }
+            G[ j * N + i ] = sum / l_jj;
+        }
+
+        lMin = j ? std::min( lMin, l_jj ) : l_jj;
+        lMax = j ? std::max( lMax, l_jj ) : l_jj;
+    }
+
+    // Condition estimate from the diagonal of L
+    double lRatio = lMin / lMax;
+    if ( lRatio * lRatio < EDM_SMap::rcondCholesky ) {
+        workspace.nFallback++;
+        WorkspaceSVD( workspace );
+        return;
+    }
+
+    for ( size_t r = 0; r < NRHS; r++ ) {
+        double *b = workspace.B.data() + r * ldb;
+        double *y = workspace.AtB.data() + r * N;
+
+        // y = A'b
+        for ( size_t j = 0; j < N; j++ ) {
+            const double *a_j = A + j * M;
+            double sum = 0;
+            for ( size_t k = 0; k < M; k++ ) {
+                sum += a_j[ k ] * b[ k ];
+            }
+            y[ j ] = sum;
+        }
+
+        // Forward substitution L z = y
+        for ( size_t j = 0; j < N; j++ ) {
+            double sum = y[ j ];
+            for ( size_t k = 0; k < j; k++ ) {
+                sum -= G[ k * N + j ] * y[ k ];
+            }
+            y[ j ] = sum / G[ j * N + j ];
+        }
+
+        // Back substitution L' x = z, x in b[ 0 : N ]
+        for ( size_t j = N; j-- > 0; ) {
+            double sum = y[ j ];
+            for ( size_t k = j + 1; k < N; k++ ) {
+                sum -= G[ j * N + k ] * y[ k ];
+            }
+            y[ j ] = sum / G[ j * N + j ];
+        }
+        std::copy( y, y + N, b );
+    }
+}
+
+//-----------------------------------------------------------------------
+// Ridge regularization path ( A'A + lambda I ) x = A'b for each
+// lambda in ridgePath from one SVD A = U S V' of the weighted system:
+//
+//   x( lambda ) = sum_j v_j s_j ( u_j' b ) / ( s_j^2 + lambda )
+//
+// A is reduced to R by HouseholderQR() if m >= n, then the SVD of R
+// (or of A if m < n) is computed by one-sided Jacobi rotations
+// W V = U S on columns of W = R. Singular values below
+// rcondSVD * s_max are treated as zero, as dgelss for lambda = 0.
+//
+// Solution of rhs r, lambda l is in X[ ( r * nLambda + l ) * n ].
+// lambda = ridge gives the WorkspaceCholesky() ridge solution.
+//-----------------------------------------------------------------------
+void WorkspaceRidgePath( SMapWorkspace               & workspace,
+                         const std::vector< double > & ridgePath ) {
+
+    size_t M       = workspace.m;
+    size_t N       = workspace.n;
+    size_t NRHS    = workspace.nrhs;
+    size_t ldb     = std::max( M, N );
+    size_t nLambda = ridgePath.size();
+
+    if ( workspace.X.size() < N * NRHS * nLambda ) {
+        workspace.X.resize( N * NRHS * nLambda );
+    }
+
+    double *W   = workspace.Afactor.data(); // rows x N column major
+    double *V   = workspace.V.data();       // N x N
+    double *tau = workspace.tau.data();
+    double *B   = workspace.B.data();
+    size_t rows = std::min( M, N );         // rows of W: R, or A if M < N
+
+    std::copy( workspace.A.data(), workspace.A.data() + M * N, W );
+
+    if ( M >= N ) {
+        HouseholderQR( W, M, N, tau );
+
+        for ( size_t r = 0; r < NRHS; r++ ) {
+            HouseholderQtb( W, M, N, tau, B + r * ldb ); // c = Q'b[ 0 : N ]
+        }
+
+        // Pack R into the leading N x N of W, zero below the diagonal
+        for ( size_t j = 0; j < N; j++ ) {
+            for ( size_t i = 0; i < N; i++ ) {
+                W[ j * N + i ] = i <= j ? W[ j * M + i ] : 0;
+            }
+        }
+    }
+
+    // One-sided Jacobi: rotate column pairs of W until orthogonal
+    std::fill( V, V + N * N, 0. );
+    for ( size_t j = 0; j < N; j++ ) {
+        V[ j * N + j ] = 1;
+    }
+
+    for ( size_t sweep = 0; sweep < EDM_SMap::maxJacobiSweeps; sweep++ ) {
+        bool rotated = false;
+
+        for ( size_t p = 0; p + 1 < N; p++ ) {
+            for ( size_t q = p + 1; q < N; q++ ) {
+                double *w_p = W + p * rows;
+                double *w_q = W + q * rows;
+
+                double alpha = 0, beta = 0, gamma = 0;
+                for ( size_t i = 0; i < rows; i++ ) {
+                    alpha += w_p[ i ] * w_p[ i ];
+                    beta  += w_q[ i ] * w_q[ i ];
+                    gamma += w_p[ i ] * w_q[ i ];
+                }
+
+                if ( std::fabs( gamma ) <=
+                     EDM_SMap::jacobiTolerance * std::sqrt( alpha * beta ) ) {
+                    continue;
+                }
+                rotated = true;
+
+                double zeta = ( beta - alpha ) / ( 2 * gamma );
+                double t    = std::copysign( 1., zeta ) /
+                              ( std::fabs( zeta ) +
+                                std::sqrt( 1 + zeta * zeta ) );
+                double c    = 1 / std::sqrt( 1 + t * t );
+                double s    = c * t;
+
+                for ( size_t i = 0; i < rows; i++ ) {
+                    double wp = w_p[ i ];
+                    w_p[ i ] = c * wp - s * w_q[ i ];
+                    w_q[ i ] = s * wp + c * w_q[ i ];
+                }
+
+                double *v_p = V + p * N;
+                double *v_q = V + q * N;
+                for ( size_t i = 0; i < N; i++ ) {
+                    double vp = v_p[ i ];
+                    v_p[ i ] = c * vp - s * v_q[ i ];
+                    v_q[ i ] = s * vp + c * v_q[ i ];
+                }
+            }
+        }
+
+        if ( not rotated ) {
+            break;
+        }
+    }
+
+    // Singular values s_j = || w_j ||, N of them in workspace.AtB
+    double *sigma = workspace.AtB.data();
+    double  sMax  = 0;
+    for ( size_t j = 0; j < N; j++ ) {
+        const double *w_j = W + j * rows;
+        double sum = 0;
+        for ( size_t i = 0; i < rows; i++ ) {
+            sum += w_j[ i ] * w_j[ i ];
+        }
+        sigma[ j ] = std::sqrt( sum );
+        sMax       = std::max( sMax, sigma[ j ] );
+    }
+
+    for ( size_t r = 0; r < NRHS; r++ ) {
+        const double *c = B + r * ldb;
+
+        for ( size_t l = 0; l < nLambda; l++ ) {
+            double *x = &workspace.X[ ( r * nLambda + l ) * N ];
+            std::fill( x, x + N, 0. );
+        }
+
+        for ( size_t j = 0; j < N; j++ ) {
+            double s_j = sigma[ j ];
+            if ( not ( s_j > EDM_SMap::rcondSVD * sMax ) ) {
+                continue; // rank deficient direction
+            }
+
+            // d_j = w_j' c = s_j u_j' b
+            const double *w_j = W + j * rows;
+            double d_j = 0;
+            for ( size_t i = 0; i < rows; i++ ) {
+                d_j += w_j[ i ] * c[ i ];
+            }
+
+            const double *v_j = V + j * N;
+            for ( size_t l = 0; l < nLambda; l++ ) {
+                double  f = d_j / ( s_j * s_j + ridgePath[ l ] );
+                double *x = &workspace.X[ ( r * nLambda + l ) * N ];
+                for ( size_t i = 0; i < N; i++ ) {
+                    x[ i ] += f * v_j[ i ];
+                }
+            }
+        }
+    }
+}
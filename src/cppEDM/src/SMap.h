@@ -2,16 +2,99 @@
 #ifndef EDM_SMAP_H
 #define EDM_SMAP_H
 
+#include <atomic>
+#include <mutex>
+#include <queue>
+
 #include "EDM.h"
 
 // Prototype & alias of solver function pointer
 using Solver = std::valarray< double > (*) ( DataFrame     < double >,
                                              std::valarray < double > );
 
+//----------------------------------------------------------------
+// SMap solver workspace
+// Column major A (m x n) and B (max(m,n) x nrhs) buffers and LAPACK
+// work arrays reused for every prediction row so that the SMap()
+// row loop does not allocate. Each SMapClass object owns one, so
+// each thread in the threaded drivers has its own. The dgelss
+// optimal LWORK is queried only when the system shape changes.
+//----------------------------------------------------------------
+struct SMapWorkspace {
+    int m;    // rows    : knn
+    int n;    // columns : E + 1
+    int nrhs; // right hand side columns
+
+    std::vector< double > A;          // m x n column major, overwritten
+    std::vector< double > B;          // max(m,n) x nrhs, solution in [0,n)
+    std::vector< double > S;          // min(m,n) singular values
+    std::vector< double > work;       // LAPACK work array
+    int                   lworkSVD;   // dgelss LWORK for shape, 0 : query
+
+    std::vector< double > w;          // m neighbor weights
+    std::vector< double > B_noWeight; // m x nrhs unweighted library targets
+
+    // QR and Cholesky solvers
+    std::vector< double > Afactor;    // m x n QR factorization copy of A
+    std::vector< double > tau;        // n QR Householder scalars
+    std::vector< double > G;          // n x n normal equations, factor
+    std::vector< double > AtB;        // n x nrhs normal equations rhs
+    std::vector< double > V;          // n x n ridge path right singular vectors
+    std::vector< double > X;          // n x nrhs x lambdas ridge path solutions
+    double                ridge;      // Cholesky ridge regularization
+    size_t                nFallback;  // ill-conditioned systems sent to SVD
+
+    SMapWorkspace() : m( 0 ), n( 0 ), nrhs( 0 ), lworkSVD( 0 ),
+                      ridge( 0 ), nFallback( 0 ) {}
+
+    void Shape( int m, int n, int nrhs = 1 );
+};
+
+// Workspace solver: solves workspace A x = B in place, x in B[0,n)
+using WorkspaceSolver = void (*) ( SMapWorkspace & );
+
+//----------------------------------------------------------------
+// SMap() row loop setup, read only by the row worker threads.
+// Each worker solves rows in its own SMapWorkspace and writes the
+// disjoint row of each solution output.
+//----------------------------------------------------------------
+struct SMapRowSetup {
+    size_t Npred;
+    size_t N_col;     // intercept and E coefficients
+    size_t nrhs;      // targets
+    size_t nRidge;    // ridge path lambdas, 1 if no path
+    size_t nSolution; // nrhs * nRidge
+
+    std::vector< const std::valarray< double > * > rhsTarget;
+
+    std::vector< std::valarray< double > * > solPredictions;
+    std::vector< std::valarray< double > * > solVariance;
+    std::vector< double * >                  solCoefficients; // row major
+
+    Solver          solver;         // external solver
+    bool            workspaceSolve; // solve in the workspace, not solver
+    WorkspaceSolver solve;
+    bool            kernelSolve;    // Cholesky normal equations kernels
+    const double   *embeddingData;  // kernelSolve EmbeddingView rows,
+    size_t          embeddingStride; // RowBase( 0 ), Stride(), Offsets()
+    const size_t   *embeddingOffsets;
+
+    bool            truncate;       // weight truncation
+    double          maxNorm2;       // max || [ 1, x ] ||^2 of embedding
+
+    int             targetLibRowOffset;
+};
+
 // Prototype declaration of general functions
 std::valarray < double > SVD( DataFrame    < double > A,
                               std::valarray< double > B );
 
+void WorkspaceSVD     ( SMapWorkspace & workspace );
+void WorkspaceQR      ( SMapWorkspace & workspace );
+void WorkspaceCholesky( SMapWorkspace & workspace );
+void WorkspaceRidgePath( SMapWorkspace               & workspace,
+                         const std::vector< double > & ridgePath );
+
 std::valarray< double > Lapack_SVD( int     m, // number of rows in matrix
                                     int     n, // number of columns in matrix
                                     double *a, // pointer to top-left corner
@@ -25,13 +108,43 @@ std::valarray< double > Lapack_SVD( int     m, // number of rows in matrix
 class SMapClass : public EDM {
     
 public:
+    SMapWorkspace workspace; // SMap() per-row solver buffers
+
+    // SMap() row worker threads > 1 solve in their own workspace:
+    // workspace, then threadWorkspaces[ 0, nThreads - 1 )
+    std::vector< SMapWorkspace > threadWorkspaces;
+
+    // Weight truncation: per prediction row neighbors kept and bound
+    // on the relative perturbation of the normal equations
+    std::vector< size_t >   knnEffective;
+    std::valarray< double > truncationBound;
+    DataFrame< double >     truncation; // WriteOutput(): time aligned
+
+    // ProjectMultiTarget(): targets share one factorization of A per
+    // prediction row, solved as nrhs columns
+    std::vector< double >                  ridgePath; // ProjectRidgePath()
+    std::vector< DataFrame< double > >     multiCoefficients;
+    std::vector< SMapValues >              multiValues; // per target, lambda
+
     // Constructor
     SMapClass ( DataFrame<double> & data,
                 Parameters        & parameters );
 
     // Method declarations
     void Project( Solver );
+    void ProjectMultiTarget( Solver, std::vector< std::string > targetNames );
+    void ProjectRidgePath  ( Solver, std::vector< double > ridgePath );
     void SMap   ( Solver );
     void WriteOutput();
+    void FormatStateCoefficients();
+    std::vector< std::string > CoefficientNames() const;
+
+    // SMap() prediction row solve and row worker thread
+    void SMapRow ( size_t row, SMapWorkspace &, const SMapRowSetup &,
+                   std::vector< std::valarray< double > > & C_external );
+    void SMapRows( SMapWorkspace &, const SMapRowSetup &,
+                   std::atomic< std::size_t >         & rowCount,
+                   std::queue< std::exception_ptr >   & exceptQ,
+                   std::mutex                         & q_mtx );
 };
 #endif
@@ -1,5 +1,6 @@
 
 #include "Simplex.h"
+#include "EDM_Weights.h"
 
 //----------------------------------------------------------------
 // Constructor
@@ -21,6 +22,10 @@ void SimplexClass::Project () {
 
     FindNeighbors();
 
+    if ( parameters.recallSample ) {
+        NeighborRecall( [this]() { Simplex(); } ); // approxTrees recall
+    }
+
     Simplex();
 
     FormatOutput();
@@ -28,144 +33,277 @@ void SimplexClass::Project () {
     WriteOutput();
 }
 
+//----------------------------------------------------------------
+// ProjectMultiTarget : Simplex of each target in targetNames
+// Each target is predicted from the same embedding, neighbors and
+// neighbor weights as parameters.target. projection has the
+// Observations, Predictions and Pred_Variance (Const_Predictions)
+// columns of each target, suffixed by the target name.
+//----------------------------------------------------------------
+void SimplexClass::ProjectMultiTarget (
+    std::vector< std::string > targetNames_ ) {
+
+    if ( targetNames_.empty() ) {
+        throw std::runtime_error( "SimplexClass::ProjectMultiTarget(): "
+                                  "no targets.\n" );
+    }
+
+    GetTargets( targetNames_ );
+
+    PrepareEmbedding();
+
+    Distances(); // all pred : lib vector distances into allDistances
+
+    FindNeighbors();
+
+    if ( parameters.recallSample ) {
+        NeighborRecall( [this]() { Simplex(); } ); // approxTrees recall
+    }
+
+    Simplex();
+
+    // FormatOutput() of each target into the columns of the target
+    size_t Npred = knnTable.NRows();
+
+    DataFrame< double > multiProjection;
+
+    for ( size_t t = 0; t < targets.size(); t++ ) {
+        target      = targets[ t ];
+        predictions = multiPredictions[ t ];
+        variance    = multiVariance   [ t ];
+
+        const_predictions = std::valarray< double >( 0., Npred );
+        if ( parameters.const_predict ) {
+            std::slice pred_slice =
+                std::slice( parameters.prediction[ 0 ],
+                            parameters.prediction.size(), 1 );
+
+            const_predictions = target[ pred_slice ];
+        }
+
+        FormatOutput();
+
+        size_t nColumns = projection.NColumns();
+
+        if ( t == 0 ) {
+            std::vector< std::string > columnNames;
+            for ( auto & name : targetNames ) {
+                for ( auto & column : projection.ColumnNames() ) {
+                    columnNames.push_back( column + "_" + name );
+                }
+            }
+            multiProjection = DataFrame< double >( projection.NRows(),
+                                                   nColumns * targets.size(),
+                                                   columnNames );
+            multiProjection.Time()     = projection.Time();
+            multiProjection.TimeName() = projection.TimeName();
+        }
+
+        for ( size_t j = 0; j < nColumns; j++ ) {
+            multiProjection.WriteColumn( t * nColumns + j,
+                                         projection.Column( j ) );
+        }
+    }
+
+    target      = targets[ 0 ];
+    predictions = multiPredictions[ 0 ];
+    variance    = multiVariance   [ 0 ];
+    projection  = multiProjection;
+
+    WriteOutput();
+}
+
 //----------------------------------------------------------------
 // Simplex algorithm
+// The neighbor weights of each prediction row are computed once:
+// each of targets, or target, is a weighted sum of its library rows.
 //----------------------------------------------------------------
 void SimplexClass::Simplex () {
 
     // Allocate output vectors to populate EDM class projections DataFrame.
     // Must be after FindNeighbors()
-    size_t Npred      = knn_neighbors.NRows();
-    predictions       = std::valarray< double > ( 0., Npred );
-    const_predictions = std::valarray< double > ( 0., Npred );
-    variance          = std::valarray< double > ( 0., Npred );
+    size_t Npred    = knnTable.NRows();
+    size_t nTargets = targets.size() ? targets.size() : 1;
+
+    multiPredictions.assign( nTargets, std::valarray< double >( 0., Npred ) );
+    multiVariance.assign   ( nTargets, std::valarray< double >( 0., Npred ) );
 
     int    targetSize = (int) target.size();
     double minWeight  = 1.E-6;
+    size_t knn        = (size_t) parameters.knn;
+
+    int targetLibRowOffset = parameters.Tp - embedShift;
+
+    //------------------------------------------------------------------
+    // Size the workspace once for the largest tie expanded knn so that
+    // the prediction row loop does not allocate
+    //------------------------------------------------------------------
+    size_t maxKnnSize = knn;
+    bool anyTies = knnTable.AnyTies();
+    if ( anyTies ) {
+        for ( size_t row = 0; row < Npred; row++ ) {
+            if ( knnTable.Tie( row ) ) {
+                // tieFirstIndex + numTies, see tie expansion below
+                size_t knnSize = ( knn - 1 ) + knnTable.NTies( row );
+                maxKnnSize = std::max( maxKnnSize, knnSize );
+            }
+        }
+    }
+    workspace.Reserve( maxKnnSize );
+
+    double *weights   = workspace.weights.data();
+    double *libTarget = workspace.libTarget.data();
+    int    *libRows   = workspace.libRows.data();
 
     // Process each prediction row in neighbors : distances
     for ( size_t row = 0; row < Npred; row++ ) {
 
-        std::valarray< double > distanceRow = knn_distances.Row( row );
+        // knnTable rows are contiguous. Float distances are widened
+        // into weights, which are then computed in place.
+        const double        *distanceRow = knnTable.Distances( row, weights );
+        const NeighborIndex *neighborRow = knnTable.Neighbors( row );
 
         // Establish exponential weight reference, the 'distance scale'
-        double minDistance = distanceRow.min();
-
-        // Compute weightedDistances vector for each k_NN
-        std::valarray< double > weightedDistances( minWeight, parameters.knn );
+        double minDistance = *std::min_element( distanceRow,
+                                                distanceRow + knn );
 
+        // Compute weights for each k_NN, limited below by minWeight
         if ( minDistance == 0 ) {
             // Handle cases of distanceRow = 0
-            for ( int i = 0; i < parameters.knn; i++ ) {
+            for ( size_t i = 0; i < knn; i++ ) {
                 if ( distanceRow[i] > 0 ) {
-                    weightedDistances[i] = exp( -distanceRow[i] / minDistance );
+                    weights[i] = std::max( exp( -distanceRow[i] / minDistance ),
+                                           minWeight );
                 }
                 else {
                     // Setting weight = 1 implies that the corresponding
                     // library target vector is the same as the observation
                     // so it will be given full-weight in the prediction.
-                    weightedDistances[ i ] = 1;
+                    weights[i] = 1;
                 }
             }
         }
         else {
-            // exp() is a valarray<> overload (vectorized?)
-            weightedDistances = exp( -distanceRow / minDistance );
+            for ( size_t i = 0; i < knn; i++ ) {
+                weights[i] = -distanceRow[i] / minDistance;
+            }
+            ExpWeights( weights, knn, parameters.exactExp );
+            for ( size_t i = 0; i < knn; i++ ) {
+                weights[i] = std::max( weights[i], minWeight );
+            }
         }
 
-        // weights vector is weightedDistances > minWeight
-        std::valarray< double > weights( parameters.knn );
-        for  ( int i = 0; i < parameters.knn; i++ ) {
-            weights[i] = std::max( weightedDistances[i], minWeight );
+        // target library rows, one element for each knn
+        for ( size_t k = 0; k < knn; k++ ) {
+            libRows[ k ] = neighborRow[ k ] + targetLibRowOffset;
         }
 
-        // target library vector, one element for each knn
-        std::valarray< double > libTarget( 0., parameters.knn );
-        int targetLibRowOffset = parameters.Tp - embedShift;
-        for ( int k = 0; k < parameters.knn; k++ ) {
-            int libRow = knn_neighbors( row, k ) + targetLibRowOffset;
-            libTarget[ k ] = target[ libRow ];
-        }
+        size_t nWeights = knn; // weights & libRows in use for this row
 
         //------------------------------------------------------------------
-        // If ties, expand & adjust libTarget & weights
+        // If ties, expand & adjust libRows & weights
         //------------------------------------------------------------------
         if ( anyTies ) {
 
-            if ( ties[ row ] ) {
+            if ( knnTable.Tie( row ) ) {
 
-                std::vector< std::pair< double, size_t > >
-                    rowTiePairs = tiePairs[ row ];
+                // Tied library rows from the knn-th neighbor on
+                const NeighborIndex *rowTies = knnTable.Ties( row );
+                size_t               nTies   = knnTable.NTies( row );
 
-                size_t tieFirstIdx = tieFirstIndex[ row ];
-                size_t numTies     = ( parameters.knn - 1 ) - tieFirstIdx +
-                                     rowTiePairs.size();
+                size_t tieFirstIdx = knnTable.TieFirstIndex( row );
+                size_t numTies     = ( knn - 1 ) - tieFirstIdx + nTies;
                 size_t knnSize     = tieFirstIdx + numTies;
                 size_t tiesFound   = 0;
 
-                if ( (int) knnSize > parameters.knn ) {
+                if ( knnSize > knn ) {
 
-                    double tieFactor =
-                        double( numTies + parameters.knn - knnSize ) /
-                        double( numTies );
+                    double tieFactor = double( numTies + knn - knnSize ) /
+                                       double( numTies );
 
-                    double tieWeight = *( end( weights ) - 1 );
+                    double tieWeight = weights[ knn - 1 ];
 
-                    // Copies of libTarget & weights for resize
-                    std::valarray< double > libTargetCopy( libTarget );
-                    std::valarray< double > weightsCopy  ( weights );
+                    // Expanded nn default to weight 0 if no target lib
+                    std::fill( libRows + knn, libRows + knnSize, -1 );
+                    std::fill( weights + knn, weights + knnSize, 0. );
 
-                    // resize libTarget & weights : destroys contents, init 0
-                    libTarget.resize( (size_t) knnSize, 0. );
-                    weights.resize  ( (size_t) knnSize, 0. );
-
-                    // Copy original knn libTarget & weights values
-                    libTarget[std::slice(0, parameters.knn, 1)] = libTargetCopy;
-                    weights  [std::slice(0, parameters.knn, 1)] = weightsCopy;
-
-                    // Copy expanded nn target values
+                    // Copy expanded nn target rows
                     size_t p = 1;
-                    for ( size_t k = parameters.knn; k < knnSize; k++ ) {
+                    for ( size_t k = knn; k < knnSize; k++ ) {
 
-                        if ( p >= rowTiePairs.size() ) {
+                        if ( p >= nTies ) {
                             std::string errMsg("Simplex(): Tie index error.\n");
                             throw std::runtime_error( errMsg );
                         }
 
-                        int libRow = (int) rowTiePairs[p].second +
-                                           targetLibRowOffset;
+                        int libRow = (int) rowTies[ p ] + targetLibRowOffset;
                         p++;
 
                         if ( libRow >= targetSize or libRow < 0 ) {
                             continue; // no target lib
                         }
 
-                        libTarget[ k ] = target[ libRow ];
-                        weights  [ k ] = tieWeight;
+                        libRows[ k ] = libRow;
+                        weights[ k ] = tieWeight;
 
                         tiesFound++;
                     }
 
                     // Apply weight adjusment to ties
                     if ( tiesFound ) {
-                        for ( size_t i = tieFirstIdx; i < weights.size(); i++ ) {
+                        for ( size_t i = tieFirstIdx; i < knnSize; i++ ) {
                             weights[i] = tieFactor * weights[i];
                         }
                     }
-                } // if ( (int) knnSize > parameters.knn )
-            } // if ( ties[ row ] )
+
+                    nWeights = knnSize;
+                } // if ( knnSize > knn )
+            } // if ( knnTable.Tie( row ) )
         } // if ( anyTies )
         //------------------------------------------------------------------
 
-        // Prediction is average of weighted library projections
-        predictions[ row ] = ( weights * libTarget ).sum() / weights.sum();
+        double weightSum = 0;
+        for ( size_t k = 0; k < nWeights; k++ ) {
+            weightSum += weights[ k ];
+        }
+
+        for ( size_t t = 0; t < nTargets; t++ ) {
+            const std::valarray< double > & libValues =
+                targets.size() ? targets[ t ] : target;
+
+            // target library vector, 0 for expanded nn of no target lib
+            for ( size_t k = 0; k < nWeights; k++ ) {
+                libTarget[ k ] = libRows[ k ] < 0 ? 0 : libValues[ libRows[k] ];
+            }
 
-        // "Variance" estimate assuming weights are probabilities
-        std::valarray< double > deltaSqr =
-            std::pow( libTarget - predictions[ row ], 2 );
-        variance[ row ] = ( weights * deltaSqr ).sum() / weights.sum();
+            // Prediction is average of weighted library projections
+            double weightedSum = 0;
+            for ( size_t k = 0; k < nWeights; k++ ) {
+                weightedSum += weights[ k ] * libTarget[ k ];
+            }
+            double prediction = weightedSum / weightSum;
+
+            // "Variance" estimate assuming weights are probabilities
+            double deltaSqrSum = 0;
+            for ( size_t k = 0; k < nWeights; k++ ) {
+                double delta = libTarget[ k ] - prediction;
+                deltaSqrSum += weights[ k ] * ( delta * delta );
+            }
+
+            multiPredictions[ t ][ row ] = prediction;
+            multiVariance   [ t ][ row ] = deltaSqrSum / weightSum;
+        }
     } // for ( row = 0; row < Npred; row++ )
 
+    if ( targets.empty() ) {
+        predictions.swap( multiPredictions[ 0 ] );
+        variance.swap   ( multiVariance   [ 0 ] );
+    }
+    else {
+        predictions = multiPredictions[ 0 ];
+        variance    = multiVariance   [ 0 ];
+    }
+
     // non "predictions" X(t+1) = X(t) if const_predict specified
     const_predictions = std::valarray< double > ( 0., Npred );
     if ( parameters.const_predict ) {
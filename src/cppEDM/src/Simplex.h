@@ -4,18 +4,43 @@
 
 #include "EDM.h"
 
+//----------------------------------------------------------------
+// Simplex scratch workspace
+// Contiguous knn buffers reused for every prediction row so that the
+// Simplex() inner loop does no heap allocation. Sized once per call
+// to the largest (tie expanded) neighbor count. Each SimplexClass
+// object owns one, so each thread in the threaded drivers
+// (CCM, Multiview, EmbedDimension, PredictInterval) has its own.
+//----------------------------------------------------------------
+struct SimplexWorkspace {
+    std::vector< double > weights;   // knn (+ ties) neighbor weights
+    std::vector< double > libTarget; // knn (+ ties) library targets
+    std::vector< int >    libRows;   // knn (+ ties) target rows, -1 none
+
+    void Reserve( size_t N ) {
+        if ( weights.size() < N ) {
+            weights.resize  ( N );
+            libTarget.resize( N );
+            libRows.resize  ( N );
+        }
+    }
+};
+
 //----------------------------------------------------------------
 // Simplex class inherits from EDM class and defines
 // Simplex-specific projection methods
 //----------------------------------------------------------------
 class SimplexClass : public EDM {
 public:
+    SimplexWorkspace workspace; // Simplex() per-row scratch buffers
+
     // Constructor
     SimplexClass ( DataFrame<double> & data,
                    Parameters        & parameters );
 
     // Method declarations
     void Project();
+    void ProjectMultiTarget( std::vector< std::string > targetNames );
     void Simplex();
     void WriteOutput();
 };